@@ -0,0 +1,403 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/arena.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/arena.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sys/mman.h>
+
+extern "C"
+{
+#include <libxml/parser.h>
+#include <libxml/xmlmemory.h>
+}
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tException.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+namespace
+{
+
+// Address space is only reserved, so the region can be much larger than the memory actually used
+const size_t cREGION_SIZE = size_t(1) << 36;
+const size_t cBLOCK_SIZE = 1 << 20;
+const size_t cBLOCK_COUNT = cREGION_SIZE / cBLOCK_SIZE;
+
+// Allocations larger than this get blocks of their own instead of ending the current block
+const size_t cMAX_SHARED_ALLOCATION = cBLOCK_SIZE / 4;
+
+// The header keeps malloc's alignment and stores the requested size for Reallocate
+const size_t cALIGNMENT = 16;
+const size_t cHEADER_SIZE = 16;
+
+}
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+struct tRegion
+{
+  char *base;
+  std::mutex mutex;
+  std::vector<bool> used_blocks;
+  std::unique_ptr<std::atomic<tArena *>[]> owners;
+
+  xmlFreeFunc previous_free;
+  xmlMallocFunc previous_malloc;
+  xmlMallocFunc previous_malloc_atomic;
+  xmlReallocFunc previous_realloc;
+  xmlStrdupFunc previous_strdup;
+  xmlExternalEntityLoader previous_entity_loader;
+};
+
+// Never destroyed, as libxml2 may call the hooks until the process exits
+tRegion *region = 0;
+std::atomic<char *> region_base(0);
+std::once_flag region_initialized;
+
+thread_local tArena *current_arena = 0;
+
+inline size_t BlockIndex(const void *memory)
+{
+  return (static_cast<const char *>(memory) - region->base) / cBLOCK_SIZE;
+}
+
+void *ArenaMalloc(size_t size)
+{
+  tArena *arena = current_arena;
+  return arena ? arena->Allocate(size) : region->previous_malloc(size);
+}
+
+void *ArenaMallocAtomic(size_t size)
+{
+  tArena *arena = current_arena;
+  return arena ? arena->Allocate(size) : region->previous_malloc_atomic(size);
+}
+
+void *ArenaRealloc(void *memory, size_t size)
+{
+  if (!memory)
+  {
+    return ArenaMalloc(size);
+  }
+  if (IsArenaMemory(memory))
+  {
+    tArena *owner = region->owners[BlockIndex(memory)].load(std::memory_order_relaxed);
+    return owner ? owner->Reallocate(memory, size) : 0;
+  }
+  return region->previous_realloc(memory, size);
+}
+
+void ArenaFree(void *memory)
+{
+  if (memory && !IsArenaMemory(memory))
+  {
+    region->previous_free(memory);
+  }
+}
+
+char *ArenaStrdup(const char *text)
+{
+  tArena *arena = current_arena;
+  if (!arena)
+  {
+    return region->previous_strdup(text);
+  }
+  const size_t size = std::strlen(text) + 1;
+  char *copy = static_cast<char *>(arena->Allocate(size));
+  if (copy)
+  {
+    std::memcpy(copy, text, size);
+  }
+  return copy;
+}
+
+// External entities (e.g. DTDs) may load catalogs into global structures, which must not end up in an arena
+xmlParserInputPtr LoadEntityFromHeap(const char *url, const char *id, xmlParserCtxtPtr context)
+{
+  tArenaScope heap_scope(0);
+  return region->previous_entity_loader(url, id, context);
+}
+
+void InitializeRegion()
+{
+  void *base = mmap(0, cREGION_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED)
+  {
+    throw tException("Could not reserve address space for arena allocation!");
+  }
+  region = new tRegion();
+  region->base = static_cast<char *>(base);
+  region->used_blocks.resize(cBLOCK_COUNT);
+  region->owners.reset(new std::atomic<tArena *>[cBLOCK_COUNT]());
+
+  // Global state of libxml2 has to be allocated on the heap
+  xmlInitParser();
+
+  xmlGcMemGet(&region->previous_free, &region->previous_malloc, &region->previous_malloc_atomic, &region->previous_realloc, &region->previous_strdup);
+  region_base.store(region->base, std::memory_order_release);
+  xmlGcMemSetup(ArenaFree, ArenaMalloc, ArenaMallocAtomic, ArenaRealloc, ArenaStrdup);
+  region->previous_entity_loader = xmlGetExternalEntityLoader();
+  xmlSetExternalEntityLoader(LoadEntityFromHeap);
+}
+
+}
+
+//----------------------------------------------------------------------
+// IsArenaMemory
+//----------------------------------------------------------------------
+bool IsArenaMemory(const void *memory)
+{
+  const uintptr_t base = reinterpret_cast<uintptr_t>(region_base.load(std::memory_order_acquire));
+  const uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+  return base && address >= base && address - base < cREGION_SIZE;
+}
+
+//----------------------------------------------------------------------
+// tArena constructors
+//----------------------------------------------------------------------
+tArena::tArena()
+  : current(0),
+    end(0),
+    last_allocation(0)
+{
+  std::call_once(region_initialized, InitializeRegion);
+}
+
+//----------------------------------------------------------------------
+// tArena destructor
+//----------------------------------------------------------------------
+tArena::~tArena()
+{
+  for (auto it = this->spans.begin(); it != this->spans.end(); ++it)
+  {
+    for (size_t i = 0; i < it->block_count; ++i)
+    {
+      region->owners[it->first_block + i].store(0, std::memory_order_relaxed);
+    }
+    // Mapping fresh inaccessible pages returns the memory to the system
+    void *memory = region->base + it->first_block * cBLOCK_SIZE;
+    mmap(memory, it->block_count * cBLOCK_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    std::lock_guard<std::mutex> lock(region->mutex);
+    std::fill_n(region->used_blocks.begin() + it->first_block, it->block_count, false);
+  }
+}
+
+//----------------------------------------------------------------------
+// tArena Allocate
+//----------------------------------------------------------------------
+void *tArena::Allocate(size_t size)
+{
+  const size_t total = cHEADER_SIZE + ((size + cALIGNMENT - 1) & ~(cALIGNMENT - 1));
+  if (total < size)
+  {
+    return 0;
+  }
+  char *chunk = this->current;
+  if (static_cast<size_t>(this->end - this->current) >= total)
+  {
+    this->current += total;
+    this->last_allocation = chunk;
+  }
+  else if (total > cMAX_SHARED_ALLOCATION)
+  {
+    chunk = this->AcquireSpan(total);
+    if (!chunk)
+    {
+      return 0;
+    }
+  }
+  else
+  {
+    chunk = this->AcquireSpan(cBLOCK_SIZE);
+    if (!chunk)
+    {
+      return 0;
+    }
+    this->current = chunk + total;
+    this->end = chunk + cBLOCK_SIZE;
+    this->last_allocation = chunk;
+  }
+  *reinterpret_cast<size_t *>(chunk) = size;
+  return chunk + cHEADER_SIZE;
+}
+
+//----------------------------------------------------------------------
+// tArena Reallocate
+//----------------------------------------------------------------------
+void *tArena::Reallocate(void *memory, size_t size)
+{
+  char *chunk = static_cast<char *>(memory) - cHEADER_SIZE;
+  size_t &allocated_size = *reinterpret_cast<size_t *>(chunk);
+  if (size <= allocated_size)
+  {
+    return memory;
+  }
+  if (chunk == this->last_allocation)
+  {
+    const size_t total = cHEADER_SIZE + ((size + cALIGNMENT - 1) & ~(cALIGNMENT - 1));
+    if (total >= size && static_cast<size_t>(this->end - chunk) >= total)
+    {
+      this->current = chunk + total;
+      allocated_size = size;
+      return memory;
+    }
+  }
+  void *result = this->Allocate(size);
+  if (result)
+  {
+    std::memcpy(result, memory, allocated_size);
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------
+// tArena ReservedMemory
+//----------------------------------------------------------------------
+size_t tArena::ReservedMemory() const
+{
+  size_t blocks = 0;
+  for (auto it = this->spans.begin(); it != this->spans.end(); ++it)
+  {
+    blocks += it->block_count;
+  }
+  return blocks * cBLOCK_SIZE;
+}
+
+//----------------------------------------------------------------------
+// tArena AcquireSpan
+//----------------------------------------------------------------------
+char *tArena::AcquireSpan(size_t size)
+{
+  // This is called from libxml2 and must not throw
+  const size_t block_count = (size + cBLOCK_SIZE - 1) / cBLOCK_SIZE;
+  size_t first_block = 0;
+  {
+    std::lock_guard<std::mutex> lock(region->mutex);
+    size_t free_blocks = 0;
+    for (size_t i = 0; i < cBLOCK_COUNT && free_blocks < block_count; ++i)
+    {
+      free_blocks = region->used_blocks[i] ? 0 : free_blocks + 1;
+      first_block = i + 1 - free_blocks;
+    }
+    if (free_blocks < block_count)
+    {
+      return 0;
+    }
+    std::fill_n(region->used_blocks.begin() + first_block, block_count, true);
+  }
+
+  char *memory = region->base + first_block * cBLOCK_SIZE;
+  bool success = mprotect(memory, block_count * cBLOCK_SIZE, PROT_READ | PROT_WRITE) == 0;
+  if (success)
+  {
+    try
+    {
+      this->spans.push_back({ first_block, block_count });
+    }
+    catch (...)
+    {
+      mprotect(memory, block_count * cBLOCK_SIZE, PROT_NONE);
+      success = false;
+    }
+  }
+  if (!success)
+  {
+    std::lock_guard<std::mutex> lock(region->mutex);
+    std::fill_n(region->used_blocks.begin() + first_block, block_count, false);
+    return 0;
+  }
+  for (size_t i = 0; i < block_count; ++i)
+  {
+    region->owners[first_block + i].store(this, std::memory_order_relaxed);
+  }
+  return memory;
+}
+
+//----------------------------------------------------------------------
+// tArenaScope constructors
+//----------------------------------------------------------------------
+tArenaScope::tArenaScope(tArena *arena)
+  : previous(current_arena)
+{
+  current_arena = arena;
+}
+
+//----------------------------------------------------------------------
+// tArenaScope destructor
+//----------------------------------------------------------------------
+tArenaScope::~tArenaScope()
+{
+  current_arena = this->previous;
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
@@ -0,0 +1,164 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/arena.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Arena allocation for libxml2 documents
+ *
+ * Arenas take their memory in blocks from an address range that is
+ * reserved once per process. The libxml2 allocation hooks are replaced
+ * when the first arena is created: while a tArenaScope is active on a
+ * thread, allocations of that thread are served by the scope's arena.
+ * All other allocations are passed to the previously installed hooks.
+ * Freeing memory of an arena does nothing, as the address range tells
+ * arena memory apart from heap memory without a lookup. Destroying an
+ * arena releases its blocks at once.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__arena_h__
+#define __rrlib__xml__arena_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+#include "rrlib/util/tNoncopyable.h"
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Bump allocator for the libxml2 allocations of a document
+/*! An arena must only be used by one thread at a time.
+ *
+ */
+class tArena : public util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Create an arena and install the allocation hooks if necessary
+   *
+   * \exception tException is thrown if the address range for arenas cannot be reserved
+   */
+  tArena();
+
+  /*! Release all memory of the arena */
+  ~tArena();
+
+  /*! Allocate memory (aligned like malloc) */
+  void *Allocate(size_t size);
+
+  /*! Resize memory of this arena, in place if it was allocated last */
+  void *Reallocate(void *memory, size_t size);
+
+  /*! Get the memory reserved by this arena in bytes */
+  size_t ReservedMemory() const;
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  struct tSpan
+  {
+    size_t first_block;
+    size_t block_count;
+  };
+
+  std::vector<tSpan> spans;
+  char *current;
+  char *end;
+  char *last_allocation;
+
+  char *AcquireSpan(size_t size);
+
+};
+
+//! Directs the libxml2 allocations of the current thread to an arena
+/*! Scopes can be nested. A scope without arena directs allocations
+ *  to the heap.
+ *
+ */
+class tArenaScope : public util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  explicit tArenaScope(tArena *arena);
+
+  ~tArenaScope();
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  tArena *previous;
+
+};
+
+//----------------------------------------------------------------------
+// Function declarations
+//----------------------------------------------------------------------
+
+/*! Check if memory was allocated by an arena
+ */
+bool IsArenaMemory(const void *memory);
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+#endif
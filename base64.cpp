@@ -0,0 +1,286 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/base64.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/base64.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tException.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+namespace
+{
+
+const char cENCODE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+const uint8_t cX = 0xFF;
+const uint8_t cDECODE[256] =
+{
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, 62, cX, cX, cX, 63,
+  52, 53, 54, 55, 56, 57, 58, 59, 60, 61, cX, cX, cX, cX, cX, cX,
+  cX, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+  15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, cX, cX, cX, cX, cX,
+  cX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+  41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX,
+  cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX, cX
+};
+
+}
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+inline bool IsWhitespace(char c)
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+void ThrowInvalidText()
+{
+  throw tException("Content is not valid base64 data!");
+}
+
+void ThrowBufferTooSmall(size_t size)
+{
+  throw tException("Base64 content decodes to more than " + std::to_string(size) + " bytes!");
+}
+
+#ifdef __SSSE3__
+
+// Encodes the first 12 bytes of the 16 bytes at input into 16 characters
+inline void EncodeBlock(const uint8_t *input, char *output)
+{
+  __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+  const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t0, t1);
+
+  __m128i classes = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  classes = _mm_or_si128(classes, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(output), _mm_add_epi8(_mm_shuffle_epi8(offsets, classes), indices));
+}
+
+inline __m128i InRange(__m128i characters, char low, char high)
+{
+  return _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8(low - 1)), _mm_cmplt_epi8(characters, _mm_set1_epi8(high + 1)));
+}
+
+// Decodes 16 characters into 12 bytes (16 bytes are written); returns false if a character is not part of the alphabet
+inline bool DecodeBlock(const char *input, uint8_t *output)
+{
+  const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+  const __m128i upper = InRange(characters, 'A', 'Z');
+  const __m128i lower = InRange(characters, 'a', 'z');
+  const __m128i digit = InRange(characters, '0', '9');
+  const __m128i plus = _mm_cmpeq_epi8(characters, _mm_set1_epi8('+'));
+  const __m128i slash = _mm_cmpeq_epi8(characters, _mm_set1_epi8('/'));
+  const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+  if (_mm_movemask_epi8(valid) != 0xFFFF)
+  {
+    return false;
+  }
+  const __m128i shift = _mm_or_si128(_mm_or_si128(_mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)), _mm_and_si128(lower, _mm_set1_epi8(-71))),
+                                                  _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(4)), _mm_and_si128(plus, _mm_set1_epi8(19)))),
+                                     _mm_and_si128(slash, _mm_set1_epi8(16)));
+  const __m128i values = _mm_add_epi8(characters, shift);
+  const __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+  const __m128i packed = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(output), packed);
+  return true;
+}
+
+#endif
+
+}
+
+//----------------------------------------------------------------------
+// EncodeBase64
+//----------------------------------------------------------------------
+void EncodeBase64(const void *data, size_t size, char *text)
+{
+  const uint8_t *input = static_cast<const uint8_t *>(data);
+  size_t i = 0;
+#ifdef __SSSE3__
+  for (; size - i >= 16; i += 12, text += 16)
+  {
+    EncodeBlock(input + i, text);
+  }
+#endif
+  for (; size - i >= 3; i += 3, text += 4)
+  {
+    const uint32_t block = (uint32_t(input[i]) << 16) | (uint32_t(input[i + 1]) << 8) | input[i + 2];
+    text[0] = cENCODE[block >> 18];
+    text[1] = cENCODE[(block >> 12) & 0x3F];
+    text[2] = cENCODE[(block >> 6) & 0x3F];
+    text[3] = cENCODE[block & 0x3F];
+  }
+  if (i < size)
+  {
+    const uint32_t block = (uint32_t(input[i]) << 16) | (size - i == 2 ? uint32_t(input[i + 1]) << 8 : 0);
+    text[0] = cENCODE[block >> 18];
+    text[1] = cENCODE[(block >> 12) & 0x3F];
+    text[2] = size - i == 2 ? cENCODE[(block >> 6) & 0x3F] : '=';
+    text[3] = '=';
+  }
+}
+
+//----------------------------------------------------------------------
+// DecodeBase64
+//----------------------------------------------------------------------
+size_t DecodeBase64(const char *text, size_t length, void *data, size_t size)
+{
+  uint8_t *output = static_cast<uint8_t *>(data);
+  const uint8_t *input = reinterpret_cast<const uint8_t *>(text);
+  size_t written = 0;
+  size_t i = 0;
+  while (true)
+  {
+#ifdef __SSSE3__
+    for (; length - i >= 16 && size - written >= 16 && DecodeBlock(text + i, output + written); i += 16, written += 12)
+    {}
+#endif
+    for (; length - i >= 4 && size - written >= 3; i += 4, written += 3)
+    {
+      const uint8_t a = cDECODE[input[i]], b = cDECODE[input[i + 1]], c = cDECODE[input[i + 2]], d = cDECODE[input[i + 3]];
+      if ((a | b | c | d) & 0x80)
+      {
+        break;
+      }
+      output[written] = (a << 2) | (b >> 4);
+      output[written + 1] = (b << 4) | (c >> 2);
+      output[written + 2] = (c << 6) | d;
+    }
+
+    // Slow path for whitespace, padding, the end of the buffer and errors
+    char quad[4];
+    size_t characters = 0;
+    for (; i < length && characters < 4; ++i)
+    {
+      if (!IsWhitespace(text[i]))
+      {
+        quad[characters++] = text[i];
+      }
+    }
+    if (characters == 0)
+    {
+      return written;
+    }
+    if (characters < 4)
+    {
+      ThrowInvalidText();
+    }
+    const size_t padding = quad[3] == '=' ? (quad[2] == '=' ? 2 : 1) : 0;
+    uint32_t block = 0;
+    for (size_t k = 0; k < 4 - padding; ++k)
+    {
+      const uint8_t value = cDECODE[static_cast<uint8_t>(quad[k])];
+      if (value & 0x80)
+      {
+        ThrowInvalidText();
+      }
+      block |= uint32_t(value) << (18 - 6 * k);
+    }
+    if (size - written < 3 - padding)
+    {
+      ThrowBufferTooSmall(size);
+    }
+    for (size_t k = 0; k < 3 - padding; ++k)
+    {
+      output[written++] = block >> (16 - 8 * k);
+    }
+    if (padding)
+    {
+      for (; i < length; ++i)
+      {
+        if (!IsWhitespace(text[i]))
+        {
+          ThrowInvalidText();
+        }
+      }
+      return written;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
@@ -0,0 +1,121 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/base64.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Base64 encoding and decoding of binary node content
+ *
+ * Binary payloads are embedded into XML documents as base64 text
+ * (RFC 4648, standard alphabet with padding). Encoding and decoding
+ * work between the text stored in the DOM tree and caller provided
+ * memory. If the compiler targets SSSE3, blocks of 12 input bytes or
+ * 16 input characters are processed with vector instructions,
+ * otherwise table based scalar code is used.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__base64_h__
+#define __rrlib__xml__base64_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstddef>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Function declarations
+//----------------------------------------------------------------------
+
+/*! Get the length of the base64 representation of binary data
+ *
+ * \param size   The number of bytes to encode
+ *
+ * \returns The number of characters (without terminating zero)
+ */
+inline size_t Base64EncodedLength(size_t size)
+{
+  return (size + 2) / 3 * 4;
+}
+
+/*! Get an upper bound of the decoded size of base64 text
+ *
+ * \param length   The number of characters of the text
+ *
+ * \returns The maximum number of bytes decoding \a length characters can produce
+ */
+inline size_t Base64DecodedSizeBound(size_t length)
+{
+  return (length + 3) / 4 * 3;
+}
+
+/*! Encode binary data as base64 text
+ *
+ * \param data      The data to encode
+ * \param size      The number of bytes in \a data
+ * \param text      Output buffer for Base64EncodedLength(size) characters (no terminating zero is written)
+ */
+void EncodeBase64(const void *data, size_t size, char *text);
+
+/*! Decode base64 text
+ *
+ * Whitespace between the characters is ignored.
+ *
+ * \exception tException is thrown if \a text is not valid base64 or decodes to more than \a size bytes
+ *
+ * \param text     The text to decode
+ * \param length   The number of characters in \a text
+ * \param data     The buffer to write the decoded bytes to
+ * \param size     The capacity of \a data
+ *
+ * \returns The number of decoded bytes
+ */
+size_t DecodeBase64(const char *text, size_t length, void *data, size_t size);
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+#endif
@@ -0,0 +1,203 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/escape.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/escape.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+struct tEscapeSequence
+{
+  char text[cMAX_ESCAPED_CHARACTER_LENGTH];
+  size_t length;
+};
+
+struct tEscapeTable
+{
+  tEscapeSequence sequences[256];
+
+  explicit tEscapeTable(bool attribute)
+  {
+    this->Set('<', "&lt;");
+    this->Set('>', "&gt;");
+    this->Set('&', "&amp;");
+    this->Set('\r', "&#13;");
+    if (attribute)
+    {
+      this->Set('"', "&quot;");
+      this->Set('\n', "&#10;");
+      this->Set('\t', "&#9;");
+    }
+  }
+
+  void Set(unsigned char c, const std::string &sequence)
+  {
+    std::memcpy(this->sequences[c].text, sequence.data(), sequence.size());
+    this->sequences[c].length = sequence.size();
+  }
+};
+
+template <bool ATTRIBUTE>
+inline bool NeedsEscape(char c)
+{
+  return c == '<' || c == '>' || c == '&' || c == '\r' || (ATTRIBUTE && (c == '"' || c == '\n' || c == '\t'));
+}
+
+inline char *WriteEscapeSequence(char c, const tEscapeTable &table, char *output)
+{
+  const tEscapeSequence &sequence = table.sequences[static_cast<unsigned char>(c)];
+  std::memcpy(output, sequence.text, cMAX_ESCAPED_CHARACTER_LENGTH);
+  return output + sequence.length;
+}
+
+template <bool ATTRIBUTE>
+size_t EscapeText(const char *text, size_t length, char *output)
+{
+  static const tEscapeTable table(ATTRIBUTE);
+  char *const output_begin = output;
+  size_t i = 0;
+#ifdef __SSE2__
+  // '<' and '>' only differ in bit 1
+  const __m128i bit_1 = _mm_set1_epi8(0x02);
+  const __m128i greater = _mm_set1_epi8('>');
+  const __m128i ampersand = _mm_set1_epi8('&');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i line_feed = _mm_set1_epi8('\n');
+  const __m128i tab = _mm_set1_epi8('\t');
+  for (; i + 16 <= length; i += 16)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+    __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(_mm_or_si128(chunk, bit_1), greater), _mm_cmpeq_epi8(chunk, ampersand)),
+                                   _mm_cmpeq_epi8(chunk, carriage_return));
+    if (ATTRIBUTE)
+    {
+      matches = _mm_or_si128(matches, _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, line_feed)),
+                                                   _mm_cmpeq_epi8(chunk, tab)));
+    }
+    unsigned int mask = _mm_movemask_epi8(matches);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output), chunk);
+    if (!mask)
+    {
+      output += 16;
+      continue;
+    }
+    // The clean prefix of the block is already in place, the rest is written piece by piece
+    size_t position = __builtin_ctz(mask);
+    output += position;
+    while (true)
+    {
+      output = WriteEscapeSequence(text[i + position], table, output);
+      mask &= mask - 1;
+      const size_t next = mask ? __builtin_ctz(mask) : 16;
+      std::memcpy(output, text + i + position + 1, next - position - 1);
+      output += next - position - 1;
+      if (!mask)
+      {
+        break;
+      }
+      position = next;
+    }
+  }
+#endif
+  for (; i < length; ++i)
+  {
+    if (NeedsEscape<ATTRIBUTE>(text[i]))
+    {
+      output = WriteEscapeSequence(text[i], table, output);
+    }
+    else
+    {
+      *output++ = text[i];
+    }
+  }
+  return output - output_begin;
+}
+
+}
+
+//----------------------------------------------------------------------
+// EscapeText
+//----------------------------------------------------------------------
+size_t EscapeText(const char *text, size_t length, bool attribute, char *output)
+{
+  return attribute ? EscapeText<true>(text, length, output) : EscapeText<false>(text, length, output);
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
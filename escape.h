@@ -0,0 +1,89 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/escape.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Escaping of text and attribute values for XML output
+ *
+ * The characters escaped are the same libxml2 escapes when it writes
+ * UTF-8: <, >, & and carriage return in text and additionally ", line
+ * feed and tab in attribute values. The search for these characters
+ * processes 16 bytes per step with SSE2 if available, so clean runs
+ * are copied to the output in bulk.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__escape_h__
+#define __rrlib__xml__escape_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstddef>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Function declarations
+//----------------------------------------------------------------------
+
+/*! Maximum number of characters a single input character is escaped to */
+const size_t cMAX_ESCAPED_CHARACTER_LENGTH = 6;
+
+/*! Escape text for XML output
+ *
+ * \param text        The text to escape
+ * \param length      The length of \a text
+ * \param attribute   Whether \a text is an attribute value
+ * \param output      The buffer for the escaped text (room for cMAX_ESCAPED_CHARACTER_LENGTH * \a length characters is needed)
+ *
+ * \returns The number of characters written to \a output
+ */
+size_t EscapeText(const char *text, size_t length, bool attribute, char *output);
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+#endif
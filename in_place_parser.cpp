@@ -0,0 +1,313 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/in_place_parser.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/in_place_parser.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <climits>
+#include <cstring>
+
+extern "C"
+{
+#include <libxml/parserInternals.h>
+}
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tException.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+namespace
+{
+
+// Entities are replaced so that attribute values arrive decoded; without a DTD only the predefined ones exist
+const int cPARSER_OPTIONS = XML_PARSE_NOENT | XML_PARSE_NONET;
+
+}
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+inline bool NamespaceMatches(xmlNsPtr ns, const xmlChar *prefix, const xmlChar *uri)
+{
+  return ns ? xmlStrEqual(ns->prefix, prefix) && xmlStrEqual(ns->href, uri) : !uri;
+}
+
+// Errors are reported by the full parse that follows a failed match
+void IgnoreError(void *, xmlErrorPtr)
+{}
+
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser constructors
+//----------------------------------------------------------------------
+tInPlaceParser::tInPlaceParser()
+  : context(0),
+    parent(0),
+    cursor(0),
+    mismatch(false)
+{
+  std::memset(&this->handler, 0, sizeof(this->handler));
+  this->handler.initialized = XML_SAX2_MAGIC;
+  this->handler.startElementNs = StartElement;
+  this->handler.endElementNs = EndElement;
+  this->handler.characters = Characters;
+  this->handler.ignorableWhitespace = Characters;
+  this->handler.internalSubset = [](void *context, const xmlChar *, const xmlChar *, const xmlChar *) { Unsupported(context); };
+  this->handler.reference = [](void *context, const xmlChar *) { Unsupported(context); };
+  this->handler.cdataBlock = [](void *context, const xmlChar *, int) { Unsupported(context); };
+  this->handler.comment = [](void *context, const xmlChar *) { Unsupported(context); };
+  this->handler.processingInstruction = [](void *context, const xmlChar *, const xmlChar *) { Unsupported(context); };
+  this->handler.serror = IgnoreError;
+
+  this->context = xmlCreatePushParserCtxt(&this->handler, this, 0, 0, 0);
+  if (!this->context)
+  {
+    throw tException("Could not create parser context!");
+  }
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser destructor
+//----------------------------------------------------------------------
+tInPlaceParser::~tInPlaceParser()
+{
+  xmlFreeParserCtxt(this->context);
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser Match
+//----------------------------------------------------------------------
+bool tInPlaceParser::Match(xmlDocPtr document, const char *buffer, size_t size)
+{
+  this->changes.clear();
+  this->values.clear();
+  this->text.clear();
+  this->parent = reinterpret_cast<xmlNodePtr>(document);
+  this->cursor = document->children;
+  this->mismatch = false;
+
+  if (size > static_cast<size_t>(INT_MAX) || xmlCtxtResetPush(this->context, 0, 0, 0, 0) != 0)
+  {
+    return false;
+  }
+  xmlCtxtUseOptions(this->context, cPARSER_OPTIONS);
+  xmlParseChunk(this->context, buffer, static_cast<int>(size), 1);
+
+  return !this->mismatch && this->context->wellFormed && this->parent == reinterpret_cast<xmlNodePtr>(document) && !this->cursor;
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser Mismatch
+//----------------------------------------------------------------------
+void tInPlaceParser::Mismatch()
+{
+  this->mismatch = true;
+  xmlStopParser(this->context);
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser CompareValue
+//----------------------------------------------------------------------
+void tInPlaceParser::CompareValue(xmlNodePtr target, const xmlChar *current, const char *value, size_t length)
+{
+  const char *current_value = current ? reinterpret_cast<const char *>(current) : "";
+  if (std::strncmp(current_value, value, length) == 0 && current_value[length] == 0)
+  {
+    return;
+  }
+  this->changes.push_back({ target, this->values.size(), length });
+  this->values.append(value, length);
+  this->values.push_back(0);
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser CompareText
+//----------------------------------------------------------------------
+void tInPlaceParser::CompareText()
+{
+  if (this->text.empty())
+  {
+    return;
+  }
+  // Adjacent character data is merged into one text node by the full parse, too
+  if (!this->cursor || this->cursor->type != XML_TEXT_NODE)
+  {
+    this->Mismatch();
+    return;
+  }
+  this->CompareValue(this->cursor, this->cursor->content, this->text.data(), this->text.size());
+  this->cursor = this->cursor->next;
+  this->text.clear();
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser StartElement
+//----------------------------------------------------------------------
+void tInPlaceParser::StartElement(void *context, const xmlChar *local_name, const xmlChar *prefix, const xmlChar *uri,
+                                  int namespace_count, const xmlChar **namespaces, int attribute_count, int, const xmlChar **attributes)
+{
+  tInPlaceParser &parser = *static_cast<tInPlaceParser *>(context);
+  if (parser.mismatch)
+  {
+    return;
+  }
+  parser.CompareText();
+  xmlNodePtr element = parser.cursor;
+  if (parser.mismatch || !element || element->type != XML_ELEMENT_NODE ||
+      !xmlStrEqual(element->name, local_name) || !NamespaceMatches(element->ns, prefix, uri))
+  {
+    parser.Mismatch();
+    return;
+  }
+
+  xmlNsPtr ns = element->nsDef;
+  for (int i = 0; i < namespace_count; ++i, ns = ns->next)
+  {
+    if (!ns || !xmlStrEqual(ns->prefix, namespaces[2 * i]) || !xmlStrEqual(ns->href, namespaces[2 * i + 1]))
+    {
+      parser.Mismatch();
+      return;
+    }
+  }
+
+  xmlAttrPtr attribute = element->properties;
+  for (int i = 0; i < attribute_count; ++i, attribute = attribute->next)
+  {
+    const xmlChar **values = attributes + 5 * i;
+    if (!attribute || !xmlStrEqual(attribute->name, values[0]) || !NamespaceMatches(attribute->ns, values[1], values[2]))
+    {
+      parser.Mismatch();
+      return;
+    }
+    xmlNodePtr text_node = attribute->children;
+    if (text_node && (text_node->type != XML_TEXT_NODE || text_node->next))
+    {
+      parser.Mismatch();
+      return;
+    }
+    const char *value = reinterpret_cast<const char *>(values[3]);
+    const size_t length = values[4] - values[3];
+    if (text_node)
+    {
+      parser.CompareValue(text_node, text_node->content, value, length);
+    }
+    else
+    {
+      parser.CompareValue(reinterpret_cast<xmlNodePtr>(attribute), 0, value, length);
+    }
+  }
+  if (ns || attribute)
+  {
+    parser.Mismatch();
+    return;
+  }
+
+  parser.parent = element;
+  parser.cursor = element->children;
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser EndElement
+//----------------------------------------------------------------------
+void tInPlaceParser::EndElement(void *context, const xmlChar *, const xmlChar *, const xmlChar *)
+{
+  tInPlaceParser &parser = *static_cast<tInPlaceParser *>(context);
+  if (parser.mismatch)
+  {
+    return;
+  }
+  parser.CompareText();
+  if (parser.mismatch || parser.cursor)
+  {
+    parser.Mismatch();
+    return;
+  }
+  parser.cursor = parser.parent->next;
+  parser.parent = parser.parent->parent;
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser Characters
+//----------------------------------------------------------------------
+void tInPlaceParser::Characters(void *context, const xmlChar *text, int length)
+{
+  tInPlaceParser &parser = *static_cast<tInPlaceParser *>(context);
+  if (!parser.mismatch)
+  {
+    parser.text.append(reinterpret_cast<const char *>(text), length);
+  }
+}
+
+//----------------------------------------------------------------------
+// tInPlaceParser Unsupported
+//----------------------------------------------------------------------
+void tInPlaceParser::Unsupported(void *context)
+{
+  static_cast<tInPlaceParser *>(context)->Mismatch();
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
@@ -0,0 +1,176 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/in_place_parser.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Matching of XML messages against an existing document
+ *
+ * Messages of the same shape as a document (same elements, attributes
+ * and text nodes in the same order) only differ in their values. The
+ * parser streams such a message through SAX callbacks, compares each
+ * event with the next node of the document and collects the values that
+ * changed, so they can be written into the existing nodes instead of
+ * building a new tree.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__in_place_parser_h__
+#define __rrlib__xml__in_place_parser_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <string>
+#include <vector>
+
+#include "rrlib/util/tNoncopyable.h"
+
+extern "C"
+{
+#include <libxml/parser.h>
+}
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Reusable parser that matches messages against a document
+/*! The parser context, its name dictionary and the buffers for changed
+ *  values are kept between messages, so matching a message of known
+ *  shape allocates almost nothing.
+ *
+ *  Anything but elements, attributes and text (comments, processing
+ *  instructions, CDATA sections, document type declarations, entity
+ *  references) is reported as mismatch. The same applies to malformed
+ *  messages, whose errors are left to a full parse.
+ *
+ */
+class tInPlaceParser : public util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! A value of the document that differs in the message */
+  struct tChange
+  {
+    /*! The text node holding the value or an attribute without text node */
+    xmlNodePtr target;
+    size_t offset;
+    size_t length;
+  };
+
+  /*! Create the parser
+   *
+   * \exception tException is thrown if the parser context cannot be created
+   */
+  tInPlaceParser();
+
+  ~tInPlaceParser();
+
+  /*! Match a message against a document
+   *
+   * The document is not modified.
+   *
+   * \param document   The document the message is compared with
+   * \param buffer     The message
+   * \param size       The size of \a buffer
+   *
+   * \returns Whether the message has the same shape as \a document
+   */
+  bool Match(xmlDocPtr document, const char *buffer, size_t size);
+
+  /*! The changed values found by the last successful Match */
+  inline const std::vector<tChange> &Changes() const
+  {
+    return this->changes;
+  }
+
+  /*! The new value of a change */
+  inline const char *Value(const tChange &change) const
+  {
+    return this->values.data() + change.offset;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  xmlSAXHandler handler;
+  xmlParserCtxtPtr context;
+
+  xmlNodePtr parent;
+  xmlNodePtr cursor;
+  bool mismatch;
+  std::string text;
+
+  std::vector<tChange> changes;
+  std::string values;
+
+  void Mismatch();
+
+  void CompareValue(xmlNodePtr target, const xmlChar *current, const char *value, size_t length);
+
+  void CompareText();
+
+  static void StartElement(void *context, const xmlChar *local_name, const xmlChar *prefix, const xmlChar *uri,
+                           int namespace_count, const xmlChar **namespaces, int attribute_count, int defaulted_count, const xmlChar **attributes);
+
+  static void EndElement(void *context, const xmlChar *local_name, const xmlChar *prefix, const xmlChar *uri);
+
+  static void Characters(void *context, const xmlChar *text, int length);
+
+  static void Unsupported(void *context);
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+#endif
@@ -0,0 +1,326 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/numeric_arrays.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/numeric_arrays.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tException.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+inline bool IsDelimiter(char c)
+{
+  return c == ' ' || c == ',' || c == '\n' || c == '\t' || c == '\r';
+}
+
+inline const char *SkipDelimiters(const char *text)
+{
+  while (IsDelimiter(*text))
+  {
+    ++text;
+  }
+  return text;
+}
+
+const std::string Token(const char *text)
+{
+  const char *end = text;
+  while (*end && !IsDelimiter(*end))
+  {
+    ++end;
+  }
+  return std::string(text, end);
+}
+
+void ThrowConversionError(const char *text)
+{
+  throw tException("Could not convert `" + Token(text) + "' to number!");
+}
+
+template <typename TNumber>
+const char *ParseInteger(const char *text, TNumber &value)
+{
+  typedef typename std::make_unsigned<TNumber>::type tUnsigned;
+  const char *current = text;
+  bool negative = false;
+  if (*current == '-' || *current == '+')
+  {
+    negative = *current == '-';
+    ++current;
+  }
+  if (negative && !std::is_signed<TNumber>::value)
+  {
+    ThrowConversionError(text);
+  }
+  const tUnsigned limit = negative ? tUnsigned(tUnsigned(std::numeric_limits<TNumber>::max()) + 1) : tUnsigned(std::numeric_limits<TNumber>::max());
+  tUnsigned result = 0;
+  const char *digits = current;
+  for (; *current >= '0' && *current <= '9'; ++current)
+  {
+    const unsigned int digit = *current - '0';
+    if (result > (limit - digit) / 10)
+    {
+      ThrowConversionError(text);
+    }
+    result = result * 10 + digit;
+  }
+  if (current == digits || (*current && !IsDelimiter(*current)))
+  {
+    ThrowConversionError(text);
+  }
+  value = negative ? TNumber(-result) : TNumber(result);
+  return current;
+}
+
+template <typename TNumber>
+const char *ParseFloatingPoint(const char *text, TNumber &value, TNumber(&convert_function)(const char *, char **))
+{
+  errno = 0;
+  char *endptr;
+  value = convert_function(text, &endptr);
+  if (errno || endptr == text || (*endptr && !IsDelimiter(*endptr)))
+  {
+    ThrowConversionError(text);
+  }
+  return endptr;
+}
+
+inline const char *ParseElement(const char *text, float &value)
+{
+  return ParseFloatingPoint(text, value, std::strtof);
+}
+inline const char *ParseElement(const char *text, double &value)
+{
+  return ParseFloatingPoint(text, value, std::strtod);
+}
+inline const char *ParseElement(const char *text, long double &value)
+{
+  return ParseFloatingPoint(text, value, std::strtold);
+}
+template <typename TNumber>
+inline const char *ParseElement(const char *text, TNumber &value)
+{
+  return ParseInteger(text, value);
+}
+
+inline int FormatElement(char *buffer, size_t size, float value)
+{
+  return std::snprintf(buffer, size, "%.*g", std::numeric_limits<float>::max_digits10, value);
+}
+inline int FormatElement(char *buffer, size_t size, double value)
+{
+  return std::snprintf(buffer, size, "%.*g", std::numeric_limits<double>::max_digits10, value);
+}
+inline int FormatElement(char *buffer, size_t size, long double value)
+{
+  return std::snprintf(buffer, size, "%.*Lg", std::numeric_limits<long double>::max_digits10, value);
+}
+template <typename TNumber>
+inline int FormatElement(char *buffer, size_t size, TNumber value)
+{
+  typedef typename std::make_unsigned<TNumber>::type tUnsigned;
+  char digits[std::numeric_limits<tUnsigned>::digits10 + 2];
+  char *end = digits + sizeof(digits);
+  char *current = end;
+  tUnsigned magnitude = value < 0 ? tUnsigned(0) - tUnsigned(value) : tUnsigned(value);
+  do
+  {
+    *--current = '0' + magnitude % 10;
+    magnitude /= 10;
+  }
+  while (magnitude);
+  if (value < 0)
+  {
+    *--current = '-';
+  }
+  assert(size_t(end - current) < size);
+  std::copy(current, end, buffer);
+  return end - current;
+}
+
+}
+
+//----------------------------------------------------------------------
+// CountNumericArrayElements
+//----------------------------------------------------------------------
+size_t CountNumericArrayElements(const char *text, size_t length)
+{
+  size_t count = 0;
+  unsigned int previous_is_delimiter = 1;
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i line_feed = _mm_set1_epi8('\n');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  for (; i + 16 <= length; i += 16)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+    const __m128i delimiters = _mm_or_si128(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, comma)),
+                                                         _mm_or_si128(_mm_cmpeq_epi8(chunk, line_feed), _mm_cmpeq_epi8(chunk, tab))),
+                                            _mm_cmpeq_epi8(chunk, carriage_return));
+    const unsigned int mask = _mm_movemask_epi8(delimiters);
+    const unsigned int element_starts = ~mask & ((mask << 1) | previous_is_delimiter) & 0xFFFF;
+    count += __builtin_popcount(element_starts);
+    previous_is_delimiter = (mask >> 15) & 1;
+  }
+#endif
+  for (; i < length; ++i)
+  {
+    const unsigned int is_delimiter = IsDelimiter(text[i]);
+    count += (is_delimiter ^ 1) & previous_is_delimiter;
+    previous_is_delimiter = is_delimiter;
+  }
+  return count;
+}
+
+//----------------------------------------------------------------------
+// ParseNumericArray
+//----------------------------------------------------------------------
+template <typename TNumber>
+size_t ParseNumericArray(const char *text, TNumber *values, size_t size)
+{
+  size_t count = 0;
+  for (text = SkipDelimiters(text); *text; text = SkipDelimiters(text))
+  {
+    if (count == size)
+    {
+      throw tException("Number list contains more than " + std::to_string(size) + " elements!");
+    }
+    text = ParseElement(text, values[count++]);
+  }
+  return count;
+}
+
+//----------------------------------------------------------------------
+// FormatNumericArray
+//----------------------------------------------------------------------
+template <typename TNumber>
+void FormatNumericArray(const TNumber *values, size_t size, char delimiter, std::string &result)
+{
+  result.clear();
+  char buffer[cMAX_FORMATTED_NUMBER_LENGTH];
+  for (size_t i = 0; i < size; ++i)
+  {
+    if (i)
+    {
+      result += delimiter;
+    }
+    result.append(buffer, FormatElement(buffer, sizeof(buffer), values[i]));
+  }
+}
+
+//----------------------------------------------------------------------
+// FormatNumber
+//----------------------------------------------------------------------
+template <typename TNumber>
+size_t FormatNumber(char *buffer, size_t size, TNumber value)
+{
+  return FormatElement(buffer, size, value);
+}
+
+//----------------------------------------------------------------------
+// Explicit template instantiation
+//----------------------------------------------------------------------
+#define RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(TNumber) \
+  template size_t ParseNumericArray<TNumber>(const char *, TNumber *, size_t); \
+  template void FormatNumericArray<TNumber>(const TNumber *, size_t, char, std::string &); \
+  template size_t FormatNumber<TNumber>(char *, size_t, TNumber);
+
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(char)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(signed char)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(unsigned char)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(short)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(unsigned short)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(int)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(unsigned int)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(long)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(unsigned long)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(long long)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(unsigned long long)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(float)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(double)
+RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY(long double)
+
+#undef RRLIB_XML_INSTANTIATE_NUMERIC_ARRAY
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
@@ -0,0 +1,133 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/numeric_arrays.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Parsing and formatting of delimiter separated number lists
+ *
+ * Number lists like calibration matrices or trajectories are stored as
+ * whitespace or comma separated text in attributes or node content.
+ * The functions in this file work directly on the raw character data
+ * stored in the DOM tree. The number of elements is determined in a
+ * separate pass over the text, which is vectorized using SSE2 if
+ * available, so that containers can be sized exactly before parsing.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__numeric_arrays_h__
+#define __rrlib__xml__numeric_arrays_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <string>
+#include <cstddef>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Function declarations
+//----------------------------------------------------------------------
+
+/*! Count the elements of a number list
+ *
+ * Elements are separated by runs of whitespace and commas.
+ *
+ * \param text     The text to scan
+ * \param length   The length of \a text
+ *
+ * \returns The number of elements in \a text
+ */
+size_t CountNumericArrayElements(const char *text, size_t length);
+
+/*! Parse a number list into a buffer
+ *
+ * Supported number types are all integral types except bool
+ * and float, double and long double.
+ *
+ * \exception tException is thrown if an element is not a number or \a text contains more than \a size elements
+ *
+ * \param text     The zero-terminated text to parse
+ * \param values   The buffer to store the numbers in
+ * \param size     The capacity of \a values
+ *
+ * \returns The number of parsed elements
+ */
+template <typename TNumber>
+size_t ParseNumericArray(const char *text, TNumber *values, size_t size);
+
+/*! Format a number list
+ *
+ * Floating point numbers are written with enough digits to be read
+ * back without loss of precision.
+ *
+ * \param values      The numbers to format
+ * \param size        The number of elements in \a values
+ * \param delimiter   The character written between elements
+ * \param result      The string the list is written to (it is cleared first)
+ */
+template <typename TNumber>
+void FormatNumericArray(const TNumber *values, size_t size, char delimiter, std::string &result);
+
+/*! Format a single number into a buffer without allocating memory
+ *
+ * The number is written like one element of FormatNumericArray.
+ *
+ * \param buffer   The buffer to write to (cMAX_FORMATTED_NUMBER_LENGTH characters are always sufficient)
+ * \param size     The capacity of \a buffer
+ * \param value    The number to format
+ *
+ * \returns The number of characters written (not zero-terminated)
+ */
+template <typename TNumber>
+size_t FormatNumber(char *buffer, size_t size, TNumber value);
+
+/*! Buffer size that is sufficient for FormatNumber */
+const size_t cMAX_FORMATTED_NUMBER_LENGTH = 64;
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+#endif
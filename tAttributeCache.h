@@ -0,0 +1,196 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tAttributeCache.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tAttributeCache
+ *
+ * \b tAttributeCache
+ *
+ * Converted values of the attributes of a single node. Instances are
+ * attached to a node via its _private pointer when caching is enabled
+ * for that node and are owned by the tDocument the node belongs to.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tAttributeCache_h__
+#define __rrlib__xml__tAttributeCache_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+extern "C"
+{
+#include <libxml/tree.h>
+}
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <cstring>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+namespace internal
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Cache of converted attribute values of one node
+/*! Entries are looked up by attribute name, requested type and the
+ *  number base used for conversion, so reading a cached value neither
+ *  searches the attribute list of the node nor converts text. A lookup
+ *  compares the name with the entries of the requested type, which are
+ *  only a few per node. Whoever changes or removes an attribute must
+ *  invalidate its entries.
+ *
+ */
+class tAttributeCache
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Get the cache attached to a node
+   *
+   * The _private pointer of a node may hold application data, so it is
+   * only used as cache if the document owns a cache at that address.
+   * It is never dereferenced otherwise.
+   *
+   * \param data     The _private pointer of the node
+   * \param caches   The caches owned by the document of the node
+   *
+   * \returns The cache or null if \a data is not a cache
+   */
+  static tAttributeCache *FromPrivateData(void *data, const std::unordered_set<tAttributeCache *> &caches)
+  {
+    auto it = caches.find(static_cast<tAttributeCache *>(data));
+    return it != caches.end() ? *it : 0;
+  }
+
+  template <typename TValue>
+  bool Lookup(const std::string &name, int base, TValue &value) const
+  {
+    for (auto it = this->entries.begin(); it != this->entries.end(); ++it)
+    {
+      if (it->type == TypeId<TValue>() && it->base == base && it->name == name)
+      {
+        std::memcpy(&value, &it->value, sizeof(TValue));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename TValue>
+  void Store(const xmlAttr *attribute, int base, TValue value)
+  {
+    static_assert(sizeof(TValue) <= sizeof(tStorage), "Type is too large to be cached");
+    tEntry entry;
+    entry.attribute = attribute;
+    entry.name = reinterpret_cast<const char *>(attribute->name);
+    entry.type = TypeId<TValue>();
+    entry.base = base;
+    std::memcpy(&entry.value, &value, sizeof(TValue));
+    this->entries.push_back(entry);
+  }
+
+  void Invalidate(const xmlAttr *attribute)
+  {
+    for (auto it = this->entries.begin(); it != this->entries.end();)
+    {
+      it = it->attribute == attribute ? this->entries.erase(it) : it + 1;
+    }
+  }
+
+  size_t MemoryUsage() const
+  {
+    size_t usage = sizeof(*this) + this->entries.capacity() * sizeof(tEntry);
+    for (auto it = this->entries.begin(); it != this->entries.end(); ++it)
+    {
+      usage += it->name.capacity();
+    }
+    return usage;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  union tStorage
+  {
+    long long int integer;
+    long double floating;
+  };
+
+  struct tEntry
+  {
+    const xmlAttr *attribute;
+    std::string name;
+    const void *type;
+    int base;
+    tStorage value;
+  };
+
+  std::vector<tEntry> entries;
+
+  template <typename TValue>
+  static const void *TypeId()
+  {
+    static const char id = 0;
+    return &id;
+  }
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+#endif
@@ -0,0 +1,670 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tCompressionCodec.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/tCompressionCodec.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <mutex>
+
+#ifdef _LIB_ZLIB_PRESENT_
+#include <zlib.h>
+#endif
+
+#ifdef _LIB_LIBZSTD_PRESENT_
+#include <zstd.h>
+#endif
+
+#ifdef _LIB_LIBLZ4_PRESENT_
+#include <lz4frame.h>
+#endif
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tException.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+const size_t tCompressionCodec::cMAX_MAGIC_SIZE;
+
+#if defined(_LIB_ZLIB_PRESENT_) || defined(_LIB_LIBLZ4_PRESENT_)
+namespace
+{
+
+const size_t cBUFFER_SIZE = 64 << 10;
+
+}
+#endif
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+#if defined(_LIB_ZLIB_PRESENT_) || defined(_LIB_LIBZSTD_PRESENT_) || defined(_LIB_LIBLZ4_PRESENT_)
+void ThrowTruncated(const char *codec)
+{
+  throw tException(std::string(codec) + " compressed data is truncated!");
+}
+#endif
+
+#ifdef _LIB_ZLIB_PRESENT_
+
+class tGzipCodec : public tCompressionCodec
+{
+  class tCompressor : public tCompressionCodec::tCompressor
+  {
+  public:
+    tCompressor(const tSink &sink, int level)
+      : sink(sink),
+        buffer(cBUFFER_SIZE)
+    {
+      std::memset(&this->stream, 0, sizeof(this->stream));
+      if (deflateInit2(&this->stream, level ? level : Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      {
+        throw tException("Could not initialize gzip compression!");
+      }
+    }
+
+    ~tCompressor()
+    {
+      deflateEnd(&this->stream);
+    }
+
+    virtual void Write(const char *data, size_t size) override
+    {
+      while (size > 0)
+      {
+        const size_t chunk = std::min<size_t>(size, UINT_MAX);
+        this->Deflate(data, chunk, Z_NO_FLUSH);
+        data += chunk;
+        size -= chunk;
+      }
+    }
+
+    virtual void Finish() override
+    {
+      this->Deflate(0, 0, Z_FINISH);
+    }
+
+  private:
+    tSink sink;
+    std::vector<char> buffer;
+    z_stream stream;
+
+    void Deflate(const char *data, size_t size, int flush)
+    {
+      this->stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+      this->stream.avail_in = size;
+      do
+      {
+        this->stream.next_out = reinterpret_cast<Bytef *>(this->buffer.data());
+        this->stream.avail_out = this->buffer.size();
+        if (deflate(&this->stream, flush) == Z_STREAM_ERROR)
+        {
+          throw tException("gzip compression failed!");
+        }
+        const size_t produced = this->buffer.size() - this->stream.avail_out;
+        if (produced)
+        {
+          this->sink(this->buffer.data(), produced);
+        }
+      }
+      while (this->stream.avail_out == 0);
+    }
+  };
+
+  class tDecompressor : public tCompressionCodec::tDecompressor
+  {
+  public:
+    explicit tDecompressor(const tSource &source)
+      : source(source),
+        buffer(cBUFFER_SIZE),
+        input_end(false),
+        stream_end(false)
+    {
+      std::memset(&this->stream, 0, sizeof(this->stream));
+      if (inflateInit2(&this->stream, 15 + 32) != Z_OK)
+      {
+        throw tException("Could not initialize gzip decompression!");
+      }
+    }
+
+    ~tDecompressor()
+    {
+      inflateEnd(&this->stream);
+    }
+
+    virtual size_t Read(char *data, size_t size) override
+    {
+      this->stream.next_out = reinterpret_cast<Bytef *>(data);
+      this->stream.avail_out = std::min<size_t>(size, UINT_MAX);
+      const size_t capacity = this->stream.avail_out;
+      while (this->stream.avail_out > 0 && !this->stream_end)
+      {
+        if (this->stream.avail_in == 0 && !this->input_end)
+        {
+          this->stream.next_in = reinterpret_cast<Bytef *>(this->buffer.data());
+          this->stream.avail_in = this->source(this->buffer.data(), this->buffer.size());
+          this->input_end = this->stream.avail_in == 0;
+        }
+        const int result = inflate(&this->stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END)
+        {
+          this->stream_end = true;
+        }
+        else if (result == Z_BUF_ERROR && this->input_end)
+        {
+          ThrowTruncated("gzip");
+        }
+        else if (result != Z_OK && result != Z_BUF_ERROR)
+        {
+          throw tException("gzip compressed data is corrupt!");
+        }
+      }
+      return capacity - this->stream.avail_out;
+    }
+
+  private:
+    tSource source;
+    std::vector<char> buffer;
+    z_stream stream;
+    bool input_end;
+    bool stream_end;
+  };
+
+public:
+
+  virtual const char *Name() const override
+  {
+    return "gzip";
+  }
+
+  virtual bool Detect(const char *header, size_t size) const override
+  {
+    return size >= 2 && static_cast<unsigned char>(header[0]) == 0x1F && static_cast<unsigned char>(header[1]) == 0x8B;
+  }
+
+  virtual std::unique_ptr<tCompressionCodec::tCompressor> CreateCompressor(const tSink &sink, int level) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tCompressor>(new tCompressor(sink, level));
+  }
+
+  virtual std::unique_ptr<tCompressionCodec::tDecompressor> CreateDecompressor(const tSource &source) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tDecompressor>(new tDecompressor(source));
+  }
+};
+
+#endif
+
+#ifdef _LIB_LIBZSTD_PRESENT_
+
+size_t CheckZstdResult(size_t result)
+{
+  if (ZSTD_isError(result))
+  {
+    throw tException(std::string("zstd error: ") + ZSTD_getErrorName(result));
+  }
+  return result;
+}
+
+class tZstdCodec : public tCompressionCodec
+{
+  class tCompressor : public tCompressionCodec::tCompressor
+  {
+  public:
+    tCompressor(const tSink &sink, int level)
+      : sink(sink),
+        buffer(ZSTD_CStreamOutSize()),
+        context(ZSTD_createCCtx())
+    {
+      if (!this->context)
+      {
+        throw tException("Could not initialize zstd compression!");
+      }
+      const size_t result = ZSTD_CCtx_setParameter(this->context, ZSTD_c_compressionLevel, level);
+      if (ZSTD_isError(result))
+      {
+        ZSTD_freeCCtx(this->context);
+        CheckZstdResult(result);
+      }
+    }
+
+    ~tCompressor()
+    {
+      ZSTD_freeCCtx(this->context);
+    }
+
+    virtual void Write(const char *data, size_t size) override
+    {
+      ZSTD_inBuffer input = { data, size, 0 };
+      while (input.pos < input.size)
+      {
+        this->Compress(input, ZSTD_e_continue);
+      }
+    }
+
+    virtual void Finish() override
+    {
+      ZSTD_inBuffer input = { 0, 0, 0 };
+      while (this->Compress(input, ZSTD_e_end))
+      {}
+    }
+
+  private:
+    tSink sink;
+    std::vector<char> buffer;
+    ZSTD_CCtx *context;
+
+    size_t Compress(ZSTD_inBuffer &input, ZSTD_EndDirective mode)
+    {
+      ZSTD_outBuffer output = { this->buffer.data(), this->buffer.size(), 0 };
+      const size_t remaining = CheckZstdResult(ZSTD_compressStream2(this->context, &output, &input, mode));
+      if (output.pos)
+      {
+        this->sink(this->buffer.data(), output.pos);
+      }
+      return remaining;
+    }
+  };
+
+  class tDecompressor : public tCompressionCodec::tDecompressor
+  {
+  public:
+    explicit tDecompressor(const tSource &source)
+      : source(source),
+        buffer(ZSTD_DStreamInSize()),
+        context(ZSTD_createDCtx()),
+        input_end(false),
+        frame_complete(false)
+    {
+      if (!this->context)
+      {
+        throw tException("Could not initialize zstd decompression!");
+      }
+      this->input.src = this->buffer.data();
+      this->input.size = 0;
+      this->input.pos = 0;
+    }
+
+    ~tDecompressor()
+    {
+      ZSTD_freeDCtx(this->context);
+    }
+
+    virtual size_t Read(char *data, size_t size) override
+    {
+      ZSTD_outBuffer output = { data, size, 0 };
+      while (output.pos < output.size)
+      {
+        if (this->input.pos == this->input.size && !this->input_end)
+        {
+          this->input.size = this->source(this->buffer.data(), this->buffer.size());
+          this->input.pos = 0;
+          this->input_end = this->input.size == 0;
+        }
+        const size_t previous_output = output.pos;
+        const size_t previous_input = this->input.pos;
+        const size_t result = CheckZstdResult(ZSTD_decompressStream(this->context, &output, &this->input));
+        if (output.pos != previous_output || this->input.pos != previous_input)
+        {
+          this->frame_complete = result == 0;
+        }
+        else if (this->input_end)
+        {
+          if (!this->frame_complete)
+          {
+            ThrowTruncated("zstd");
+          }
+          break;
+        }
+      }
+      return output.pos;
+    }
+
+  private:
+    tSource source;
+    std::vector<char> buffer;
+    ZSTD_DCtx *context;
+    ZSTD_inBuffer input;
+    bool input_end;
+    bool frame_complete;
+  };
+
+public:
+
+  virtual const char *Name() const override
+  {
+    return "zstd";
+  }
+
+  virtual bool Detect(const char *header, size_t size) const override
+  {
+    return size >= 4 && std::memcmp(header, "\x28\xB5\x2F\xFD", 4) == 0;
+  }
+
+  virtual std::unique_ptr<tCompressionCodec::tCompressor> CreateCompressor(const tSink &sink, int level) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tCompressor>(new tCompressor(sink, level));
+  }
+
+  virtual std::unique_ptr<tCompressionCodec::tDecompressor> CreateDecompressor(const tSource &source) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tDecompressor>(new tDecompressor(source));
+  }
+};
+
+#endif
+
+#ifdef _LIB_LIBLZ4_PRESENT_
+
+size_t CheckLz4Result(size_t result)
+{
+  if (LZ4F_isError(result))
+  {
+    throw tException(std::string("lz4 error: ") + LZ4F_getErrorName(result));
+  }
+  return result;
+}
+
+class tLz4Codec : public tCompressionCodec
+{
+  class tCompressor : public tCompressionCodec::tCompressor
+  {
+  public:
+    tCompressor(const tSink &sink, int level)
+      : sink(sink),
+        context(0)
+    {
+      std::memset(&this->preferences, 0, sizeof(this->preferences));
+      this->preferences.compressionLevel = level;
+      this->buffer.resize(LZ4F_compressBound(cBUFFER_SIZE, &this->preferences));
+      CheckLz4Result(LZ4F_createCompressionContext(&this->context, LZ4F_VERSION));
+      try
+      {
+        this->Emit(LZ4F_compressBegin(this->context, this->buffer.data(), this->buffer.size(), &this->preferences));
+      }
+      catch (...)
+      {
+        LZ4F_freeCompressionContext(this->context);
+        throw;
+      }
+    }
+
+    ~tCompressor()
+    {
+      LZ4F_freeCompressionContext(this->context);
+    }
+
+    virtual void Write(const char *data, size_t size) override
+    {
+      while (size > 0)
+      {
+        const size_t chunk = std::min(size, cBUFFER_SIZE);
+        this->Emit(LZ4F_compressUpdate(this->context, this->buffer.data(), this->buffer.size(), data, chunk, 0));
+        data += chunk;
+        size -= chunk;
+      }
+    }
+
+    virtual void Finish() override
+    {
+      this->Emit(LZ4F_compressEnd(this->context, this->buffer.data(), this->buffer.size(), 0));
+    }
+
+  private:
+    tSink sink;
+    std::vector<char> buffer;
+    LZ4F_preferences_t preferences;
+    LZ4F_cctx *context;
+
+    void Emit(size_t result)
+    {
+      if (CheckLz4Result(result))
+      {
+        this->sink(this->buffer.data(), result);
+      }
+    }
+  };
+
+  class tDecompressor : public tCompressionCodec::tDecompressor
+  {
+  public:
+    explicit tDecompressor(const tSource &source)
+      : source(source),
+        buffer(cBUFFER_SIZE),
+        context(0),
+        input_size(0),
+        input_position(0),
+        input_end(false),
+        frame_complete(false)
+    {
+      CheckLz4Result(LZ4F_createDecompressionContext(&this->context, LZ4F_VERSION));
+    }
+
+    ~tDecompressor()
+    {
+      LZ4F_freeDecompressionContext(this->context);
+    }
+
+    virtual size_t Read(char *data, size_t size) override
+    {
+      size_t produced = 0;
+      while (produced < size)
+      {
+        if (this->input_position == this->input_size && !this->input_end)
+        {
+          this->input_size = this->source(this->buffer.data(), this->buffer.size());
+          this->input_position = 0;
+          this->input_end = this->input_size == 0;
+        }
+        size_t output_size = size - produced;
+        size_t input_size = this->input_size - this->input_position;
+        const size_t result = CheckLz4Result(LZ4F_decompress(this->context, data + produced, &output_size, this->buffer.data() + this->input_position, &input_size, 0));
+        this->input_position += input_size;
+        produced += output_size;
+        if (output_size || input_size)
+        {
+          this->frame_complete = result == 0;
+        }
+        else if (this->input_end)
+        {
+          if (!this->frame_complete)
+          {
+            ThrowTruncated("lz4");
+          }
+          break;
+        }
+      }
+      return produced;
+    }
+
+  private:
+    tSource source;
+    std::vector<char> buffer;
+    LZ4F_dctx *context;
+    size_t input_size;
+    size_t input_position;
+    bool input_end;
+    bool frame_complete;
+  };
+
+public:
+
+  virtual const char *Name() const override
+  {
+    return "lz4";
+  }
+
+  virtual bool Detect(const char *header, size_t size) const override
+  {
+    return size >= 4 && std::memcmp(header, "\x04\x22\x4D\x18", 4) == 0;
+  }
+
+  virtual std::unique_ptr<tCompressionCodec::tCompressor> CreateCompressor(const tSink &sink, int level) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tCompressor>(new tCompressor(sink, level));
+  }
+
+  virtual std::unique_ptr<tCompressionCodec::tDecompressor> CreateDecompressor(const tSource &source) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tDecompressor>(new tDecompressor(source));
+  }
+};
+
+#endif
+
+struct tCodecRegistry
+{
+  std::mutex mutex;
+  std::vector<std::shared_ptr<const tCompressionCodec>> codecs;
+
+  tCodecRegistry()
+  {
+#ifdef _LIB_ZLIB_PRESENT_
+    this->codecs.push_back(std::make_shared<tGzipCodec>());
+#endif
+#ifdef _LIB_LIBZSTD_PRESENT_
+    this->codecs.push_back(std::make_shared<tZstdCodec>());
+#endif
+#ifdef _LIB_LIBLZ4_PRESENT_
+    this->codecs.push_back(std::make_shared<tLz4Codec>());
+#endif
+  }
+};
+
+tCodecRegistry &CodecRegistry()
+{
+  static tCodecRegistry registry;
+  return registry;
+}
+
+}
+
+//----------------------------------------------------------------------
+// RegisterCompressionCodec
+//----------------------------------------------------------------------
+void RegisterCompressionCodec(const std::shared_ptr<const tCompressionCodec> &codec)
+{
+  tCodecRegistry &registry = CodecRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto it = registry.codecs.begin(); it != registry.codecs.end(); ++it)
+  {
+    if (std::strcmp((*it)->Name(), codec->Name()) == 0)
+    {
+      *it = codec;
+      return;
+    }
+  }
+  registry.codecs.push_back(codec);
+}
+
+//----------------------------------------------------------------------
+// GetCompressionCodecNames
+//----------------------------------------------------------------------
+std::vector<std::string> GetCompressionCodecNames()
+{
+  tCodecRegistry &registry = CodecRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<std::string> names;
+  for (auto it = registry.codecs.begin(); it != registry.codecs.end(); ++it)
+  {
+    names.push_back((*it)->Name());
+  }
+  return names;
+}
+
+//----------------------------------------------------------------------
+// GetCompressionCodec
+//----------------------------------------------------------------------
+std::shared_ptr<const tCompressionCodec> GetCompressionCodec(const std::string &name)
+{
+  tCodecRegistry &registry = CodecRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto it = registry.codecs.begin(); it != registry.codecs.end(); ++it)
+  {
+    if (name == (*it)->Name())
+    {
+      return *it;
+    }
+  }
+  throw tException("Compression codec `" + name + "' is not available!");
+}
+
+//----------------------------------------------------------------------
+// DetectCompressionCodec
+//----------------------------------------------------------------------
+std::shared_ptr<const tCompressionCodec> DetectCompressionCodec(const char *header, size_t size)
+{
+  tCodecRegistry &registry = CodecRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto it = registry.codecs.begin(); it != registry.codecs.end(); ++it)
+  {
+    if ((*it)->Detect(header, size))
+    {
+      return *it;
+    }
+  }
+  return std::shared_ptr<const tCompressionCodec>();
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
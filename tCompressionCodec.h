@@ -0,0 +1,193 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tCompressionCodec.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tCompressionCodec
+ *
+ * \b tCompressionCodec
+ *
+ * Streaming compression codecs used by tDocument for reading and
+ * writing compressed files. Codecs are registered by name and
+ * identified by the magic bytes at the beginning of their output, so
+ * loading compressed documents is transparent. Depending on the
+ * libraries available at build time, "gzip" (zlib), "zstd" and "lz4"
+ * (frame format) are registered by default. Additional codecs can be
+ * added with RegisterCompressionCodec.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tCompressionCodec_h__
+#define __rrlib__xml__tCompressionCodec_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Interface of streaming compression codecs
+/*! A codec creates compressors that pass their output to a sink and
+ *  decompressors that pull their input from a source. Errors are
+ *  reported by throwing tException.
+ *
+ */
+class tCompressionCodec
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Receives compressed data */
+  typedef std::function<void(const char *data, size_t size)> tSink;
+
+  /*! Provides compressed data: fills up to size bytes into data and returns their number (0 at the end of input) */
+  typedef std::function<size_t(char *data, size_t size)> tSource;
+
+  //! A compression stream
+  class tCompressor
+  {
+  public:
+    virtual ~tCompressor() {}
+
+    /*! Compress data and pass any output to the sink */
+    virtual void Write(const char *data, size_t size) = 0;
+
+    /*! Flush remaining output and finish the compressed stream */
+    virtual void Finish() = 0;
+  };
+
+  //! A decompression stream
+  class tDecompressor
+  {
+  public:
+    virtual ~tDecompressor() {}
+
+    /*! Decompress up to size bytes into data
+     *
+     * \returns The number of decompressed bytes (0 at the end of the stream)
+     */
+    virtual size_t Read(char *data, size_t size) = 0;
+  };
+
+  virtual ~tCompressionCodec() {}
+
+  /*! Get the name used to select this codec
+   */
+  virtual const char *Name() const = 0;
+
+  /*! Check if data starts like a stream compressed with this codec
+   *
+   * \param header   The first bytes of the data
+   * \param size     The number of bytes in \a header (at least cMAX_MAGIC_SIZE unless the data is shorter)
+   */
+  virtual bool Detect(const char *header, size_t size) const = 0;
+
+  /*! Create a compressor
+   *
+   * \param sink    The destination of the compressed data
+   * \param level   The codec specific compression level (0 selects the codec's default)
+   */
+  virtual std::unique_ptr<tCompressor> CreateCompressor(const tSink &sink, int level) const = 0;
+
+  /*! Create a decompressor
+   *
+   * \param source   The origin of the compressed data
+   */
+  virtual std::unique_ptr<tDecompressor> CreateDecompressor(const tSource &source) const = 0;
+
+  /*! Number of bytes Detect needs to identify a codec */
+  static const size_t cMAX_MAGIC_SIZE = 16;
+
+};
+
+//----------------------------------------------------------------------
+// Function declarations
+//----------------------------------------------------------------------
+
+/*! Register a compression codec
+ *
+ * A registered codec replaces an existing codec with the same name.
+ *
+ * \param codec   The codec to register
+ */
+void RegisterCompressionCodec(const std::shared_ptr<const tCompressionCodec> &codec);
+
+/*! Get the names of all registered compression codecs
+ */
+std::vector<std::string> GetCompressionCodecNames();
+
+/*! Find a compression codec by name
+ *
+ * \exception tException is thrown if no codec with the given name is registered
+ *
+ * \param name   The name of the codec
+ */
+std::shared_ptr<const tCompressionCodec> GetCompressionCodec(const std::string &name);
+
+/*! Find the compression codec data was created with
+ *
+ * \param header   The first bytes of the data
+ * \param size     The number of bytes in \a header
+ *
+ * \returns The matching codec or an empty pointer for uncompressed data
+ */
+std::shared_ptr<const tCompressionCodec> DetectCompressionCodec(const char *header, size_t size);
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+#endif
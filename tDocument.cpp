@@ -32,8 +32,22 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 extern "C"
 {
@@ -43,8 +57,12 @@ extern "C"
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
+#include "rrlib/xml/arena.h"
 #include "rrlib/xml/tException.h"
 #include "rrlib/xml/tCleanupHandler.h"
+#include "rrlib/xml/tAttributeCache.h"
+#include "rrlib/xml/tCompressionCodec.h"
+#include "rrlib/xml/in_place_parser.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -70,60 +88,669 @@ namespace xml
 //----------------------------------------------------------------------
 // Const values
 //----------------------------------------------------------------------
+namespace
+{
+
+// More chunks than threads balance children of different size
+const size_t cCHUNKS_PER_THREAD = 4;
+
+// Estimated size of an entry in the hash table of a libxml2 dictionary (the structure is not public)
+const size_t cDICTIONARY_ENTRY_SIZE = 4 * sizeof(void *);
+
+// Estimated size of a node in an unordered container
+const size_t cHASH_NODE_OVERHEAD = 2 * sizeof(void *);
+
+}
 
 //----------------------------------------------------------------------
 // Implementation
 //----------------------------------------------------------------------
+namespace
+{
+
+struct tDecompressionContext
+{
+  std::unique_ptr<tCompressionCodec::tDecompressor> decompressor;
+  std::exception_ptr exception;
+};
+
+// Exceptions must not unwind through libxml2, so they are stored and rethrown afterwards
+int ReadFromDecompressor(void *context, char *buffer, int length)
+{
+  tDecompressionContext &decompression_context = *static_cast<tDecompressionContext *>(context);
+  try
+  {
+    return decompression_context.decompressor->Read(buffer, length);
+  }
+  catch (...)
+  {
+    decompression_context.exception = std::current_exception();
+    return -1;
+  }
+}
+
+xmlDocPtr ReadCompressedDocument(const tCompressionCodec &codec, const tCompressionCodec::tSource &source, const char *url, const char *encoding, int options)
+{
+  tDecompressionContext context = { codec.CreateDecompressor(source), std::exception_ptr() };
+  xmlDocPtr document = xmlReadIO(ReadFromDecompressor, 0, &context, url, encoding, options);
+  if (context.exception)
+  {
+    xmlFreeDoc(document);
+    std::rethrow_exception(context.exception);
+  }
+  return document;
+}
+
+xmlDocPtr ReadDocument(const std::string &file_name, const char *encoding, int options)
+{
+  std::unique_ptr<FILE, int(*)(FILE *)> file(std::fopen(file_name.c_str(), "rb"), std::fclose);
+  if (file)
+  {
+    char header[tCompressionCodec::cMAX_MAGIC_SIZE];
+    const size_t header_size = std::fread(header, 1, sizeof(header), file.get());
+    std::shared_ptr<const tCompressionCodec> codec = DetectCompressionCodec(header, header_size);
+    if (codec)
+    {
+      size_t header_position = 0;
+      FILE *input = file.get();
+      return ReadCompressedDocument(*codec, [&](char *data, size_t size)
+      {
+        if (header_position < header_size)
+        {
+          const size_t count = std::min(size, header_size - header_position);
+          std::memcpy(data, header + header_position, count);
+          header_position += count;
+          return count;
+        }
+        const size_t count = std::fread(data, 1, size, input);
+        if (count == 0 && std::ferror(input))
+        {
+          throw tException("Could not read XML file `" + file_name + "'!");
+        }
+        return count;
+      }, file_name.c_str(), encoding, options);
+    }
+  }
+  file.reset();
+  return xmlReadFile(file_name.c_str(), encoding, options);
+}
+
+xmlDocPtr ReadDocument(const void *buffer, size_t size, const char *encoding, int options)
+{
+  const char *data = reinterpret_cast<const char *>(buffer);
+  std::shared_ptr<const tCompressionCodec> codec = DetectCompressionCodec(data, std::min(size, tCompressionCodec::cMAX_MAGIC_SIZE));
+  if (codec)
+  {
+    size_t position = 0;
+    return ReadCompressedDocument(*codec, [&](char *output, size_t output_size)
+    {
+      const size_t count = std::min(output_size, size - position);
+      std::memcpy(output, data + position, count);
+      position += count;
+      return count;
+    }, "noname.xml", encoding, options);
+  }
+  return xmlReadMemory(data, size, "noname.xml", encoding, options);
+}
+
+struct tCompressionContext
+{
+  tCompressionCodec::tCompressor &compressor;
+  std::exception_ptr exception;
+};
+
+int WriteToCompressor(void *context, const char *buffer, int length)
+{
+  tCompressionContext &compression_context = *static_cast<tCompressionContext *>(context);
+  try
+  {
+    compression_context.compressor.Write(buffer, length);
+  }
+  catch (...)
+  {
+    compression_context.exception = std::current_exception();
+    return -1;
+  }
+  return length;
+}
+
+void SaveDocument(xmlDocPtr document, const std::string &file_name, const tCompressionCodec *codec = 0, int level = 0)
+{
+  if (!codec)
+  {
+    if (xmlSaveFormatFileEnc(file_name.c_str(), document, "UTF-8", 1) < 0)
+    {
+      throw tException("Could not write XML document to file `" + file_name + "'!");
+    }
+    return;
+  }
+
+  std::unique_ptr<FILE, int(*)(FILE *)> file(std::fopen(file_name.c_str(), "wb"), std::fclose);
+  if (!file)
+  {
+    throw tException("Could not write XML document to file `" + file_name + "'!");
+  }
+  FILE *output_file = file.get();
+  std::unique_ptr<tCompressionCodec::tCompressor> compressor = codec->CreateCompressor([output_file, &file_name](const char *data, size_t size)
+  {
+    if (std::fwrite(data, 1, size, output_file) != size)
+    {
+      throw tException("Could not write XML document to file `" + file_name + "'!");
+    }
+  }, level);
+  tCompressionContext context = { *compressor, std::exception_ptr() };
+  const int result = xmlSaveFormatFileTo(xmlOutputBufferCreateIO(WriteToCompressor, 0, &context, 0), document, "UTF-8", 1);
+  if (context.exception)
+  {
+    std::rethrow_exception(context.exception);
+  }
+  if (result < 0)
+  {
+    throw tException("Could not write XML document to file `" + file_name + "'!");
+  }
+  compressor->Finish();
+  if (std::fclose(file.release()) != 0)
+  {
+    throw tException("Could not write XML document to file `" + file_name + "'!");
+  }
+}
+
+int AppendToString(void *context, const char *buffer, int length)
+{
+  static_cast<std::string *>(context)->append(buffer, length);
+  return length;
+}
+
+// Serializes the document without the children of its root like SaveDocument, which yields everything around them
+std::string SerializeFrame(xmlDocPtr document)
+{
+  std::unique_ptr<xmlDoc, void(*)(xmlDocPtr)> frame(xmlCopyDoc(document, 0), xmlFreeDoc);
+  if (!frame)
+  {
+    throw tException("Could not copy XML document for writing!");
+  }
+  xmlDocSetRootElement(frame.get(), xmlDocCopyNode(xmlDocGetRootElement(document), frame.get(), 2));
+  std::string output;
+  if (xmlSaveFormatFileTo(xmlOutputBufferCreateIO(AppendToString, 0, &output, 0), frame.get(), "UTF-8", 1) < 0)
+  {
+    throw tException("Could not serialize XML document!");
+  }
+  return output;
+}
+
+// Serializes the children [first, end) of the root node in the way xmlSaveFormatFileTo writes them
+void SerializeChildren(xmlDocPtr document, xmlNodePtr first, xmlNodePtr end, bool format, const char *indentation, std::string &output)
+{
+  xmlOutputBufferPtr buffer = xmlOutputBufferCreateIO(AppendToString, 0, &output, 0);
+  if (!buffer)
+  {
+    throw tException("Could not create output buffer!");
+  }
+  for (xmlNodePtr node = first; node != end; node = node->next)
+  {
+    if (format && (node->type == XML_ELEMENT_NODE || node->type == XML_COMMENT_NODE || node->type == XML_PI_NODE))
+    {
+      xmlOutputBufferWriteString(buffer, indentation);
+    }
+    xmlNodeDumpOutput(buffer, document, node, 1, format, 0);
+    if (format)
+    {
+      xmlOutputBufferWrite(buffer, 1, "\n");
+    }
+  }
+  if (xmlOutputBufferClose(buffer) < 0)
+  {
+    throw tException("Could not serialize XML document!");
+  }
+}
+
+// Announces an output encoding to libxml2 while serializing and restores the previous one on every exit path
+class tEncodingScope : public util::tNoncopyable
+{
+  xmlDocPtr document;
+  const xmlChar *previous;
+public:
+  tEncodingScope(xmlDocPtr document, const char *encoding)
+    : document(document), previous(document->encoding)
+  {
+    document->encoding = reinterpret_cast<const xmlChar *>(encoding);
+  }
+  ~tEncodingScope()
+  {
+    this->document->encoding = this->previous;
+  }
+};
+
+// Joins the started threads on every exit path, so no joinable std::thread is destroyed
+class tThreadGroup : public util::tNoncopyable
+{
+  std::vector<std::thread> threads;
+public:
+  ~tThreadGroup()
+  {
+    this->Join();
+  }
+  template <typename TFunction>
+  void Start(size_t count, TFunction function)
+  {
+    this->threads.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      this->threads.emplace_back(function);
+    }
+  }
+  void Join()
+  {
+    for (auto it = this->threads.begin(); it != this->threads.end(); ++it)
+    {
+      if (it->joinable())
+      {
+        it->join();
+      }
+    }
+  }
+};
+
+void WriteBuffers(int file_descriptor, std::vector<iovec> &buffers)
+{
+  for (size_t index = 0; index < buffers.size();)
+  {
+    ssize_t written = writev(file_descriptor, &buffers[index], std::min<size_t>(buffers.size() - index, IOV_MAX));
+    if (written < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw tException("Could not write XML output!");
+    }
+    for (; index < buffers.size() && static_cast<size_t>(written) >= buffers[index].iov_len; ++index)
+    {
+      written -= buffers[index].iov_len;
+    }
+    if (written > 0)
+    {
+      buffers[index].iov_base = static_cast<char *>(buffers[index].iov_base) + written;
+      buffers[index].iov_len -= written;
+    }
+  }
+}
+
+void SyncFile(const std::string &file_name, int flags)
+{
+  const int file_descriptor = open(file_name.c_str(), flags);
+  if (file_descriptor < 0)
+  {
+    throw tException("Could not open `" + file_name + "' for synchronization!");
+  }
+  // Some file systems do not support syncing directories (EINVAL) which is fine
+  const bool synced = fsync(file_descriptor) == 0 || (errno == EINVAL && (flags & O_DIRECTORY));
+  close(file_descriptor);
+  if (!synced)
+  {
+    throw tException("Could not synchronize `" + file_name + "' to disk!");
+  }
+}
+
+// Writes a temporary file next to the target, syncs it and renames it into place
+void SaveDocumentAtomically(xmlDocPtr document, const std::string &file_name, const tCompressionCodec *codec, int level)
+{
+  static std::atomic<unsigned int> counter(0);
+  const std::string temporary_file_name = file_name + "." + std::to_string(getpid()) + "." + std::to_string(counter++) + ".tmp";
+  try
+  {
+    SaveDocument(document, temporary_file_name, codec, level);
+    SyncFile(temporary_file_name, O_RDONLY);
+    if (std::rename(temporary_file_name.c_str(), file_name.c_str()) != 0)
+    {
+      throw tException("Could not rename `" + temporary_file_name + "' to `" + file_name + "'!");
+    }
+  }
+  catch (...)
+  {
+    std::remove(temporary_file_name.c_str());
+    throw;
+  }
+  const size_t separator = file_name.rfind('/');
+  SyncFile(separator == std::string::npos ? "." : (separator == 0 ? "/" : file_name.substr(0, separator)), O_RDONLY | O_DIRECTORY);
+}
+
+// Records a generation written in the background unless a later one was recorded meanwhile
+void RecordSavedGeneration(std::atomic<uint64_t> &saved_generation, uint64_t generation)
+{
+  uint64_t previous = saved_generation.load();
+  while (previous < generation && !saved_generation.compare_exchange_weak(previous, generation))
+  {}
+}
+
+struct tLiveDocuments
+{
+  std::mutex mutex;
+  std::unordered_set<const tDocument *> documents;
+};
+
+// Never destroyed, as documents with static storage duration may be destroyed later
+tLiveDocuments &LiveDocuments()
+{
+  static tLiveDocuments *live_documents = new tLiveDocuments();
+  return *live_documents;
+}
+
+// Adds the sizes of the strings and structures of a DOM tree to a footprint
+class tFootprintWalk
+{
+public:
+
+  tFootprintWalk(const xmlDoc *document, tDocument::tMemoryFootprint &footprint)
+    : dictionary(document->dict),
+      footprint(footprint)
+  {}
+
+  void AddTree(const xmlDoc *document)
+  {
+    const xmlNode *document_node = reinterpret_cast<const xmlNode *>(document);
+    const xmlNode *node = document->children;
+    while (node)
+    {
+      this->AddNode(node);
+      if (node->type == XML_ELEMENT_NODE && node->children)
+      {
+        node = node->children;
+        continue;
+      }
+      while (node != document_node && !node->next)
+      {
+        node = node->parent;
+      }
+      node = node != document_node ? node->next : 0;
+    }
+  }
+
+  void AddString(const xmlChar *string, size_t &size)
+  {
+    if (!string)
+    {
+      return;
+    }
+    if (this->dictionary && xmlDictOwns(this->dictionary, string) == 1)
+    {
+      if (this->dictionary_strings.insert(string).second)
+      {
+        this->footprint.dictionary += xmlStrlen(string) + 1;
+      }
+      return;
+    }
+    size += xmlStrlen(string) + 1;
+  }
+
+private:
+
+  xmlDictPtr dictionary;
+  std::unordered_set<const xmlChar *> dictionary_strings;
+  tDocument::tMemoryFootprint &footprint;
+
+  // Short text can be stored within the node structure by the parser
+  void AddContent(const xmlNode *node)
+  {
+    if (node->content != reinterpret_cast<const xmlChar *>(&node->properties))
+    {
+      this->AddString(node->content, this->footprint.text);
+    }
+  }
+
+  void AddNode(const xmlNode *node)
+  {
+    switch (node->type)
+    {
+    case XML_ELEMENT_NODE:
+      this->footprint.nodes += sizeof(xmlNode);
+      this->AddString(node->name, this->footprint.names);
+      for (const xmlNs *ns = node->nsDef; ns; ns = ns->next)
+      {
+        this->footprint.names += sizeof(xmlNs);
+        this->AddString(ns->href, this->footprint.names);
+        this->AddString(ns->prefix, this->footprint.names);
+      }
+      for (const xmlAttr *attribute = node->properties; attribute; attribute = attribute->next)
+      {
+        this->footprint.attributes += sizeof(xmlAttr);
+        this->AddString(attribute->name, this->footprint.names);
+        for (const xmlNode *value = attribute->children; value; value = value->next)
+        {
+          this->footprint.attributes += sizeof(xmlNode);
+          this->AddContent(value);
+        }
+      }
+      break;
+    case XML_DTD_NODE:
+      this->footprint.nodes += sizeof(xmlDtd);
+      break;
+    case XML_PI_NODE:
+    case XML_ENTITY_REF_NODE:
+      this->footprint.nodes += sizeof(xmlNode);
+      this->AddString(node->name, this->footprint.names);
+      this->AddContent(node);
+      break;
+    default:
+      // The names of text, CDATA and comment nodes are static strings of libxml2
+      this->footprint.nodes += sizeof(xmlNode);
+      this->AddContent(node);
+    }
+  }
+};
+
+}
+
+//----------------------------------------------------------------------
+// tDocument static members
+//----------------------------------------------------------------------
+const tDocument::tArenaAllocation tDocument::cARENA_ALLOCATION = tDocument::tArenaAllocation();
+
+//----------------------------------------------------------------------
+// tDocument::tMemoryFootprint constructors
+//----------------------------------------------------------------------
+tDocument::tMemoryFootprint::tMemoryFootprint()
+  : nodes(0),
+    attributes(0),
+    text(0),
+    names(0),
+    dictionary(0),
+    caches(0),
+    arena(0)
+{}
+
+//----------------------------------------------------------------------
+// tDocument::tMemoryFootprint Total
+//----------------------------------------------------------------------
+size_t tDocument::tMemoryFootprint::Total() const
+{
+  if (this->arena)
+  {
+    return this->arena + this->caches;
+  }
+  return this->nodes + this->attributes + this->text + this->names + this->dictionary + this->caches;
+}
+
+//----------------------------------------------------------------------
+// tDocument::tMemoryFootprint operator +=
+//----------------------------------------------------------------------
+tDocument::tMemoryFootprint &tDocument::tMemoryFootprint::operator += (const tMemoryFootprint &other)
+{
+  this->nodes += other.nodes;
+  this->attributes += other.attributes;
+  this->text += other.text;
+  this->names += other.names;
+  this->dictionary += other.dictionary;
+  this->caches += other.caches;
+  this->arena += other.arena;
+  return *this;
+}
+
+//----------------------------------------------------------------------
+// tDocument::tLiveDocument constructors
+//----------------------------------------------------------------------
+tDocument::tLiveDocument::tLiveDocument(const tDocument *document)
+  : document(document)
+{
+  tLiveDocuments &live_documents = LiveDocuments();
+  std::lock_guard<std::mutex> lock(live_documents.mutex);
+  live_documents.documents.insert(document);
+}
+
+//----------------------------------------------------------------------
+// tDocument::tLiveDocument destructor
+//----------------------------------------------------------------------
+tDocument::tLiveDocument::~tLiveDocument()
+{
+  tLiveDocuments &live_documents = LiveDocuments();
+  std::lock_guard<std::mutex> lock(live_documents.mutex);
+  live_documents.documents.erase(this->document);
+}
 
 //----------------------------------------------------------------------
 // tDocument constructors
 //----------------------------------------------------------------------
 tDocument::tDocument()
   : document(xmlNewDoc(reinterpret_cast<const xmlChar *>("1.0"))),
-    root_node(0)
+    root_node(0),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
 {
   assert(this->document);
+  this->document->_private = this;
   tCleanupHandler::Instance();
 }
 
 tDocument::tDocument(const std::string &file_name, bool validate)
-  : document(xmlReadFile(file_name.c_str(), 0, validate ? XML_PARSE_DTDVALID : 0)),
-    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document)))
+  : document(ReadDocument(file_name, 0, validate ? XML_PARSE_DTDVALID : 0)),
+    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document))),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
 {
   this->CheckIfDocumentIsValid("Could not parse XML file `" + file_name + "'!");
   tCleanupHandler::Instance();
 }
 
 tDocument::tDocument(const std::string &file_name, const std::string &encoding, bool validate)
-  : document(xmlReadFile(file_name.c_str(), encoding.c_str(), validate ? XML_PARSE_DTDVALID : 0)),
-    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document)))
+  : document(ReadDocument(file_name, encoding.c_str(), validate ? XML_PARSE_DTDVALID : 0)),
+    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document))),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
 {
   this->CheckIfDocumentIsValid("Could not parse XML file `" + file_name + "'!");
   tCleanupHandler::Instance();
 }
 
 tDocument::tDocument(const void *buffer, size_t size, bool validate)
-  : document(xmlReadMemory(reinterpret_cast<const char *>(buffer), size, "noname.xml", 0, validate ? XML_PARSE_DTDVALID : 0)),
-    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document)))
+  : document(ReadDocument(buffer, size, 0, validate ? XML_PARSE_DTDVALID : 0)),
+    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document))),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
 {
   this->CheckIfDocumentIsValid("Could not parse XML from memory buffer `" + std::string(reinterpret_cast<const char *>(buffer)) + "'!");
   tCleanupHandler::Instance();
 }
 
 tDocument::tDocument(const void *buffer, size_t size, const std::string &encoding, bool validate)
-  : document(xmlReadMemory(reinterpret_cast<const char *>(buffer), size, "noname.xml", encoding.c_str(), validate ? XML_PARSE_DTDVALID : 0)),
-    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document)))
+  : document(ReadDocument(buffer, size, encoding.c_str(), validate ? XML_PARSE_DTDVALID : 0)),
+    root_node(reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document))),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
 {
   this->CheckIfDocumentIsValid("Could not parse XML from memory buffer `" + std::string(reinterpret_cast<const char *>(buffer)) + "'!");
   tCleanupHandler::Instance();
 }
 
+tDocument::tDocument(tArenaAllocation)
+  : arena(new internal::tArena()),
+    document(0),
+    root_node(0),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
+{
+  tCleanupHandler::Instance();
+  internal::tArenaScope arena_scope(this->arena.get());
+  this->document = xmlNewDoc(reinterpret_cast<const xmlChar *>("1.0"));
+  assert(this->document);
+  this->document->_private = this;
+}
+
+tDocument::tDocument(tArenaAllocation, const std::string &file_name, bool validate)
+  : arena(new internal::tArena()),
+    document(0),
+    root_node(0),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
+{
+  tCleanupHandler::Instance();
+  {
+    internal::tArenaScope arena_scope(this->arena.get());
+    this->document = ReadDocument(file_name, 0, validate ? XML_PARSE_DTDVALID : 0);
+    // The last error refers to strings allocated while parsing
+    xmlResetLastError();
+  }
+  this->CheckIfDocumentIsValid("Could not parse XML file `" + file_name + "'!");
+  this->root_node = reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document));
+}
+
+tDocument::tDocument(tArenaAllocation, const void *buffer, size_t size, bool validate)
+  : arena(new internal::tArena()),
+    document(0),
+    root_node(0),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
+{
+  tCleanupHandler::Instance();
+  {
+    internal::tArenaScope arena_scope(this->arena.get());
+    this->document = ReadDocument(buffer, size, 0, validate ? XML_PARSE_DTDVALID : 0);
+    // The last error refers to strings allocated while parsing
+    xmlResetLastError();
+  }
+  this->CheckIfDocumentIsValid("Could not parse XML from memory buffer `" + std::string(reinterpret_cast<const char *>(buffer)) + "'!");
+  this->root_node = reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document));
+}
+
 tDocument::tDocument(tDocument && other)
   : document(0),
-    root_node(0)
+    root_node(0),
+    fingerprint_cache_enabled(false),
+    generation(0),
+    saved_generation(std::make_shared<std::atomic<uint64_t>>(0)),
+    snapshot_generation(0)
 {
+  std::swap(arena, other.arena);
   std::swap(document, other.document);
   std::swap(root_node, other.root_node);
+  std::swap(attribute_caches, other.attribute_caches);
+  std::swap(fingerprint_cache_enabled, other.fingerprint_cache_enabled);
+  std::swap(fingerprints, other.fingerprints);
+  std::swap(child_indices, other.child_indices);
+  std::swap(generation, other.generation);
+  std::swap(saved_generation, other.saved_generation);
+  std::swap(snapshot, other.snapshot);
+  std::swap(snapshot_generation, other.snapshot_generation);
+  std::swap(in_place_parser, other.in_place_parser);
+  if (this->document)
+  {
+    this->document->_private = this;
+  }
 }
 
 //----------------------------------------------------------------------
@@ -131,7 +758,9 @@ tDocument::tDocument(tDocument && other)
 //----------------------------------------------------------------------
 tDocument::~tDocument()
 {
-  if (this->document)
+  this->ClearAttributeCaches();
+  // The memory of arena documents is released with the arena
+  if (this->document && !this->arena)
   {
     xmlFreeDoc(this->document);
   }
@@ -146,12 +775,161 @@ tDocument &tDocument::operator = (const tDocument & other)
   {
     return *this;
   }
-  xmlFreeDoc(this->document);
+  this->ClearAttributeCaches();
+  this->fingerprints.clear();
+  this->child_indices.clear();
+  std::unique_ptr<internal::tArena> previous_arena;
+  if (this->arena)
+  {
+    previous_arena = std::move(this->arena);
+    this->arena.reset(new internal::tArena());
+  }
+  else
+  {
+    xmlFreeDoc(this->document);
+  }
+  internal::tArenaScope arena_scope(this->arena.get());
   this->document = xmlCopyDoc(other.document, true);
+  this->document->_private = this;
   this->root_node = reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document));
+  ++this->generation;
   return *this;
 }
 
+//----------------------------------------------------------------------
+// tDocument Snapshot
+//----------------------------------------------------------------------
+std::shared_ptr<const tDocument> tDocument::Snapshot() const
+{
+  if (!this->snapshot || this->snapshot_generation != this->generation)
+  {
+    std::shared_ptr<tDocument> copy(this->arena ? new tDocument(cARENA_ALLOCATION) : new tDocument());
+    *copy = *this;
+    this->snapshot = copy;
+    this->snapshot_generation = this->generation;
+  }
+  return this->snapshot;
+}
+
+//----------------------------------------------------------------------
+// tDocument Freeze
+//----------------------------------------------------------------------
+tFrozenDocument tDocument::Freeze() const
+{
+  return tFrozenDocument(this->RootNode());
+}
+
+//----------------------------------------------------------------------
+// tDocument Compact
+//----------------------------------------------------------------------
+void tDocument::Compact()
+{
+  // The copy allocates each node before its name, attributes and children
+  std::unique_ptr<internal::tArena> compact_arena(new internal::tArena());
+  xmlDocPtr compact_document = 0;
+  {
+    internal::tArenaScope arena_scope(compact_arena.get());
+    compact_document = xmlCopyDoc(this->document, true);
+  }
+  if (!compact_document)
+  {
+    throw tException("Could not copy document for compaction!");
+  }
+
+  this->ClearAttributeCaches();
+  this->fingerprints.clear();
+  this->child_indices.clear();
+  if (!this->arena)
+  {
+    xmlFreeDoc(this->document);
+  }
+  this->arena = std::move(compact_arena);
+  this->document = compact_document;
+  this->document->_private = this;
+  this->root_node = reinterpret_cast<tNode *>(xmlDocGetRootElement(this->document));
+}
+
+//----------------------------------------------------------------------
+// tDocument Reparse
+//----------------------------------------------------------------------
+bool tDocument::Reparse(const void *buffer, size_t size, bool validate)
+{
+  const char *data = reinterpret_cast<const char *>(buffer);
+  if (this->root_node && !DetectCompressionCodec(data, std::min(size, tCompressionCodec::cMAX_MAGIC_SIZE)))
+  {
+    if (!this->in_place_parser)
+    {
+      this->in_place_parser.reset(new internal::tInPlaceParser());
+    }
+    if (this->in_place_parser->Match(this->document, data, size))
+    {
+      // Values are only written after the whole message matched, so a mismatch leaves the document untouched
+      internal::tArenaScope arena_scope(this->arena.get());
+      const std::vector<internal::tInPlaceParser::tChange> &changes = this->in_place_parser->Changes();
+      for (auto it = changes.begin(); it != changes.end(); ++it)
+      {
+        const xmlChar *value = reinterpret_cast<const xmlChar *>(this->in_place_parser->Value(*it));
+        xmlNodePtr target = it->target;
+        xmlAttrPtr attribute = 0;
+        if (target->type == XML_ATTRIBUTE_NODE)
+        {
+          // Empty attribute values have no text node
+          xmlNodePtr text_node = xmlNewDocTextLen(this->document, value, it->length);
+          if (!text_node)
+          {
+            throw tException("Could not allocate memory for attribute value!");
+          }
+          text_node->parent = target;
+          target->children = text_node;
+          target->last = text_node;
+          attribute = reinterpret_cast<xmlAttrPtr>(target);
+        }
+        else
+        {
+          // Short text is stored inside the node and other text is overwritten as long as the new value fits
+          xmlChar *content = target->content;
+          const bool inline_content = content == reinterpret_cast<xmlChar *>(&target->properties);
+          const bool owned_by_dictionary = this->document->dict && xmlDictOwns(this->document->dict, content) == 1;
+          if ((inline_content && it->length < 2 * sizeof(void *)) ||
+              (!inline_content && content && !owned_by_dictionary && it->length <= std::strlen(reinterpret_cast<const char *>(content))))
+          {
+            std::memcpy(content, value, it->length + 1);
+          }
+          else
+          {
+            xmlNodeSetContentLen(target, value, it->length);
+          }
+          if (target->parent->type == XML_ATTRIBUTE_NODE)
+          {
+            attribute = reinterpret_cast<xmlAttrPtr>(target->parent);
+          }
+        }
+
+        tNode &element = *reinterpret_cast<tNode *>(attribute ? attribute->parent : target->parent);
+        internal::tAttributeCache *cache = attribute ? element.AttributeCache() : 0;
+        if (cache)
+        {
+          cache->Invalidate(attribute);
+        }
+        element.ContentModified();
+      }
+      return true;
+    }
+  }
+
+  std::unique_ptr<tDocument> parsed(this->arena ? new tDocument(cARENA_ALLOCATION, buffer, size, validate) : new tDocument(buffer, size, validate));
+  this->ClearAttributeCaches();
+  this->fingerprints.clear();
+  this->child_indices.clear();
+  std::swap(this->arena, parsed->arena);
+  std::swap(this->document, parsed->document);
+  std::swap(this->root_node, parsed->root_node);
+  this->document->_private = this;
+  parsed->document->_private = parsed.get();
+  ++this->generation;
+  return false;
+}
+
 //----------------------------------------------------------------------
 // tDocument RootNode
 //----------------------------------------------------------------------
@@ -173,8 +951,10 @@ tNode &tDocument::AddRootNode(const std::string &name)
   {
     throw tException("Root node already exists with name `" + name + "'!");
   }
+  internal::tArenaScope arena_scope(this->arena.get());
   this->root_node = reinterpret_cast<tNode *>(xmlNewNode(0, reinterpret_cast<const xmlChar *>(name.c_str())));
   xmlDocSetRootElement(this->document, this->root_node);
+  ++this->generation;
   return *this->root_node;
 }
 
@@ -222,7 +1002,191 @@ void tDocument::WriteToFile(const std::string &file_name, int compression) const
   {
     xmlSetDocCompressMode(this->document, compression);
   }
-  xmlSaveFormatFileEnc(file_name.c_str(), this->document, "UTF-8", 1);
+  SaveDocument(this->document, file_name);
+  *this->saved_generation = this->generation;
+}
+
+//----------------------------------------------------------------------
+// tDocument WriteToFileParallel
+//----------------------------------------------------------------------
+void tDocument::WriteToFileParallel(const std::string &file_name, unsigned int threads) const
+{
+  if (threads == 0)
+  {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  xmlNodePtr root = xmlDocGetRootElement(this->document);
+  if (threads == 1 || !root || this->document->children != root || root->next || !root->children)
+  {
+    this->WriteToFile(file_name);
+    return;
+  }
+
+  // libxml2 only indents children of elements without text
+  bool format = true;
+  size_t child_count = 0;
+  for (xmlNodePtr child = root->children; child; child = child->next)
+  {
+    format &= child->type != XML_TEXT_NODE && child->type != XML_CDATA_SECTION_NODE && child->type != XML_ENTITY_REF_NODE;
+    ++child_count;
+  }
+
+  const std::string frame = SerializeFrame(this->document);
+  if (frame.size() < 3 || frame.compare(frame.size() - 3, 3, "/>\n") != 0)
+  {
+    this->WriteToFile(file_name);
+    return;
+  }
+  const std::string start_tag = frame.substr(0, frame.size() - 3) + (format ? ">\n" : ">");
+  std::string end_tag = "</";
+  if (root->ns && root->ns->prefix)
+  {
+    end_tag.append(reinterpret_cast<const char *>(root->ns->prefix)).append(":");
+  }
+  end_tag.append(reinterpret_cast<const char *>(root->name)).append(">\n");
+
+  const size_t chunk_count = std::min(child_count, threads * cCHUNKS_PER_THREAD);
+  std::vector<xmlNodePtr> chunk_begin;
+  xmlNodePtr child = root->children;
+  for (size_t i = 0; i < child_count; child = child->next, ++i)
+  {
+    if (i * chunk_count / child_count == chunk_begin.size())
+    {
+      chunk_begin.push_back(child);
+    }
+  }
+  chunk_begin.push_back(0);
+
+  const char *indentation = xmlIndentTreeOutput ? xmlTreeIndentString : "";
+  std::vector<std::string> chunks(chunk_count);
+  std::vector<std::exception_ptr> exceptions(chunk_count);
+  std::atomic<size_t> next_chunk(0);
+  auto serialize = [&]
+  {
+    for (size_t i = next_chunk++; i < chunk_count; i = next_chunk++)
+    {
+      try
+      {
+        SerializeChildren(this->document, chunk_begin[i], chunk_begin[i + 1], format, indentation, chunks[i]);
+      }
+      catch (...)
+      {
+        exceptions[i] = std::current_exception();
+      }
+    }
+  };
+  {
+    // Like xmlSaveFormatFileEnc, announce the output encoding while serializing, so non-ASCII characters in attributes are not escaped
+    tEncodingScope encoding_scope(this->document, "UTF-8");
+    tThreadGroup workers;
+    try
+    {
+      workers.Start(std::min<size_t>(threads, chunk_count) - 1, serialize);
+    }
+    catch (const std::system_error &)
+    {
+      // Chunks are claimed dynamically, so the calling thread and the workers started so far serialize the rest
+    }
+    serialize();
+    workers.Join();
+  }
+  for (auto it = exceptions.begin(); it != exceptions.end(); ++it)
+  {
+    if (*it)
+    {
+      std::rethrow_exception(*it);
+    }
+  }
+
+  std::vector<iovec> buffers;
+  buffers.push_back({ const_cast<char *>(start_tag.data()), start_tag.size() });
+  for (auto it = chunks.begin(); it != chunks.end(); ++it)
+  {
+    buffers.push_back({ &(*it)[0], it->size() });
+  }
+  buffers.push_back({ const_cast<char *>(end_tag.data()), end_tag.size() });
+
+  const int file_descriptor = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (file_descriptor < 0)
+  {
+    throw tException("Could not write XML document to file `" + file_name + "'!");
+  }
+  try
+  {
+    WriteBuffers(file_descriptor, buffers);
+  }
+  catch (const tException &)
+  {
+    close(file_descriptor);
+    throw tException("Could not write XML document to file `" + file_name + "'!");
+  }
+  if (close(file_descriptor) != 0)
+  {
+    throw tException("Could not write XML document to file `" + file_name + "'!");
+  }
+  *this->saved_generation = this->generation;
+}
+
+//----------------------------------------------------------------------
+// tDocument WriteToFileIfModified
+//----------------------------------------------------------------------
+bool tDocument::WriteToFileIfModified(const std::string &file_name, int compression) const
+{
+  if (!this->IsModified())
+  {
+    return false;
+  }
+  this->WriteToFile(file_name, compression);
+  return true;
+}
+
+//----------------------------------------------------------------------
+// tDocument WriteToFileAsync
+//----------------------------------------------------------------------
+std::future<void> tDocument::WriteToFileAsync(const std::string &file_name, int compression) const
+{
+  std::shared_ptr<xmlDoc> snapshot(xmlCopyDoc(this->document, 1), xmlFreeDoc);
+  if (!snapshot)
+  {
+    throw tException("Could not copy XML document for writing!");
+  }
+  if (compression)
+  {
+    xmlSetDocCompressMode(snapshot.get(), compression);
+  }
+  std::shared_ptr<std::atomic<uint64_t>> saved_generation = this->saved_generation;
+  const uint64_t generation = this->generation;
+  return std::async(std::launch::async, [snapshot, file_name, saved_generation, generation]
+  {
+    SaveDocumentAtomically(snapshot.get(), file_name, 0, 0);
+    RecordSavedGeneration(*saved_generation, generation);
+  });
+}
+
+//----------------------------------------------------------------------
+// tDocument WriteToFile with compression codec
+//----------------------------------------------------------------------
+void tDocument::WriteToFile(const std::string &file_name, const std::string &codec, int level) const
+{
+  SaveDocument(this->document, file_name, GetCompressionCodec(codec).get(), level);
+  *this->saved_generation = this->generation;
+}
+
+std::future<void> tDocument::WriteToFileAsync(const std::string &file_name, const std::string &codec, int level) const
+{
+  std::shared_ptr<const tCompressionCodec> compression_codec = GetCompressionCodec(codec);
+  std::shared_ptr<xmlDoc> snapshot(xmlCopyDoc(this->document, 1), xmlFreeDoc);
+  if (!snapshot)
+  {
+    throw tException("Could not copy XML document for writing!");
+  }
+  std::shared_ptr<std::atomic<uint64_t>> saved_generation = this->saved_generation;
+  const uint64_t generation = this->generation;
+  return std::async(std::launch::async, [snapshot, file_name, compression_codec, level, saved_generation, generation]
+  {
+    SaveDocumentAtomically(snapshot.get(), file_name, compression_codec.get(), level);
+    RecordSavedGeneration(*saved_generation, generation);
+  });
 }
 
 //----------------------------------------------------------------------
@@ -234,6 +1198,108 @@ void tDocument::CheckIfDocumentIsValid(const std::string &exception_message)
   {
     throw tException(exception_message);
   }
+  this->document->_private = this;
+}
+
+//----------------------------------------------------------------------
+// tDocument EnableFingerprintCache
+//----------------------------------------------------------------------
+void tDocument::EnableFingerprintCache()
+{
+  this->fingerprint_cache_enabled = true;
+}
+
+//----------------------------------------------------------------------
+// tDocument DisableFingerprintCache
+//----------------------------------------------------------------------
+void tDocument::DisableFingerprintCache()
+{
+  this->fingerprint_cache_enabled = false;
+  this->fingerprints.clear();
+}
+
+//----------------------------------------------------------------------
+// tDocument MemoryFootprint
+//----------------------------------------------------------------------
+tDocument::tMemoryFootprint tDocument::MemoryFootprint() const
+{
+  tMemoryFootprint footprint;
+  if (this->document)
+  {
+    footprint.nodes += sizeof(xmlDoc);
+    tFootprintWalk walk(this->document, footprint);
+    walk.AddString(this->document->version, footprint.names);
+    walk.AddString(this->document->encoding, footprint.names);
+    walk.AddString(this->document->URL, footprint.names);
+    walk.AddTree(this->document);
+    if (this->document->dict)
+    {
+      footprint.dictionary += xmlDictSize(this->document->dict) * cDICTIONARY_ENTRY_SIZE;
+    }
+  }
+
+  for (auto it = this->attribute_caches.begin(); it != this->attribute_caches.end(); ++it)
+  {
+    footprint.caches += (*it)->MemoryUsage();
+  }
+  footprint.caches += this->fingerprints.size() * (sizeof(*this->fingerprints.begin()) + cHASH_NODE_OVERHEAD) + this->fingerprints.bucket_count() * sizeof(void *);
+  {
+    std::lock_guard<std::mutex> lock(this->child_index_mutex);
+    for (auto it = this->child_indices.begin(); it != this->child_indices.end(); ++it)
+    {
+      footprint.caches += sizeof(*it) + cHASH_NODE_OVERHEAD + it->second.capacity() * sizeof(tNode *);
+    }
+    footprint.caches += this->child_indices.bucket_count() * sizeof(void *);
+  }
+
+  if (this->arena)
+  {
+    footprint.arena = this->arena->ReservedMemory();
+  }
+  return footprint;
+}
+
+//----------------------------------------------------------------------
+// tDocument LiveDocumentFootprints
+//----------------------------------------------------------------------
+std::vector<std::pair<std::string, tDocument::tMemoryFootprint>> tDocument::LiveDocumentFootprints()
+{
+  std::vector<std::pair<std::string, tMemoryFootprint>> footprints;
+  tLiveDocuments &live_documents = LiveDocuments();
+  std::lock_guard<std::mutex> lock(live_documents.mutex);
+  for (auto it = live_documents.documents.begin(); it != live_documents.documents.end(); ++it)
+  {
+    const xmlDoc *document = (*it)->document;
+    const char *url = document && document->URL ? reinterpret_cast<const char *>(document->URL) : "";
+    footprints.emplace_back(url, (*it)->MemoryFootprint());
+  }
+  return footprints;
+}
+
+//----------------------------------------------------------------------
+// tDocument TotalMemoryFootprint
+//----------------------------------------------------------------------
+tDocument::tMemoryFootprint tDocument::TotalMemoryFootprint()
+{
+  tMemoryFootprint total;
+  const std::vector<std::pair<std::string, tMemoryFootprint>> footprints = LiveDocumentFootprints();
+  for (auto it = footprints.begin(); it != footprints.end(); ++it)
+  {
+    total += it->second;
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------
+// tDocument ClearAttributeCaches
+//----------------------------------------------------------------------
+void tDocument::ClearAttributeCaches()
+{
+  for (auto it = this->attribute_caches.begin(); it != this->attribute_caches.end(); ++it)
+  {
+    delete *it;
+  }
+  this->attribute_caches.clear();
 }
 
 //----------------------------------------------------------------------
@@ -43,7 +43,16 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 extern "C"
 {
@@ -53,6 +62,7 @@ extern "C"
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "rrlib/xml/tNode.h"
+#include "rrlib/xml/tFrozenDocument.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -69,6 +79,12 @@ namespace xml
 //----------------------------------------------------------------------
 // Forward declarations / typedefs / enums
 //----------------------------------------------------------------------
+namespace internal
+{
+class tArena;
+class tAttributeCache;
+class tInPlaceParser;
+}
 
 //----------------------------------------------------------------------
 // Class declaration
@@ -80,21 +96,76 @@ namespace xml
  *  the DOM tree through instances of tNode, featuring lazy evaluation.
  *  That means wrapping instances are not created before they are used.
  *
+ *  Files and memory buffers compressed with one of the registered
+ *  compression codecs (see tCompressionCodec) are decompressed
+ *  transparently while parsing.
+ *
+ *  Documents created with cARENA_ALLOCATION take all memory for their
+ *  DOM tree from an arena. Destroying such a document releases a few
+ *  large blocks instead of freeing every node, attribute and string.
+ *  Memory of removed or replaced nodes is only reclaimed when the
+ *  document is destroyed, so arena allocation suits documents that are
+ *  built or loaded once and then mostly read. It replaces libxml2's
+ *  allocation hooks (see xmlMemSetup) when the first arena document is
+ *  created. Previously installed hooks are still used for all other
+ *  allocations, but hooks must not be changed afterwards.
+ *
  */
 class tDocument
 {
+  friend class tNode;
 
 //----------------------------------------------------------------------
 // Public methods and typedefs
 //----------------------------------------------------------------------
 public:
 
+  //! Tag type selecting the constructors for documents with arena allocation
+  struct tArenaAllocation
+  {};
+
+  /*! Selects arena allocation in the constructors of tDocument */
+  static const tArenaAllocation cARENA_ALLOCATION;
+
+  //! Memory used by a document in bytes
+  /*! The sizes are computed from the structures and strings of the DOM
+   *  tree, so the overhead of the memory allocator is not included.
+   */
+  struct tMemoryFootprint
+  {
+    size_t nodes;        //!< Element, text, comment and other node structures
+    size_t attributes;   //!< Attribute structures including the nodes that hold their values
+    size_t text;         //!< Text content and attribute values
+    size_t names;        //!< Names and namespace declarations not stored in the dictionary
+    size_t dictionary;   //!< Dictionary strings used by the document and the dictionary entries
+    size_t caches;       //!< Attribute caches, fingerprints and child indices
+    size_t arena;        //!< Memory reserved by the arena of the document (zero without arena)
+
+    tMemoryFootprint();
+
+    /*! Get the memory used by the document
+     *
+     * For documents with arena allocation, this is the memory reserved
+     * by the arena (which includes nodes, strings and the dictionary)
+     * plus the caches.
+     */
+    size_t Total() const;
+
+    tMemoryFootprint &operator += (const tMemoryFootprint &other);
+  };
+
   /*! The ctor of an empty tDocument
    *
    * This ctor creates a new xml document
    */
   tDocument();
 
+  /*! The ctor of an empty tDocument with arena allocation
+   *
+   * \exception tException is thrown if the address space for arenas cannot be reserved
+   */
+  explicit tDocument(tArenaAllocation);
+
   /*! The ctor of tDocument from a given file
    *
    * This ctor reads and parses a file with given name into a XML DOM
@@ -155,6 +226,25 @@ public:
    */
   tDocument(const void *buffer, size_t size, const std::string &encoding, bool validate = true);
 
+  /*! The ctor of tDocument from a given file with arena allocation
+   *
+   * \exception tException is thrown if the file was not found or could not be parsed
+   *
+   * \param file_name   The name of the file to load
+   * \param validate    Whether the validation should be processed or not
+   */
+  tDocument(tArenaAllocation, const std::string &file_name, bool validate = true);
+
+  /*! The ctor of tDocument from a memory buffer with arena allocation
+   *
+   * \exception tException is thrown if the memory buffer could not be parsed
+   *
+   * \param buffer      Pointer to the memory buffer with XML content to be parsed
+   * \param size        Size of the memory buffer
+   * \param validate    Whether the validation should be processed or not
+   */
+  tDocument(tArenaAllocation, const void *buffer, size_t size, bool validate = true);
+
   /*!
    * move constructor
    */
@@ -168,6 +258,82 @@ public:
    */
   tDocument& operator=(const tDocument& other);
 
+  /*! Get an immutable snapshot of this document
+   *
+   * The snapshot is a copy of the document that can be shared with and
+   * read by any number of threads, while this document is modified
+   * further. It is copied on the first call after a modification (see
+   * Generation) and shared by all calls until the next modification,
+   * so publishing one state to many readers costs a single copy. The
+   * document keeps its latest snapshot until the next one is taken.
+   *
+   * Like all other methods, this one must not be called concurrently
+   * with modifications of this document.
+   *
+   * \note Nodes modified directly via libxml2 are not noticed and can result in an outdated snapshot
+   *
+   * \returns The snapshot of the current state of this document
+   */
+  std::shared_ptr<const tDocument> Snapshot() const;
+
+  /*! Get a compact read-only copy of this document
+   *
+   * The elements are copied into a flat representation that is faster
+   * to traverse and search than the DOM tree (see tFrozenDocument).
+   * It is independent of this document, which can be modified or
+   * destroyed afterwards.
+   *
+   * \exception tException is thrown if this document has no root node
+   *
+   * \returns The frozen copy of this document
+   */
+  tFrozenDocument Freeze() const;
+
+  /*! Rebuild the DOM tree of this document in contiguous memory
+   *
+   * Documents built or edited over time have their nodes scattered
+   * over the heap, so traversing them is dominated by cache misses.
+   * This method copies the tree into a new arena in depth-first order,
+   * where every node is followed by its name, attributes and children,
+   * and releases the previous tree. Afterwards, the document uses arena
+   * allocation (see UsesArena) with all its consequences. The content
+   * and Generation of the document do not change.
+   *
+   * \note All references to nodes of this document (tNode &) become invalid
+   *
+   * \exception tException is thrown if the tree cannot be copied (the document is left unchanged)
+   */
+  void Compact();
+
+  /*! Replace the content of this document by an XML message from a memory buffer
+   *
+   * Applications receiving a stream of messages with the same structure
+   * (e.g. periodic state updates) mostly parse the same elements and
+   * attributes over and over. If the message has the same shape as this
+   * document, that is the same elements, attributes and text nodes in
+   * the same order, only the values that changed are written into the
+   * existing nodes: no tree is built and references to nodes of this
+   * document remain valid. Otherwise, the message is parsed like by the
+   * constructor and replaces the DOM tree, which invalidates all
+   * references to its nodes.
+   *
+   * Messages containing comments, processing instructions, CDATA
+   * sections, a document type declaration or entity references as well
+   * as compressed messages are always parsed completely.
+   *
+   * Generation is only advanced if the content changed. Arena documents
+   * remain arena documents.
+   *
+   * \exception tException is thrown if the message cannot be parsed (the document is left unchanged)
+   *
+   * \param buffer     Memory buffer with the message
+   * \param size       The size of \a buffer
+   * \param validate   Whether the validation should be processed or not (only applies to messages that are parsed completely)
+   *
+   * \returns Whether the values were updated in place
+   */
+  bool Reparse(const void *buffer, size_t size, bool validate = true);
+
   /*! Get the root node of the DOM tree stored for this document
    *
    * The XML document is stored as DOM tree in memory. This method
@@ -218,23 +384,216 @@ public:
    * This method creates or truncates a file with the given name and writes
    * the documents XML representation into it.
    *
+   * \exception tException is thrown if the file could not be written
+   *
    * \param file_name     The name of the file to use
    * \param compression   Compression level [0-9] where 0 is "no compression"
    */
   void WriteToFile(const std::string &file_name, int compression = 0) const;
 
+  /*! Write the XML document to a file using several threads
+   *
+   * The children of the root node are split into chunks that worker
+   * threads serialize into separate buffers. The buffers are written in
+   * order with vectored I/O, so the file is byte-identical to the output
+   * of WriteToFile. With a single thread and for documents with other
+   * nodes than the root element on top level (e.g. a document type
+   * declaration or comments), the file is written by WriteToFile.
+   *
+   * \exception tException is thrown if the file could not be written
+   *
+   * \param file_name   The name of the file to use
+   * \param threads     The number of threads to use (0 selects the number of hardware threads)
+   */
+  void WriteToFileParallel(const std::string &file_name, unsigned int threads = 0) const;
+
+  /*! Write the XML document to a file if it was modified
+   *
+   * Periodic persistence can call this method in every cycle: the file
+   * is only written if the document was modified since it was created
+   * or last written to a file.
+   *
+   * \exception tException is thrown if the file could not be written
+   *
+   * \param file_name     The name of the file to use
+   * \param compression   Compression level [0-9] where 0 is "no compression"
+   *
+   * \returns Whether the file was written
+   */
+  bool WriteToFileIfModified(const std::string &file_name, int compression = 0) const;
+
+  /*! Write the XML document to a file in the background
+   *
+   * This method copies the document and returns immediately. A worker
+   * thread serializes the copy into a temporary file in the directory
+   * of \a file_name, flushes it to disk and renames it to \a file_name,
+   * so after a crash either the old or the new file is found. The
+   * document can be modified while it is written. Once the file is in
+   * place, the copied state counts as saved for IsModified.
+   *
+   * \note Like every future from std::async, the returned one waits for the write to finish when destroyed
+   *
+   * \param file_name     The name of the file to use
+   * \param compression   Compression level [0-9] where 0 is "no compression"
+   *
+   * \returns A future that becomes ready when the file is in place and rethrows a tException on failure
+   */
+  std::future<void> WriteToFileAsync(const std::string &file_name, int compression = 0) const;
+
+  /*! Write the XML document to a file using a compression codec
+   *
+   * \exception tException is thrown if the codec is not available or the file could not be written
+   *
+   * \param file_name   The name of the file to use
+   * \param codec       The name of a registered compression codec (e.g. "zstd" or "lz4")
+   * \param level       The codec specific compression level (0 selects the codec's default)
+   */
+  void WriteToFile(const std::string &file_name, const std::string &codec, int level = 0) const;
+
+  /*! Write the XML document to a file using a compression codec in the background
+   *
+   * Works like WriteToFileAsync without codec.
+   *
+   * \exception tException is thrown if the codec is not available
+   *
+   * \param file_name   The name of the file to use
+   * \param codec       The name of a registered compression codec (e.g. "zstd" or "lz4")
+   * \param level       The codec specific compression level (0 selects the codec's default)
+   *
+   * \returns A future that becomes ready when the file is in place and rethrows a tException on failure
+   */
+  std::future<void> WriteToFileAsync(const std::string &file_name, const std::string &codec, int level = 0) const;
+
+  /*! Check if the memory of this document is taken from an arena
+   */
+  inline bool UsesArena() const
+  {
+    return this->arena != nullptr;
+  }
+
+  /*! Get the modification counter of this document
+   *
+   * The counter is incremented by every modification through tNode
+   * (adding or removing nodes, setting content or attributes) and by
+   * AddRootNode.
+   *
+   * \note Nodes modified directly via libxml2 are not noticed
+   *
+   * \returns The number of modifications since this document was created
+   */
+  inline uint64_t Generation() const
+  {
+    return this->generation;
+  }
+
+  /*! Check if the document was modified since it was created or last written to a file
+   *
+   * Writing in the background via WriteToFileAsync resets this flag
+   * when the file is in place, unless the document was modified after
+   * the write was started.
+   *
+   * \returns Whether the document has unsaved modifications
+   */
+  inline bool IsModified() const
+  {
+    return this->generation != *this->saved_generation;
+  }
+
+  /*! Get the memory used by this document
+   *
+   * Walks the DOM tree, so it takes time proportional to its size.
+   *
+   * \returns The memory footprint broken down by kind of data
+   */
+  tMemoryFootprint MemoryFootprint() const;
+
+  /*! Get the memory used by each document of this process
+   *
+   * \note This must not be called while other threads create, modify or destroy documents
+   *
+   * \returns The URL (e.g. the file name) and memory footprint of every existing document
+   */
+  static std::vector<std::pair<std::string, tMemoryFootprint>> LiveDocumentFootprints();
+
+  /*! Get the memory used by all documents of this process
+   *
+   * \note This must not be called while other threads create, modify or destroy documents
+   *
+   * \returns The sum of the memory footprints of all existing documents
+   */
+  static tMemoryFootprint TotalMemoryFootprint();
+
+  /*! Enable memoization of subtree fingerprints
+   *
+   * With this cache, tNode::Fingerprint stores the fingerprints of all
+   * elements it visits. Modifying nodes through tNode drops the entries
+   * of the modified nodes and their ancestors, so repeated calls only
+   * rehash the subtrees that changed. Like reading the document, calling
+   * tNode::Fingerprint and tNode::DeepEquals from several threads is
+   * safe as long as the document is not modified concurrently.
+   *
+   * \note Nodes modified directly via libxml2 are not noticed by the cache
+   */
+  void EnableFingerprintCache();
+
+  /*! Disable memoization of subtree fingerprints and drop all stored fingerprints
+   */
+  void DisableFingerprintCache();
+
+  /*! Check if subtree fingerprints are memoized for this document
+   *
+   * \returns Whether the fingerprint cache is enabled
+   */
+  inline bool HasFingerprintCache() const
+  {
+    return this->fingerprint_cache_enabled;
+  }
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
 private:
 
+  std::unique_ptr<internal::tArena> arena;
   xmlDocPtr document;
   mutable tNode *root_node;
 
+  std::unordered_set<internal::tAttributeCache *> attribute_caches;
+
+  bool fingerprint_cache_enabled;
+  // Fingerprints are memoized by const methods, so readers of const documents share them under the mutex
+  mutable std::mutex fingerprint_mutex;
+  std::unordered_map<const xmlNode *, uint64_t> fingerprints;
+
+  // Child indices are built by const methods, so readers of const documents share them under the mutex
+  mutable std::mutex child_index_mutex;
+  mutable std::unordered_map<const xmlNode *, std::vector<tNode *>> child_indices;
+
+  uint64_t generation;
+  // Shared with the workers of WriteToFileAsync, which record the generation of their copy once it is in place
+  std::shared_ptr<std::atomic<uint64_t>> saved_generation;
+
+  mutable std::shared_ptr<const tDocument> snapshot;
+  mutable uint64_t snapshot_generation;
+
+  std::unique_ptr<internal::tInPlaceParser> in_place_parser;
+
+  // Registers the document for LiveDocumentFootprints, also if a constructor throws (declared last, so it is unregistered first)
+  class tLiveDocument : public util::tNoncopyable
+  {
+    const tDocument *document;
+  public:
+    explicit tLiveDocument(const tDocument *document);
+    ~tLiveDocument();
+  };
+  tLiveDocument live_document{this};
+
   tDocument(const tDocument&); // generated copy-constructor is not safe
 
   void CheckIfDocumentIsValid(const std::string &exception_message);
 
+  void ClearAttributeCaches();
+
 };
 
 //----------------------------------------------------------------------
@@ -0,0 +1,274 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tEnumNameTable.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tEnumNameTable
+ *
+ * \b tEnumNameTable
+ *
+ * A table of enum names with a perfect hash function that is generated
+ * at compile time. Looking up a string costs one hash computation and
+ * one string comparison, independent of the number of names.
+ *
+ * \code
+ * constexpr auto cMODE_NAMES = CreateEnumNameTable("auto", "manual", "off");
+ * tMode mode = static_cast<tMode>(node.GetEnumAttribute("mode", cMODE_NAMES));
+ * \endcode
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tEnumNameTable_h__
+#define __rrlib__xml__tEnumNameTable_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+namespace internal
+{
+
+template <size_t ... INDICES>
+struct tIndexSequence
+{};
+
+template <typename TFirst, typename TSecond>
+struct tConcatIndexSequences;
+
+template <size_t ... FIRST, size_t ... SECOND>
+struct tConcatIndexSequences<tIndexSequence<FIRST...>, tIndexSequence<SECOND...>>
+{
+  typedef tIndexSequence < FIRST..., (sizeof...(FIRST) + SECOND)... > type;
+};
+
+//! Creates tIndexSequence<0, ..., N - 1> with logarithmic instantiation depth
+template <size_t N>
+struct tMakeIndexSequence
+{
+  typedef typename tConcatIndexSequences < typename tMakeIndexSequence < N / 2 >::type, typename tMakeIndexSequence < N - N / 2 >::type >::type type;
+};
+
+template <>
+struct tMakeIndexSequence<0>
+{
+  typedef tIndexSequence<> type;
+};
+
+template <>
+struct tMakeIndexSequence<1>
+{
+  typedef tIndexSequence<0> type;
+};
+
+constexpr size_t NextPowerOfTwo(size_t value, size_t result = 1)
+{
+  return result >= value ? result : NextPowerOfTwo(value, result * 2);
+}
+
+constexpr uint32_t FinalizeEnumNameHash(uint32_t hash)
+{
+  return (hash ^ (hash >> 13)) * 0x5bd1e995u;
+}
+
+//! FNV-1a with seed and finalization (compile time variant)
+constexpr uint32_t EnumNameHash(const char *text, uint32_t hash)
+{
+  return *text ? EnumNameHash(text + 1, (hash ^ static_cast<uint8_t>(*text)) * 16777619u) : FinalizeEnumNameHash(hash);
+}
+
+constexpr uint32_t EnumNameHashSeed(uint32_t seed)
+{
+  return 2166136261u ^ (seed * 0x9e3779b9u);
+}
+
+//! FNV-1a with seed and finalization (runtime variant, must match EnumNameHash)
+inline uint32_t RuntimeEnumNameHash(const char *text, uint32_t hash)
+{
+  for (; *text; ++text)
+  {
+    hash = (hash ^ static_cast<uint8_t>(*text)) * 16777619u;
+  }
+  return FinalizeEnumNameHash(hash);
+}
+
+constexpr bool SlotIsUnused(uint32_t, uint32_t, uint32_t)
+{
+  return true;
+}
+
+template <typename ... TNames>
+constexpr bool SlotIsUnused(uint32_t slot, uint32_t seed, uint32_t mask, const char *name, TNames ... names)
+{
+  return (EnumNameHash(name, EnumNameHashSeed(seed)) & mask) != slot && SlotIsUnused(slot, seed, mask, names...);
+}
+
+constexpr bool SlotsAreDistinct(uint32_t, uint32_t)
+{
+  return true;
+}
+
+template <typename ... TNames>
+constexpr bool SlotsAreDistinct(uint32_t seed, uint32_t mask, const char *name, TNames ... names)
+{
+  return SlotIsUnused(EnumNameHash(name, EnumNameHashSeed(seed)) & mask, seed, mask, names...) && SlotsAreDistinct(seed, mask, names...);
+}
+
+template <typename ... TNames>
+constexpr uint32_t FindPerfectHashSeed(uint32_t seed, uint32_t mask, TNames ... names)
+{
+  return SlotsAreDistinct(seed, mask, names...) ? seed : FindPerfectHashSeed(seed + 1, mask, names...);
+}
+
+constexpr size_t NameIndexForSlot(uint32_t, uint32_t, uint32_t, size_t index)
+{
+  return index;
+}
+
+template <typename ... TNames>
+constexpr size_t NameIndexForSlot(uint32_t slot, uint32_t seed, uint32_t mask, size_t index, const char *name, TNames ... names)
+{
+  return (EnumNameHash(name, EnumNameHashSeed(seed)) & mask) == slot ? index : NameIndexForSlot(slot, seed, mask, index + 1, names...);
+}
+
+}
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Enum names with a perfect hash function generated at compile time
+/*! Instances are created using CreateEnumNameTable. The hash table has
+ *  at least N^2 slots, which keeps the expected number of seeds tried
+ *  at compile time below two. Name tables with more than a few dozen
+ *  entries therefore cost noticeable compile time and memory.
+ *
+ */
+template <size_t N>
+class tEnumNameTable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  static constexpr size_t cSLOTS = internal::NextPowerOfTwo(N * N < 4 ? 4 : N * N);
+
+  template <size_t ... SLOTS, typename ... TNames>
+  constexpr tEnumNameTable(internal::tIndexSequence<SLOTS...>, uint32_t perfect_hash_seed, TNames ... name_list)
+    : names{ name_list... },
+      seed(internal::EnumNameHashSeed(perfect_hash_seed)),
+      slots{ static_cast<uint16_t>(internal::NameIndexForSlot(SLOTS, perfect_hash_seed, cSLOTS - 1, 0, name_list...))... }
+  {}
+
+  /*! Get the number of names in this table
+   */
+  constexpr size_t Size() const
+  {
+    return N;
+  }
+
+  /*! Get the name with the given index
+   */
+  constexpr const char *Name(size_t index) const
+  {
+    return this->names[index];
+  }
+
+  /*! Find the index of a name
+   *
+   * \param name   The zero-terminated name to look up
+   *
+   * \returns The index of \a name or Size() if it is not part of this table
+   */
+  inline size_t Find(const char *name) const
+  {
+    const size_t index = this->slots[internal::RuntimeEnumNameHash(name, this->seed) & (cSLOTS - 1)];
+    return index < N && std::strcmp(this->names[index], name) == 0 ? index : N;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  static_assert(N > 0 && N < 0xFFFF, "Unsupported number of enum names");
+
+  const char *names[N];
+  uint32_t seed;
+  uint16_t slots[cSLOTS];
+
+};
+
+template <size_t N>
+constexpr size_t tEnumNameTable<N>::cSLOTS;
+
+//----------------------------------------------------------------------
+// Function declaration
+//----------------------------------------------------------------------
+
+/*! Create a table of enum names with compile-time perfect hashing
+ *
+ * The index of each name in the argument list is its enum value.
+ * All names must be distinct.
+ *
+ * \param names   The enum names (string literals)
+ */
+template <typename ... TNames>
+constexpr tEnumNameTable<sizeof...(TNames)> CreateEnumNameTable(TNames ... names)
+{
+  return tEnumNameTable<sizeof...(TNames)>(typename internal::tMakeIndexSequence<tEnumNameTable<sizeof...(TNames)>::cSLOTS>::type(),
+         internal::FindPerfectHashSeed(0, tEnumNameTable<sizeof...(TNames)>::cSLOTS - 1, static_cast<const char *>(names)...),
+         static_cast<const char *>(names)...);
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+#endif
@@ -0,0 +1,505 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tEventEmitter.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/tEventEmitter.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tException.h"
+#include "rrlib/xml/escape.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+namespace
+{
+
+const char cXML_DECLARATION[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+const char cDROP_MARKER_START[] = "  <dropped count=\"";
+const char cDROP_MARKER_END[] = "\"/>\n";
+const size_t cMAX_DROP_MARKER_LENGTH = sizeof(cDROP_MARKER_START) + sizeof(cDROP_MARKER_END) + 20;
+
+// The background thread polls the ring buffer, so the producer never needs to wake it up
+const std::chrono::milliseconds cDRAIN_INTERVAL(5);
+
+}
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+void WriteToFileDescriptor(int file_descriptor, const char *data, size_t size)
+{
+  while (size > 0)
+  {
+    const ssize_t result = write(file_descriptor, data, size);
+    if (result < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw tException("Could not write XML output!");
+    }
+    data += result;
+    size -= result;
+  }
+}
+
+size_t NextPowerOfTwo(size_t value)
+{
+  size_t result = 1;
+  while (result < value)
+  {
+    result *= 2;
+  }
+  return result;
+}
+
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter constructors
+//----------------------------------------------------------------------
+tEventEmitter::tEventEmitter(const std::string &file_name, const std::string &root_name, size_t buffer_size, size_t max_record_size)
+  : file_descriptor(open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666))
+{
+  if (this->file_descriptor < 0)
+  {
+    throw tException("Could not open file `" + file_name + "' for writing!");
+  }
+  const int file_descriptor = this->file_descriptor;
+  this->sink = [file_descriptor](const char *data, size_t size)
+  {
+    WriteToFileDescriptor(file_descriptor, data, size);
+  };
+  try
+  {
+    this->Initialize(root_name, buffer_size, max_record_size);
+  }
+  catch (...)
+  {
+    close(this->file_descriptor);
+    throw;
+  }
+}
+
+tEventEmitter::tEventEmitter(int file_descriptor, const std::string &root_name, size_t buffer_size, size_t max_record_size)
+  : file_descriptor(-1)
+{
+  this->sink = [file_descriptor](const char *data, size_t size)
+  {
+    WriteToFileDescriptor(file_descriptor, data, size);
+  };
+  this->Initialize(root_name, buffer_size, max_record_size);
+}
+
+tEventEmitter::tEventEmitter(const std::function<void(const char *data, size_t size)> &sink, const std::string &root_name, size_t buffer_size, size_t max_record_size)
+  : sink(sink),
+    file_descriptor(-1)
+{
+  this->Initialize(root_name, buffer_size, max_record_size);
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter destructor
+//----------------------------------------------------------------------
+tEventEmitter::~tEventEmitter()
+{
+  try
+  {
+    this->Close();
+  }
+  catch (...)
+  {}
+  if (this->file_descriptor >= 0)
+  {
+    close(this->file_descriptor);
+  }
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter Initialize
+//----------------------------------------------------------------------
+void tEventEmitter::Initialize(const std::string &root_name, size_t buffer_size, size_t max_record_size)
+{
+  if (max_record_size == 0)
+  {
+    throw tException("The maximum record size must not be zero!");
+  }
+  this->closed = false;
+  this->end_tag = "</" + root_name + ">\n";
+
+  // The ring buffer always has room for a drop marker and a record of maximum size
+  this->ring.resize(NextPowerOfTwo(std::max(buffer_size, max_record_size + cMAX_DROP_MARKER_LENGTH)));
+  this->write_position.store(0, std::memory_order_relaxed);
+  this->read_position.store(0, std::memory_order_relaxed);
+
+  this->record.resize(max_record_size);
+  this->record_fill = 0;
+  this->record_overflow = false;
+  this->depth = 0;
+
+  this->dropped_records.store(0, std::memory_order_relaxed);
+  this->unreported_drops = 0;
+  this->stop.store(false, std::memory_order_relaxed);
+
+  const std::string start = std::string(cXML_DECLARATION) + "<" + root_name + ">\n";
+  this->sink(start.data(), start.size());
+
+  this->drain_thread = std::thread(&tEventEmitter::Drain, this);
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter StartElement
+//----------------------------------------------------------------------
+void tEventEmitter::StartElement(const char *name)
+{
+  if (this->closed)
+  {
+    throw tException("Cannot add element to a closed event emitter!");
+  }
+  if (this->depth == 0)
+  {
+    this->record_fill = 0;
+    this->record_overflow = false;
+    this->Append("  ", 2);
+  }
+  else
+  {
+    this->CloseStartTag();
+  }
+  const size_t length = std::char_traits<char>::length(name);
+  if (this->depth < cMAX_DEPTH)
+  {
+    tElement &element = this->elements[this->depth];
+    element.name_offset = this->record_fill + 1;
+    element.name_length = length;
+    element.start_tag_open = true;
+  }
+  else
+  {
+    this->record_overflow = true;
+  }
+  this->depth++;
+  this->Append("<", 1);
+  this->Append(name, length);
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter WriteAttribute
+//----------------------------------------------------------------------
+void tEventEmitter::WriteAttribute(const char *name, const char *value, size_t length, bool escape)
+{
+  if (this->depth == 0)
+  {
+    throw tException("Cannot add attribute `" + std::string(name) + "' without an element!");
+  }
+  if (this->depth > cMAX_DEPTH)
+  {
+    return;
+  }
+  if (!this->elements[this->depth - 1].start_tag_open)
+  {
+    throw tException("Cannot add attribute `" + std::string(name) + "' after content!");
+  }
+  this->Append(" ", 1);
+  this->Append(name, std::char_traits<char>::length(name));
+  this->Append("=\"", 2);
+  if (escape)
+  {
+    this->AppendEscaped(value, length, true);
+  }
+  else
+  {
+    this->Append(value, length);
+  }
+  this->Append("\"", 1);
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter Text
+//----------------------------------------------------------------------
+void tEventEmitter::Text(const char *text)
+{
+  if (this->depth == 0)
+  {
+    throw tException("Cannot add text without an element!");
+  }
+  this->CloseStartTag();
+  this->AppendEscaped(text, std::char_traits<char>::length(text), false);
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter EndElement
+//----------------------------------------------------------------------
+bool tEventEmitter::EndElement()
+{
+  if (this->depth == 0)
+  {
+    throw tException("No open element to end!");
+  }
+  this->depth--;
+  if (this->depth < cMAX_DEPTH && !this->record_overflow)
+  {
+    const tElement &element = this->elements[this->depth];
+    if (element.start_tag_open)
+    {
+      this->Append("/>", 2);
+    }
+    else
+    {
+      this->Append("</", 2);
+      // The name is copied from the start tag, which precedes the end of the record
+      this->Append(this->record.data() + element.name_offset, element.name_length);
+      this->Append(">", 1);
+    }
+  }
+  if (this->depth > 0)
+  {
+    return true;
+  }
+  this->Append("\n", 1);
+  return this->CommitRecord();
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter Close
+//----------------------------------------------------------------------
+void tEventEmitter::Close()
+{
+  if (this->closed)
+  {
+    return;
+  }
+  this->closed = true;
+  this->depth = 0;
+  this->stop.store(true, std::memory_order_release);
+  this->drain_thread.join();
+
+  std::exception_ptr error = this->drain_error;
+  if (!error)
+  {
+    try
+    {
+      if (this->unreported_drops)
+      {
+        char marker[cMAX_DROP_MARKER_LENGTH];
+        this->sink(marker, this->FormatDropMarker(marker, sizeof(marker)));
+      }
+      this->sink(this->end_tag.data(), this->end_tag.size());
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+  }
+  if (this->file_descriptor >= 0)
+  {
+    const int file_descriptor = this->file_descriptor;
+    this->file_descriptor = -1;
+    if (close(file_descriptor) != 0 && !error)
+    {
+      throw tException("Could not write XML output!");
+    }
+  }
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter CloseStartTag
+//----------------------------------------------------------------------
+void tEventEmitter::CloseStartTag()
+{
+  if (this->depth > cMAX_DEPTH)
+  {
+    return;
+  }
+  tElement &element = this->elements[this->depth - 1];
+  if (element.start_tag_open)
+  {
+    element.start_tag_open = false;
+    this->Append(">", 1);
+  }
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter AppendEscaped
+//----------------------------------------------------------------------
+void tEventEmitter::AppendEscaped(const char *text, size_t length, bool attribute)
+{
+  while (length > 0 && !this->record_overflow)
+  {
+    const size_t piece_size = std::min(length, (this->record.size() - this->record_fill) / internal::cMAX_ESCAPED_CHARACTER_LENGTH);
+    if (piece_size == 0)
+    {
+      // Close to the end of the record buffer, characters are escaped one at a time
+      char escaped[internal::cMAX_ESCAPED_CHARACTER_LENGTH];
+      this->Append(escaped, internal::EscapeText(text, 1, attribute, escaped));
+      text++;
+      length--;
+      continue;
+    }
+    this->record_fill += internal::EscapeText(text, piece_size, attribute, this->record.data() + this->record_fill);
+    text += piece_size;
+    length -= piece_size;
+  }
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter FormatDropMarker
+//----------------------------------------------------------------------
+size_t tEventEmitter::FormatDropMarker(char *buffer, size_t size) const
+{
+  assert(size >= cMAX_DROP_MARKER_LENGTH);
+  size_t length = sizeof(cDROP_MARKER_START) - 1;
+  std::char_traits<char>::copy(buffer, cDROP_MARKER_START, length);
+  length += internal::FormatNumber(buffer + length, size - length, this->unreported_drops);
+  std::char_traits<char>::copy(buffer + length, cDROP_MARKER_END, sizeof(cDROP_MARKER_END) - 1);
+  return length + sizeof(cDROP_MARKER_END) - 1;
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter CommitRecord
+//----------------------------------------------------------------------
+bool tEventEmitter::CommitRecord()
+{
+  const uint64_t write_position = this->write_position.load(std::memory_order_relaxed);
+  const size_t free_space = this->ring.size() - (write_position - this->read_position.load(std::memory_order_acquire));
+
+  // Drops are reported in the stream right where they occurred
+  char marker[cMAX_DROP_MARKER_LENGTH];
+  const size_t marker_size = this->unreported_drops ? this->FormatDropMarker(marker, sizeof(marker)) : 0;
+
+  if (this->record_overflow || marker_size + this->record_fill > free_space)
+  {
+    this->unreported_drops++;
+    this->dropped_records.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  this->PushToRing(write_position, marker, marker_size);
+  this->PushToRing(write_position + marker_size, this->record.data(), this->record_fill);
+  this->write_position.store(write_position + marker_size + this->record_fill, std::memory_order_release);
+  this->unreported_drops = 0;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter PushToRing
+//----------------------------------------------------------------------
+void tEventEmitter::PushToRing(uint64_t position, const char *data, size_t size)
+{
+  const size_t offset = position & (this->ring.size() - 1);
+  const size_t first = std::min(size, this->ring.size() - offset);
+  std::char_traits<char>::copy(this->ring.data() + offset, data, first);
+  std::char_traits<char>::copy(this->ring.data(), data + first, size - first);
+}
+
+//----------------------------------------------------------------------
+// tEventEmitter Drain
+//----------------------------------------------------------------------
+void tEventEmitter::Drain()
+{
+  try
+  {
+    uint64_t read_position = this->read_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+      // Checking stop first guarantees that all records committed before Close are written
+      const bool stopping = this->stop.load(std::memory_order_acquire);
+      const uint64_t write_position = this->write_position.load(std::memory_order_acquire);
+      if (write_position == read_position)
+      {
+        if (stopping)
+        {
+          return;
+        }
+        std::this_thread::sleep_for(cDRAIN_INTERVAL);
+        continue;
+      }
+      const size_t offset = read_position & (this->ring.size() - 1);
+      const size_t size = write_position - read_position;
+      const size_t first = std::min(size, this->ring.size() - offset);
+      this->sink(this->ring.data() + offset, first);
+      if (size > first)
+      {
+        this->sink(this->ring.data(), size - first);
+      }
+      read_position = write_position;
+      this->read_position.store(read_position, std::memory_order_release);
+    }
+  }
+  catch (...)
+  {
+    this->drain_error = std::current_exception();
+  }
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
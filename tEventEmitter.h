@@ -0,0 +1,315 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tEventEmitter.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tEventEmitter
+ *
+ * \b tEventEmitter
+ *
+ * A real-time safe emitter for XML records, e.g. telemetry from a
+ * control loop. Each top-level element written to the emitter is a
+ * record that is formatted into preallocated memory and passed to a
+ * background thread through a lock-free ring buffer. The background
+ * thread writes the records as children of a root element to a file,
+ * a file descriptor (e.g. a socket) or a callback. After construction,
+ * emitting records neither allocates memory nor blocks. Records that
+ * do not fit into the ring buffer are dropped and reported.
+ *
+ * \code
+ * tEventEmitter emitter("telemetry.xml", "telemetry");
+ * // in the control loop
+ * emitter.StartElement("cycle");
+ * emitter.Attribute("time", time);
+ * emitter.Attribute("error", error);
+ * emitter.EndElement();
+ * \endcode
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tEventEmitter_h__
+#define __rrlib__xml__tEventEmitter_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "rrlib/util/tNoncopyable.h"
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/numeric_arrays.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Real-time safe XML record emitter
+/*! Records are written by a single thread using StartElement,
+ *  Attribute, Text and EndElement. Each record is indented like a
+ *  child of the root element and contains no further line breaks.
+ *  Names are written as passed and are not checked. A record is
+ *  dropped if it exceeds the maximum record size, is nested deeper
+ *  than cMAX_DEPTH or does not fit into the free space of the ring
+ *  buffer. Dropped records are counted and an element
+ *  <dropped count="N"/> is written in their place before the next
+ *  record that is passed on.
+ *
+ *  Usage errors (e.g. an attribute after text) throw tException, which
+ *  does allocate memory.
+ *
+ */
+class tEventEmitter : public util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Default size of the ring buffer */
+  static const size_t cDEFAULT_BUFFER_SIZE = 1 << 20;
+
+  /*! Default maximum size of a formatted record */
+  static const size_t cDEFAULT_MAX_RECORD_SIZE = 4096;
+
+  /*! Maximum nesting depth of elements within a record */
+  static const size_t cMAX_DEPTH = 16;
+
+  /*! Create an emitter for a file
+   *
+   * \exception tException is thrown if the file cannot be opened or the sizes are invalid
+   *
+   * \param file_name         The name of the file to create or truncate
+   * \param root_name         The name of the root element that contains the records
+   * \param buffer_size       The size of the ring buffer (rounded up to a power of two that holds at least one record)
+   * \param max_record_size   The maximum size of a formatted record including indentation and line break
+   */
+  explicit tEventEmitter(const std::string &file_name, const std::string &root_name = "events",
+                         size_t buffer_size = cDEFAULT_BUFFER_SIZE, size_t max_record_size = cDEFAULT_MAX_RECORD_SIZE);
+
+  /*! Create an emitter for a file descriptor
+   *
+   * \param file_descriptor   The file descriptor to write to, e.g. a socket (it is not closed)
+   */
+  explicit tEventEmitter(int file_descriptor, const std::string &root_name = "events",
+                         size_t buffer_size = cDEFAULT_BUFFER_SIZE, size_t max_record_size = cDEFAULT_MAX_RECORD_SIZE);
+
+  /*! Create an emitter for a callback
+   *
+   * \param sink   The function that receives the output in chunks (it is called from the background thread)
+   */
+  explicit tEventEmitter(const std::function<void(const char *data, size_t size)> &sink, const std::string &root_name = "events",
+                         size_t buffer_size = cDEFAULT_BUFFER_SIZE, size_t max_record_size = cDEFAULT_MAX_RECORD_SIZE);
+
+  /*! The dtor of tEventEmitter
+   *
+   * Closes the emitter if Close was not called. Errors are ignored.
+   */
+  ~tEventEmitter();
+
+  /*! Start a new element
+   *
+   * An element started at the top level begins a new record.
+   *
+   * \exception tException is thrown if the emitter was closed
+   *
+   * \param name   The name of the element
+   */
+  void StartElement(const char *name);
+
+  /*! Add an attribute to the element started last
+   *
+   * \exception tException is thrown if no element is open or content was already added to the current element
+   *
+   * \param name    The name of the attribute
+   * \param value   The value of the attribute (it is escaped as necessary)
+   */
+  inline void Attribute(const char *name, const char *value)
+  {
+    this->WriteAttribute(name, value, std::char_traits<char>::length(value), true);
+  }
+
+  inline void Attribute(const char *name, const std::string &value)
+  {
+    this->WriteAttribute(name, value.data(), value.size(), true);
+  }
+
+  inline void Attribute(const char *name, bool value)
+  {
+    this->WriteAttribute(name, value ? "true" : "false", value ? 4 : 5, false);
+  }
+
+  /*! Add a numeric attribute to the element started last
+   *
+   * Numbers are formatted like tWriter::Attribute does.
+   *
+   * \exception tException is thrown if no element is open or content was already added to the current element
+   *
+   * \param name    The name of the attribute
+   * \param value   The value of the attribute
+   */
+  template <typename TNumber>
+  inline typename std::enable_if<std::is_arithmetic<TNumber>::value>::type Attribute(const char *name, TNumber value)
+  {
+    char buffer[internal::cMAX_FORMATTED_NUMBER_LENGTH];
+    this->WriteAttribute(name, buffer, internal::FormatNumber(buffer, sizeof(buffer), value), false);
+  }
+
+  /*! Add text content to the current element
+   *
+   * \exception tException is thrown if no element is open
+   *
+   * \param text   The text (it is escaped as necessary)
+   */
+  void Text(const char *text);
+
+  /*! End the element started last
+   *
+   * Ending a top-level element passes the record to the background
+   * thread.
+   *
+   * \exception tException is thrown if no element is open
+   *
+   * \returns False if this completed a record that was dropped
+   */
+  bool EndElement();
+
+  /*! Get the number of records dropped so far
+   *
+   * May be called from any thread.
+   */
+  inline uint64_t DroppedRecords() const
+  {
+    return this->dropped_records.load(std::memory_order_relaxed);
+  }
+
+  /*! Finish the output
+   *
+   * Discards an incomplete record, stops the background thread after
+   * it has written all pending records and writes the end tag of the
+   * root element. Closes the file if the emitter was created for a
+   * file name.
+   *
+   * \exception tException is thrown if writing the output failed
+   */
+  void Close();
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  struct tElement
+  {
+    size_t name_offset;
+    size_t name_length;
+    bool start_tag_open;
+  };
+
+  std::function<void(const char *, size_t)> sink;
+  int file_descriptor;
+  bool closed;
+  std::string end_tag;
+
+  // Ring buffer shared with the background thread (positions increase monotonically)
+  std::vector<char> ring;
+  std::atomic<uint64_t> write_position;
+  std::atomic<uint64_t> read_position;
+
+  // Record being formatted
+  std::vector<char> record;
+  size_t record_fill;
+  bool record_overflow;
+  tElement elements[cMAX_DEPTH];
+  size_t depth;
+
+  std::atomic<uint64_t> dropped_records;
+  uint64_t unreported_drops;
+
+  std::thread drain_thread;
+  std::atomic<bool> stop;
+  std::exception_ptr drain_error;
+
+  void Initialize(const std::string &root_name, size_t buffer_size, size_t max_record_size);
+
+  void WriteAttribute(const char *name, const char *value, size_t length, bool escape);
+
+  void CloseStartTag();
+
+  inline void Append(const char *data, size_t size)
+  {
+    if (this->record_overflow || this->record.size() - this->record_fill < size)
+    {
+      this->record_overflow = true;
+      return;
+    }
+    std::char_traits<char>::copy(this->record.data() + this->record_fill, data, size);
+    this->record_fill += size;
+  }
+
+  void AppendEscaped(const char *text, size_t length, bool attribute);
+
+  size_t FormatDropMarker(char *buffer, size_t size) const;
+
+  bool CommitRecord();
+
+  void PushToRing(uint64_t position, const char *data, size_t size);
+
+  void Drain();
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+#endif
@@ -0,0 +1,449 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tFrozenDocument.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/tFrozenDocument.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <limits>
+#include <unordered_map>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+// Calls Enter and Leave for every element of a subtree and Text for the text between them in document order
+template <typename TVisitor>
+void VisitSubtree(const xmlNode *root, TVisitor &visitor)
+{
+  const xmlNode *element = root;
+  visitor.Enter(root);
+  const xmlNode *next = root->children;
+  while (true)
+  {
+    if (next)
+    {
+      if (next->type == XML_ELEMENT_NODE)
+      {
+        element = next;
+        visitor.Enter(element);
+        next = element->children;
+        continue;
+      }
+      if (next->type == XML_TEXT_NODE || next->type == XML_CDATA_SECTION_NODE || next->type == XML_ENTITY_REF_NODE)
+      {
+        visitor.Text(next);
+      }
+      next = next->next;
+      continue;
+    }
+    visitor.Leave(element);
+    if (element == root)
+    {
+      return;
+    }
+    next = element->next;
+    element = element->parent;
+  }
+}
+
+// Text and attribute values that are not stored in a single text node are composed like xmlNodeGetContent and xmlGetProp do
+class tValue : public util::tNoncopyable
+{
+  const char *data;
+  xmlChar *composed;
+
+public:
+
+  tValue(const xmlNode *node)
+    : data(reinterpret_cast<const char *>(node->content)),
+      composed(0)
+  {
+    if (node->type == XML_ENTITY_REF_NODE)
+    {
+      this->composed = xmlNodeGetContent(const_cast<xmlNode *>(node));
+      this->data = this->composed ? reinterpret_cast<const char *>(this->composed) : "";
+    }
+  }
+
+  tValue(const xmlAttr *attribute)
+    : data(""),
+      composed(0)
+  {
+    const xmlNode *children = attribute->children;
+    if (children && !children->next && children->type == XML_TEXT_NODE)
+    {
+      this->data = reinterpret_cast<const char *>(children->content);
+    }
+    else if (children)
+    {
+      this->composed = xmlNodeListGetString(attribute->doc, const_cast<xmlNode *>(children), 1);
+      this->data = this->composed ? reinterpret_cast<const char *>(this->composed) : "";
+    }
+  }
+
+  ~tValue()
+  {
+    xmlFree(this->composed);
+  }
+
+  inline const char *Get() const
+  {
+    return this->data ? this->data : "";
+  }
+};
+
+// First pass: counts the entries of all tables and assigns the names their place at the start of the string pool
+struct tSizeVisitor
+{
+  size_t nodes;
+  size_t attributes;
+  size_t texts;
+  size_t name_bytes;
+  size_t value_bytes;
+  std::unordered_map<const xmlChar *, size_t> name_offsets;
+  std::unordered_map<std::string, size_t> distinct_names;
+  std::vector<const xmlChar *> names;
+
+  tSizeVisitor()
+    : nodes(0),
+      attributes(0),
+      texts(0),
+      name_bytes(0),
+      value_bytes(0)
+  {}
+
+  void AddName(const xmlChar *name)
+  {
+    // Names shared through a dictionary are recognized by their address
+    if (this->name_offsets.count(name))
+    {
+      return;
+    }
+    auto inserted = this->distinct_names.insert(std::make_pair(std::string(reinterpret_cast<const char *>(name)), this->name_bytes));
+    if (inserted.second)
+    {
+      this->names.push_back(name);
+      this->name_bytes += inserted.first->first.length() + 1;
+    }
+    this->name_offsets[name] = inserted.first->second;
+  }
+
+  void Enter(const xmlNode *element)
+  {
+    ++this->nodes;
+    this->AddName(element->name);
+    for (const xmlAttr *attribute = element->properties; attribute; attribute = attribute->next)
+    {
+      ++this->attributes;
+      this->AddName(attribute->name);
+      this->value_bytes += std::strlen(tValue(attribute).Get()) + 1;
+    }
+  }
+
+  void Text(const xmlNode *node)
+  {
+    const size_t length = std::strlen(tValue(node).Get());
+    if (length)
+    {
+      ++this->texts;
+      this->value_bytes += length + 1;
+    }
+  }
+
+  void Leave(const xmlNode *element)
+  {}
+};
+
+}
+
+//----------------------------------------------------------------------
+// tFrozenNode Parent
+//----------------------------------------------------------------------
+const tFrozenNode &tFrozenNode::Parent() const
+{
+  if (!this->parent_offset)
+  {
+    throw tException("Node has no parent!");
+  }
+  return *(this - this->parent_offset);
+}
+
+//----------------------------------------------------------------------
+// tFrozenNode ChildAt
+//----------------------------------------------------------------------
+const tFrozenNode &tFrozenNode::ChildAt(size_t index) const
+{
+  if (index >= this->child_count)
+  {
+    throw tException("Child index " + std::to_string(index) + " is out of range!");
+  }
+  return this[this->child_offsets[index]];
+}
+
+//----------------------------------------------------------------------
+// tFrozenNode FirstChild
+//----------------------------------------------------------------------
+const tFrozenNode &tFrozenNode::FirstChild() const
+{
+  if (!this->child_count)
+  {
+    throw tException("Node has no children!");
+  }
+  return this[1];
+}
+
+//----------------------------------------------------------------------
+// tFrozenNode NextSibling
+//----------------------------------------------------------------------
+const tFrozenNode &tFrozenNode::NextSibling() const
+{
+  if (!this->next_sibling_offset)
+  {
+    throw tException("Node has no sibling!");
+  }
+  return this[this->next_sibling_offset];
+}
+
+//----------------------------------------------------------------------
+// tFrozenNode GetTextContent
+//----------------------------------------------------------------------
+const std::string tFrozenNode::GetTextContent() const
+{
+  if (this->text_count == 1)
+  {
+    return std::string(this->texts->data, this->texts->length);
+  }
+  size_t length = 0;
+  for (uint32_t i = 0; i < this->text_count; ++i)
+  {
+    length += this->texts[i].length;
+  }
+  std::string result;
+  result.reserve(length);
+  for (uint32_t i = 0; i < this->text_count; ++i)
+  {
+    result.append(this->texts[i].data, this->texts[i].length);
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------
+// tFrozenNode GetAttribute
+//----------------------------------------------------------------------
+const char *tFrozenNode::GetAttribute(const std::string &name) const
+{
+  const char *value = this->FindAttribute(name.c_str());
+  if (!value)
+  {
+    throw tException("Requested attribute `" + name + "' does not exist in this node!");
+  }
+  return value;
+}
+
+//----------------------------------------------------------------------
+// tFrozenDocument constructors
+//----------------------------------------------------------------------
+tFrozenDocument::tFrozenDocument(const tNode &root_node)
+  : node_count(0)
+{
+  const xmlNode *root = static_cast<const xmlNode *>(&root_node);
+  tSizeVisitor sizes;
+  VisitSubtree(root, sizes);
+  if (sizes.nodes >= std::numeric_limits<uint32_t>::max())
+  {
+    throw tException("Subtree has too many elements to be frozen!");
+  }
+
+  this->nodes.reset(new tFrozenNode[sizes.nodes]);
+  this->node_count = sizes.nodes;
+  this->attributes.resize(sizes.attributes);
+  this->texts.resize(sizes.texts);
+  this->child_offsets.resize(sizes.nodes - 1);
+  this->strings.resize(sizes.name_bytes + sizes.value_bytes);
+  for (auto it = sizes.names.begin(); it != sizes.names.end(); ++it)
+  {
+    std::strcpy(this->strings.data() + sizes.name_offsets[*it], reinterpret_cast<const char *>(*it));
+  }
+
+  // Second pass: fills the tables in depth-first order (a local class has access to the members of tFrozenNode)
+  struct tFillVisitor
+  {
+    struct tOpenElement
+    {
+      size_t index;
+      size_t last_child;
+    };
+
+    tFrozenDocument &document;
+    const std::unordered_map<const xmlChar *, size_t> &name_offsets;
+    size_t node_fill;
+    size_t attribute_fill;
+    size_t text_fill;
+    size_t child_fill;
+    size_t string_fill;
+    std::vector<tOpenElement> open_elements;
+
+    const char *AddString(const char *text, size_t length)
+    {
+      char *result = this->document.strings.data() + this->string_fill;
+      std::memcpy(result, text, length + 1);
+      this->string_fill += length + 1;
+      return result;
+    }
+
+    const char *Name(const xmlChar *name) const
+    {
+      return this->document.strings.data() + this->name_offsets.find(name)->second;
+    }
+
+    void Enter(const xmlNode *element)
+    {
+      const size_t index = this->node_fill++;
+      tFrozenNode &node = this->document.nodes[index];
+      node.name = this->Name(element->name);
+      node.attributes = this->document.attributes.data() + this->attribute_fill;
+      node.texts = this->document.texts.data() + this->text_fill;
+      node.child_offsets = 0;
+      node.parent_offset = 0;
+      node.next_sibling_offset = 0;
+      node.descendant_count = 0;
+      node.child_count = 0;
+      node.attribute_count = 0;
+      node.text_count = 0;
+      for (const xmlAttr *attribute = element->properties; attribute; attribute = attribute->next)
+      {
+        tFrozenNode::tAttribute &entry = this->document.attributes[this->attribute_fill++];
+        tValue value(attribute);
+        entry.name = this->Name(attribute->name);
+        entry.value = this->AddString(value.Get(), std::strlen(value.Get()));
+        ++node.attribute_count;
+      }
+
+      if (!this->open_elements.empty())
+      {
+        tOpenElement &parent = this->open_elements.back();
+        node.parent_offset = index - parent.index;
+        ++this->document.nodes[parent.index].child_count;
+        if (parent.last_child != parent.index)
+        {
+          this->document.nodes[parent.last_child].next_sibling_offset = index - parent.last_child;
+        }
+        parent.last_child = index;
+      }
+      this->open_elements.push_back({ index, index });
+    }
+
+    void Text(const xmlNode *node)
+    {
+      tValue value(node);
+      const size_t length = std::strlen(value.Get());
+      if (length)
+      {
+        tFrozenNode::tText &entry = this->document.texts[this->text_fill++];
+        entry.data = this->AddString(value.Get(), length);
+        entry.length = length;
+      }
+    }
+
+    void Leave(const xmlNode *element)
+    {
+      const size_t index = this->open_elements.back().index;
+      this->open_elements.pop_back();
+      tFrozenNode &node = this->document.nodes[index];
+      node.descendant_count = this->node_fill - index - 1;
+      node.text_count = this->document.texts.data() + this->text_fill - node.texts;
+      node.child_offsets = this->document.child_offsets.data() + this->child_fill;
+      for (size_t child = index + 1, i = 0; i < node.child_count; child += this->document.nodes[child].next_sibling_offset, ++i)
+      {
+        this->document.child_offsets[this->child_fill++] = child - index;
+      }
+    }
+  } fill = { *this, sizes.name_offsets, 0, 0, 0, 0, sizes.name_bytes, {} };
+  VisitSubtree(root, fill);
+  assert(fill.node_fill == this->node_count && fill.text_fill == this->texts.size() && fill.string_fill == this->strings.size());
+}
+
+tFrozenDocument::tFrozenDocument(tFrozenDocument &&other)
+  : nodes(std::move(other.nodes)),
+    node_count(other.node_count),
+    attributes(std::move(other.attributes)),
+    texts(std::move(other.texts)),
+    child_offsets(std::move(other.child_offsets)),
+    strings(std::move(other.strings))
+{
+  other.node_count = 0;
+}
+
+//----------------------------------------------------------------------
+// tFrozenDocument MemoryUsage
+//----------------------------------------------------------------------
+size_t tFrozenDocument::MemoryUsage() const
+{
+  return sizeof(*this) + this->node_count * sizeof(tFrozenNode) + this->attributes.capacity() * sizeof(tFrozenNode::tAttribute) +
+         this->texts.capacity() * sizeof(tFrozenNode::tText) + this->child_offsets.capacity() * sizeof(uint32_t) + this->strings.capacity();
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
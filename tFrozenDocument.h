@@ -0,0 +1,563 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tFrozenDocument.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tFrozenDocument and tFrozenNode
+ *
+ * \b tFrozenDocument
+ *
+ * A compact, read-only copy of the elements of a DOM tree for documents
+ * that are only read after loading. The elements are stored in one
+ * array in depth-first order, so traversing a subtree reads memory
+ * sequentially. Attributes, text and child positions are kept in
+ * contiguous tables and all strings in one pool. Names are stored once
+ * per document.
+ *
+ * \code
+ * const tFrozenDocument configuration = tDocument("config.xml").Freeze();
+ * for (auto &module : configuration.RootNode().Children())
+ * {
+ *   Load(module.Name(), module.GetDoubleAttribute("rate"));
+ * }
+ * \endcode
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tFrozenDocument_h__
+#define __rrlib__xml__tFrozenDocument_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tNode.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+class tFrozenDocument;
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Element of a tFrozenDocument
+/*! The read methods behave like those of tNode. Only elements are
+ *  stored, so comments and processing instructions are not available.
+ *  Text content includes the text of all descendants, like
+ *  tNode::GetTextContent.
+ *
+ *  Nodes can only be used by reference and are valid as long as their
+ *  document exists.
+ *
+ */
+class tFrozenNode
+{
+  friend class tFrozenDocument;
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  //! Iterator over the children of a node
+  class const_iterator : public std::iterator<std::forward_iterator_tag, const tFrozenNode, size_t>
+  {
+    const tFrozenNode *element;
+
+  public:
+    inline const_iterator() : element(0) {}
+    inline const_iterator(const tFrozenNode *element) : element(element) {}
+
+    inline const tFrozenNode &operator*() const
+    {
+      return *this->element;
+    }
+    inline const tFrozenNode *operator->() const
+    {
+      return this->element;
+    }
+
+    inline const_iterator &operator ++ ()
+    {
+      this->element = this->element->next_sibling_offset ? this->element + this->element->next_sibling_offset : 0;
+      return *this;
+    }
+    inline const_iterator operator ++ (int)
+    {
+      const_iterator temp(*this);
+      operator++();
+      return temp;
+    }
+
+    inline const bool operator == (const const_iterator &other) const
+    {
+      return element == other.element;
+    }
+    inline const bool operator != (const const_iterator &other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  /*! Descendants are stored consecutively, so they are iterated with a pointer */
+  typedef const tFrozenNode *const_descendant_iterator;
+
+  /*! Comparison of nodes (equality) */
+  inline bool operator == (const tFrozenNode &other) const
+  {
+    return this == &other;
+  }
+
+  /*! Comparison of nodes (inequality) */
+  inline bool operator != (const tFrozenNode &other) const
+  {
+    return this != &other;
+  }
+
+  /*! Get the name of this node
+   *
+   * \returns The node's name
+   */
+  inline const std::string Name() const
+  {
+    return this->name;
+  }
+
+  /*! Get access to the parent of this node
+   *
+   * \exception tException is thrown if this node is the root node
+   *
+   * \returns The parent node
+   */
+  const tFrozenNode &Parent() const;
+
+  /*! Get an iterator to the first of this node's children
+   *
+   * \returns A begin-iterator
+   */
+  inline const_iterator ChildrenBegin() const
+  {
+    return const_iterator(this->child_count ? this + 1 : 0);
+  }
+
+  /*! Get an end-iterator to mark the end of children traversal
+   *
+   * \returns An end-iterator
+   */
+  inline const_iterator ChildrenEnd() const
+  {
+    return const_iterator();
+  }
+
+  /*! Get the children of this node for range-based for loops
+   *
+   * \returns The range of children
+   */
+  inline tNode::tRange<const_iterator> Children() const
+  {
+    return tNode::tRange<const_iterator>(this->ChildrenBegin(), this->ChildrenEnd());
+  }
+
+  /*! Get all descendants of this node in depth-first pre-order
+   *
+   * \returns The range of descendants, which does not contain this node
+   */
+  inline tNode::tRange<const_descendant_iterator> Descendants() const
+  {
+    return tNode::tRange<const_descendant_iterator>(this + 1, this + 1 + this->descendant_count);
+  }
+
+  /*! Get whether this node has children
+   *
+   * \returns Whether this node has children or not
+   */
+  inline const bool HasChildren() const
+  {
+    return this->child_count != 0;
+  }
+
+  /*! Get the number of children of this node
+   *
+   * \returns The number of children
+   */
+  inline const size_t GetNumberOfChildren() const
+  {
+    return this->child_count;
+  }
+
+  /*! Get the number of children of this node in constant time
+   *
+   * \returns The number of children
+   */
+  inline size_t ChildCount() const
+  {
+    return this->child_count;
+  }
+
+  /*! Get the child at a given position in constant time
+   *
+   * \exception tException is thrown if \a index is out of range
+   *
+   * \param index   The position of the child
+   *
+   * \returns The child at \a index
+   */
+  const tFrozenNode &ChildAt(size_t index) const;
+
+  /*! Get access to the first child of this node
+   *
+   * \exception tException is thrown if this node has no children
+   *
+   * \returns The first child
+   */
+  const tFrozenNode &FirstChild() const;
+
+  /*! Get whether this node has a next sibling
+   *
+   * \returns Whether this node has a next sibling or not
+   */
+  inline const bool HasNextSibling() const
+  {
+    return this->next_sibling_offset != 0;
+  }
+
+  /*! Get access to the next sibling of this node
+   *
+   * \exception tException is thrown if this node has no next sibling
+   *
+   * \returns The next sibling
+   */
+  const tFrozenNode &NextSibling() const;
+
+  /*! Get the plain text content of this node and its descendants
+   *
+   * \returns The plain text content
+   */
+  const std::string GetTextContent() const;
+
+  /*! Get whether this node has the given attribute
+   *
+   * \param name   The name of the attribute
+   *
+   * \returns Whether this node has the given attribute or not
+   */
+  inline const bool HasAttribute(const std::string &name) const
+  {
+    return this->FindAttribute(name.c_str()) != 0;
+  }
+
+  /*! Get an attribute as std::string
+   *
+   * \exception tException is thrown if the requested attribute is not available
+   *
+   * \param name   The name of the attribute
+   *
+   * \returns The attribute as std::string
+   */
+  inline const std::string GetStringAttribute(const std::string &name) const
+  {
+    return this->GetAttribute(name);
+  }
+
+  /*! Get an attribute as int
+   *
+   * \exception tException is thrown if the requested attribute's value is not available or not a number
+   *
+   * \param name   The name of the attribute
+   * \param base   The base that should be used for number interpretation
+   *
+   * \returns The attribute as int
+   */
+  inline const int GetIntAttribute(const std::string &name, int base = 10) const
+  {
+    return this->GetLongIntAttribute(name, base);
+  }
+
+  /*! Get an attribute as long int (see GetIntAttribute) */
+  inline const long int GetLongIntAttribute(const std::string &name, int base = 10) const
+  {
+    return tFrozenNode::ConvertStringToNumber(this->GetAttribute(name), std::strtol, base);
+  }
+
+  /*! Get an attribute as long long int (see GetIntAttribute) */
+  inline const long long int GetLongLongIntAttribute(const std::string &name, int base = 10) const
+  {
+    return tFrozenNode::ConvertStringToNumber(this->GetAttribute(name), std::strtoll, base);
+  }
+
+  /*! Get an attribute as float
+   *
+   * \exception tException is thrown if the requested attribute's value is not available or not a number
+   *
+   * \param name   The name of the attribute
+   *
+   * \returns The attribute as float
+   */
+  inline const float GetFloatAttribute(const std::string &name) const
+  {
+    return tFrozenNode::ConvertStringToNumber(this->GetAttribute(name), std::strtof);
+  }
+
+  /*! Get an attribute as double (see GetFloatAttribute) */
+  inline const double GetDoubleAttribute(const std::string &name) const
+  {
+    return tFrozenNode::ConvertStringToNumber(this->GetAttribute(name), std::strtod);
+  }
+
+  /*! Get an attribute as long double (see GetFloatAttribute) */
+  inline const long double GetLongDoubleAttribute(const std::string &name) const
+  {
+    return tFrozenNode::ConvertStringToNumber(this->GetAttribute(name), std::strtold);
+  }
+
+  /*! Get an attribute as enum (using a perfect hash table of names)
+   *
+   * \exception tException is thrown if the requested attribute's value is not available or not a member of the given table
+   *
+   * \param name         The name of the attribute
+   * \param enum_names   The table of possible enum strings
+   *
+   * \returns The index of the matching element name as enum value
+   */
+  template <size_t N>
+  inline size_t GetEnumAttribute(const std::string &name, const tEnumNameTable<N> &enum_names) const
+  {
+    const char *value = this->GetAttribute(name);
+    const size_t index = enum_names.Find(value);
+    if (index == N)
+    {
+      throw tException("Invalid value for " + this->Name() + "." + name + ": `" + value + "'");
+    }
+    return index;
+  }
+
+  /*! Get an attribute as bool
+   *
+   * \exception tException is thrown if the requested attribute's value is not available or not true/false
+   *
+   * \param name   The name of the attribute
+   *
+   * \returns Whether the attribute's value was "true" or "false"
+   */
+  inline const bool GetBoolAttribute(const std::string &name) const
+  {
+    return this->GetEnumAttribute(name, internal::cBOOL_NAMES) != 0;
+  }
+
+  /*! Get an attribute as list of numbers stored in a given buffer
+   *
+   * \exception tException is thrown if the requested attribute is not available, an element is not a number or the buffer is too small
+   *
+   * \param name     The name of the attribute
+   * \param values   The buffer to store the numbers in
+   * \param size     The capacity of \a values
+   *
+   * \returns The number of elements stored in \a values
+   */
+  template <typename TNumber>
+  inline size_t GetNumericArrayAttribute(const std::string &name, TNumber *values, size_t size) const
+  {
+    return internal::ParseNumericArray(this->GetAttribute(name), values, size);
+  }
+
+  /*! Get an attribute as list of numbers stored in a given vector
+   *
+   * \exception tException is thrown if the requested attribute is not available or an element is not a number
+   *
+   * \param name     The name of the attribute
+   * \param values   The vector to store the numbers in
+   */
+  template <typename TNumber>
+  inline void GetNumericArrayAttribute(const std::string &name, std::vector<TNumber> &values) const
+  {
+    const char *text = this->GetAttribute(name);
+    values.resize(internal::CountNumericArrayElements(text, std::strlen(text)));
+    values.resize(internal::ParseNumericArray(text, values.data(), values.size()));
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  struct tAttribute
+  {
+    const char *name;
+    const char *value;
+  };
+
+  struct tText
+  {
+    const char *data;
+    size_t length;
+  };
+
+  // Relations are stored as distances within the node array of the document, so nodes need no pointer to it
+  const char *name;
+  const tAttribute *attributes;
+  const tText *texts;
+  const uint32_t *child_offsets;
+  uint32_t parent_offset;
+  uint32_t next_sibling_offset;
+  uint32_t descendant_count;
+  uint32_t child_count;
+  uint32_t attribute_count;
+  uint32_t text_count;
+
+  tFrozenNode() = default;
+
+  inline const char *FindAttribute(const char *name) const
+  {
+    for (const tAttribute *attribute = this->attributes, *end = this->attributes + this->attribute_count; attribute != end; ++attribute)
+    {
+      if (std::strcmp(attribute->name, name) == 0)
+      {
+        return attribute->value;
+      }
+    }
+    return 0;
+  }
+
+  const char *GetAttribute(const std::string &name) const;
+
+  template <typename TNumber>
+  static const TNumber ConvertStringToNumber(const char *value, TNumber(&convert_function)(const char *, char **, int), int base)
+  {
+    errno = 0;
+    char *endptr;
+    TNumber result = convert_function(value, &endptr, base);
+    if (errno || *endptr)
+    {
+      throw tException("Could not convert `" + std::string(value) + "' to number!");
+    }
+    return result;
+  }
+
+  template <typename TNumber>
+  static const TNumber ConvertStringToNumber(const char *value, TNumber(&convert_function)(const char *, char **))
+  {
+    errno = 0;
+    char *endptr;
+    TNumber result = convert_function(value, &endptr);
+    if (errno || *endptr)
+    {
+      throw tException("Could not convert `" + std::string(value) + "' to number!");
+    }
+    return result;
+  }
+
+};
+
+//! Compact read-only copy of a DOM tree
+/*! A frozen document does not change when the tDocument it was created
+ *  from is modified or destroyed. It can be moved, but not copied, and
+ *  can be read by several threads at the same time.
+ *
+ */
+class tFrozenDocument
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Create a frozen copy of a subtree
+   *
+   * \exception tException is thrown if the subtree has more than 2^32 - 1 elements
+   *
+   * \param root_node   The root node of the copy
+   */
+  explicit tFrozenDocument(const tNode &root_node);
+
+  /*! Move constructor */
+  tFrozenDocument(tFrozenDocument &&other);
+
+  /*! Get the root node of this document
+   *
+   * \returns The root node
+   */
+  inline const tFrozenNode &RootNode() const
+  {
+    return this->nodes[0];
+  }
+
+  /*! Get the number of elements in this document */
+  inline size_t NumberOfNodes() const
+  {
+    return this->node_count;
+  }
+
+  /*! Get the memory used by this document in bytes */
+  size_t MemoryUsage() const;
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  std::unique_ptr<tFrozenNode[]> nodes;
+  size_t node_count;
+  std::vector<tFrozenNode::tAttribute> attributes;
+  std::vector<tFrozenNode::tText> texts;
+  std::vector<uint32_t> child_offsets;
+  std::vector<char> strings;
+
+  tFrozenDocument(const tFrozenDocument&); // generated copy-constructor is not safe
+  tFrozenDocument &operator = (const tFrozenDocument &);
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+#endif
@@ -33,10 +33,19 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include <cstring>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <unistd.h>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
+#include "rrlib/xml/arena.h"
+#include "rrlib/xml/base64.h"
+#include "rrlib/xml/tDocument.h"
+#include "rrlib/xml/tAttributeCache.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -66,6 +75,279 @@ namespace xml
 //----------------------------------------------------------------------
 // Implementation
 //----------------------------------------------------------------------
+namespace
+{
+
+tDocument *OwningDocument(const xmlNode *node)
+{
+  return node->doc ? static_cast<tDocument *>(node->doc->_private) : 0;
+}
+
+int WriteToString(void *context, const char *buffer, int length)
+{
+  static_cast<std::string *>(context)->append(buffer, length);
+  return length;
+}
+
+int WriteToStream(void *context, const char *buffer, int length)
+{
+  std::ostream &stream = *static_cast<std::ostream *>(context);
+  stream.write(buffer, length);
+  return stream ? length : -1;
+}
+
+int WriteToFileDescriptor(void *context, const char *buffer, int length)
+{
+  const int file_descriptor = *static_cast<const int *>(context);
+  for (int written = 0; written < length;)
+  {
+    const ssize_t result = write(file_descriptor, buffer + written, length - written);
+    if (result < 0 && errno != EINTR)
+    {
+      return -1;
+    }
+    written += result < 0 ? 0 : result;
+  }
+  return length;
+}
+
+struct tSinkContext
+{
+  const std::function<void(const char *, size_t)> &sink;
+  std::exception_ptr exception;
+};
+
+// Exceptions must not unwind through libxml2, so they are stored and rethrown afterwards
+int WriteToSink(void *context, const char *buffer, int length)
+{
+  tSinkContext &sink_context = *static_cast<tSinkContext *>(context);
+  try
+  {
+    sink_context.sink(buffer, length);
+  }
+  catch (...)
+  {
+    sink_context.exception = std::current_exception();
+    return -1;
+  }
+  return length;
+}
+
+const uint64_t cHASH_MULTIPLIER = 0xc6a4a7935bd1e995ULL;
+const uint64_t cELEMENT_SEED = 0x8445d61a4e774912ULL;
+const uint64_t cATTRIBUTE_SEED = 0x3c6ef372fe94f82bULL;
+const uint64_t cTEXT_SEED = 0xa54ff53a5f1d36f1ULL;
+const uint64_t cNAMESPACE_SEED = 0x510e527fade682d1ULL;
+
+inline uint64_t MixHash(uint64_t hash)
+{
+  hash ^= hash >> 47;
+  hash *= cHASH_MULTIPLIER;
+  return hash ^ (hash >> 47);
+}
+
+inline uint64_t CombineHashes(uint64_t hash, uint64_t value)
+{
+  return MixHash((hash ^ value) * cHASH_MULTIPLIER);
+}
+
+// MurmurHash64A
+uint64_t HashString(const char *data, size_t length, uint64_t seed)
+{
+  uint64_t hash = seed ^ (length * cHASH_MULTIPLIER);
+  for (const char *end = data + (length & ~static_cast<size_t>(7)); data != end; data += 8)
+  {
+    uint64_t block;
+    std::memcpy(&block, data, 8);
+    block *= cHASH_MULTIPLIER;
+    block ^= block >> 47;
+    block *= cHASH_MULTIPLIER;
+    hash = (hash ^ block) * cHASH_MULTIPLIER;
+  }
+  if (length & 7)
+  {
+    uint64_t block = 0;
+    std::memcpy(&block, data, length & 7);
+    hash = (hash ^ block) * cHASH_MULTIPLIER;
+  }
+  return MixHash(hash);
+}
+
+inline uint64_t HashString(const xmlChar *text, uint64_t seed)
+{
+  const char *data = text ? reinterpret_cast<const char *>(text) : "";
+  return HashString(data, std::strlen(data), seed);
+}
+
+// Names are qualified by the namespace URI (not the prefix)
+inline uint64_t HashName(const xmlChar *name, const xmlNs *ns, uint64_t seed)
+{
+  const uint64_t hash = HashString(name, seed);
+  return ns ? CombineHashes(hash, HashString(ns->href, cNAMESPACE_SEED)) : hash;
+}
+
+inline bool NamesAreEqual(const xmlChar *name, const xmlNs *ns, const xmlChar *other_name, const xmlNs *other_ns)
+{
+  return xmlStrEqual(name, other_name) && xmlStrEqual(ns ? ns->href : 0, other_ns ? other_ns->href : 0);
+}
+
+// Entity references count as their replacement text, like in GetTextContent
+inline bool IsText(const xmlNode *node)
+{
+  return node->type == XML_TEXT_NODE || node->type == XML_CDATA_SECTION_NODE || node->type == XML_ENTITY_REF_NODE;
+}
+
+void AppendText(const xmlNode *node, std::string &buffer)
+{
+  if (node->type == XML_ENTITY_REF_NODE)
+  {
+    xmlChar *content = xmlNodeGetContent(const_cast<xmlNode *>(node));
+    if (content)
+    {
+      buffer += reinterpret_cast<const char *>(content);
+      xmlFree(content);
+    }
+  }
+  else if (node->content)
+  {
+    buffer += reinterpret_cast<const char *>(node->content);
+  }
+}
+
+// Skips nodes that do not contribute to the canonical content
+inline const xmlNode *NextContentNode(const xmlNode *node)
+{
+  while (node && node->type != XML_ELEMENT_NODE && !IsText(node))
+  {
+    node = node->next;
+  }
+  return node;
+}
+
+// Provides the text of adjacent text, CDATA and entity reference nodes starting at node and advances node to the following content node
+const char *TextRun(const xmlNode *&node, std::string &buffer)
+{
+  const xmlNode *first = node;
+  node = NextContentNode(node->next);
+  if (first->type != XML_ENTITY_REF_NODE && (!node || !IsText(node)))
+  {
+    return first->content ? reinterpret_cast<const char *>(first->content) : "";
+  }
+  buffer.clear();
+  AppendText(first, buffer);
+  for (; node && IsText(node); node = NextContentNode(node->next))
+  {
+    AppendText(node, buffer);
+  }
+  return buffer.c_str();
+}
+
+uint64_t SubtreeFingerprint(const xmlNode *node, std::unordered_map<const xmlNode *, uint64_t> *memo)
+{
+  if (memo)
+  {
+    auto it = memo->find(node);
+    if (it != memo->end())
+    {
+      return it->second;
+    }
+  }
+
+  uint64_t hash = HashName(node->name, node->ns, cELEMENT_SEED);
+  uint64_t attributes = 0;
+  for (const xmlAttr *attribute = node->properties; attribute; attribute = attribute->next)
+  {
+    internal::tRawValue value(attribute);
+    attributes += HashString(value.Get(), std::strlen(value.Get()), HashName(attribute->name, attribute->ns, cATTRIBUTE_SEED));
+  }
+  hash = CombineHashes(hash, attributes);
+
+  std::string buffer;
+  for (const xmlNode *child = NextContentNode(node->children); child;)
+  {
+    if (child->type == XML_ELEMENT_NODE)
+    {
+      hash = CombineHashes(hash, SubtreeFingerprint(child, memo));
+      child = NextContentNode(child->next);
+    }
+    else
+    {
+      const char *text = TextRun(child, buffer);
+      hash = CombineHashes(hash, HashString(text, std::strlen(text), cTEXT_SEED));
+    }
+  }
+
+  if (memo)
+  {
+    (*memo)[node] = hash;
+  }
+  return hash;
+}
+
+bool AttributesAreEqual(const xmlNode *node, const xmlNode *other)
+{
+  size_t count = 0;
+  for (const xmlAttr *attribute = node->properties; attribute; attribute = attribute->next)
+  {
+    // Like the fingerprint, only attributes present in the node count (not declarations of DTD default values)
+    const xmlAttr *other_attribute = xmlHasNsProp(const_cast<xmlNode *>(other), attribute->name, attribute->ns ? attribute->ns->href : 0);
+    if (!other_attribute || other_attribute->type != XML_ATTRIBUTE_NODE)
+    {
+      return false;
+    }
+    internal::tRawValue value(attribute);
+    internal::tRawValue other_value(other_attribute);
+    if (std::strcmp(value.Get(), other_value.Get()) != 0)
+    {
+      return false;
+    }
+    ++count;
+  }
+  for (const xmlAttr *attribute = other->properties; attribute; attribute = attribute->next)
+  {
+    if (count-- == 0)
+    {
+      return false;
+    }
+  }
+  return count == 0;
+}
+
+bool SubtreesAreEqual(const xmlNode *node, const xmlNode *other, bool compare_fingerprints)
+{
+  if (compare_fingerprints && reinterpret_cast<const tNode *>(node)->Fingerprint() != reinterpret_cast<const tNode *>(other)->Fingerprint())
+  {
+    return false;
+  }
+  if (!NamesAreEqual(node->name, node->ns, other->name, other->ns) || !AttributesAreEqual(node, other))
+  {
+    return false;
+  }
+
+  std::string buffer;
+  std::string other_buffer;
+  const xmlNode *child = NextContentNode(node->children);
+  const xmlNode *other_child = NextContentNode(other->children);
+  while (child && other_child)
+  {
+    if (child->type == XML_ELEMENT_NODE)
+    {
+      if (other_child->type != XML_ELEMENT_NODE || !SubtreesAreEqual(child, other_child, compare_fingerprints))
+      {
+        return false;
+      }
+      child = NextContentNode(child->next);
+      other_child = NextContentNode(other_child->next);
+    }
+    else if (other_child->type == XML_ELEMENT_NODE || std::strcmp(TextRun(child, buffer), TextRun(other_child, other_buffer)) != 0)
+    {
+      return false;
+    }
+  }
+  return !child && !other_child;
+}
+
+}
 
 //----------------------------------------------------------------------
 // tNode destructor
@@ -144,27 +426,48 @@ tNode &tNode::FirstChild()
 //----------------------------------------------------------------------
 tNode &tNode::AddChildNode(const std::string &name, const std::string &content)
 {
+  internal::tArenaScope arena_scope(this->Arena());
   const char* c = (content.length() == 0) ? NULL : content.c_str();
-  return reinterpret_cast<tNode &>(*xmlNewChild(this, 0, reinterpret_cast<const xmlChar *>(name.c_str()), reinterpret_cast<const xmlChar *>(c)));
+  tNode &child = reinterpret_cast<tNode &>(*xmlNewChild(this, 0, reinterpret_cast<const xmlChar *>(name.c_str()), reinterpret_cast<const xmlChar *>(c)));
+  this->ContentModified();
+  this->InvalidateChildIndex();
+  return child;
 }
 
 tNode &tNode::AddChildNode(tNode &node, bool copy)
 {
+  internal::tArenaScope arena_scope(this->Arena());
   tNode *child = &node;
-  if (copy)
+  if (copy || this->RequiresCopyToMove(node))
   {
     child = reinterpret_cast<tNode *>(xmlDocCopyNode(child, this->doc, 1));
+    if (!copy)
+    {
+      node.FreeNode();
+    }
+  }
+  else
+  {
+    child->ContentModified();
+    if (child->parent)
+    {
+      reinterpret_cast<tNode *>(child->parent)->InvalidateChildIndex();
+    }
   }
   if (child->doc != this->doc)
   {
-    xmlUnlinkNode(child);
+    child->AdoptSubtree(this->doc, this);
   }
   if (this->IsInSubtreeOf(*child))
   {
     assert(!copy);
     throw tException("Cannot add node as child to its own subtree without copying!");
   }
+  // xmlAddChild expects an unlinked node, also when it is moved within its document
+  xmlUnlinkNode(child);
   xmlAddChild(this, child);
+  this->ContentModified();
+  this->InvalidateChildIndex();
   return *child;
 }
 
@@ -173,12 +476,135 @@ tNode &tNode::AddChildNode(tNode &node, bool copy)
 //----------------------------------------------------------------------
 void tNode::RemoveChildNode(tNode &node)
 {
-  iterator it = std::find(this->ChildrenBegin(), this->ChildrenEnd(), node);
-  if (it == this->ChildrenEnd())
+  if (node.parent != this || node.type != XML_ELEMENT_NODE)
   {
     throw tException("Given node is not a child of this!");
   }
-  it->FreeNode();
+  node.FreeNode();
+}
+
+//----------------------------------------------------------------------
+// tNode RemoveAllChildren
+//----------------------------------------------------------------------
+void tNode::RemoveAllChildren()
+{
+  xmlNodePtr child_nodes = this->children;
+  if (!child_nodes)
+  {
+    return;
+  }
+  for (xmlNodePtr child_node = child_nodes; child_node; child_node = child_node->next)
+  {
+    reinterpret_cast<tNode *>(child_node)->ReleaseCaches();
+  }
+  this->children = 0;
+  this->last = 0;
+  xmlFreeNodeList(child_nodes);
+  this->ContentModified();
+  this->InvalidateChildIndex();
+}
+
+//----------------------------------------------------------------------
+// tNode AddChildNodes
+//----------------------------------------------------------------------
+tNode &tNode::AddChildNodes(tNode &first, tNode &last)
+{
+  xmlNodePtr source = first.parent;
+  if (!source || last.parent != source || first.type != XML_ELEMENT_NODE || last.type != XML_ELEMENT_NODE)
+  {
+    throw tException("Range of nodes to add must consist of siblings!");
+  }
+
+  // The only node of the range that can contain this node is the ancestor whose parent is the parent of the range
+  xmlNodePtr ancestor = this;
+  while (ancestor && ancestor->parent != source)
+  {
+    ancestor = ancestor->parent;
+  }
+  xmlNodePtr end = last.next;
+  xmlNodePtr node = &first;
+  for (; node != end; node = node->next)
+  {
+    if (!node)
+    {
+      throw tException("Given last node does not follow the first node!");
+    }
+    if (node == ancestor)
+    {
+      throw tException("Cannot add nodes as children to their own subtree!");
+    }
+  }
+
+  internal::tArenaScope arena_scope(this->Arena());
+  if (this->RequiresCopyToMove(first))
+  {
+    tNode *result = 0;
+    for (node = &first; node != end;)
+    {
+      xmlNodePtr next_node = node->next;
+      xmlNodePtr copy = xmlDocCopyNode(node, this->doc, 1);
+      if (!copy)
+      {
+        throw tException("Could not copy node!");
+      }
+      xmlAddChild(this, copy);
+      result = result ? result : reinterpret_cast<tNode *>(copy);
+      reinterpret_cast<tNode *>(node)->FreeNode();
+      node = next_node;
+    }
+    this->ContentModified();
+    this->InvalidateChildIndex();
+    return *result;
+  }
+
+  reinterpret_cast<tNode *>(source)->ContentModified();
+  reinterpret_cast<tNode *>(source)->InvalidateChildIndex();
+  const bool other_document = first.doc != this->doc;
+
+  // Unlink the range as a whole
+  if (first.prev)
+  {
+    first.prev->next = end;
+  }
+  else
+  {
+    source->children = end;
+  }
+  if (end)
+  {
+    end->prev = first.prev;
+  }
+  else
+  {
+    source->last = first.prev;
+  }
+
+  // Append it to the children of this node
+  first.prev = this->last;
+  last.next = 0;
+  if (this->last)
+  {
+    this->last->next = &first;
+  }
+  else
+  {
+    this->children = &first;
+  }
+  this->last = &last;
+  for (node = &first; node; node = node->next)
+  {
+    node->parent = this;
+  }
+  if (other_document)
+  {
+    for (node = &first; node; node = node->next)
+    {
+      reinterpret_cast<tNode *>(node)->AdoptSubtree(this->doc, this);
+    }
+  }
+  this->ContentModified();
+  this->InvalidateChildIndex();
+  return first;
 }
 
 //----------------------------------------------------------------------
@@ -213,24 +639,44 @@ tNode &tNode::NextSibling()
 //----------------------------------------------------------------------
 tNode &tNode::AddNextSibling(const std::string &name, const std::string &content)
 {
+  internal::tArenaScope arena_scope(this->Arena());
   tNode *sibling = reinterpret_cast<tNode *>(xmlNewNode(0, reinterpret_cast<const xmlChar *>(name.c_str())));
   if (content != "")
   {
     xmlNodeSetContentLen(sibling, reinterpret_cast<const xmlChar *>(content.c_str()), content.length());
   }
-  return reinterpret_cast<tNode &>(*xmlAddNextSibling(this, sibling));
+  xmlAddNextSibling(this, sibling);
+  this->ContentModified();
+  if (this->parent)
+  {
+    reinterpret_cast<tNode *>(this->parent)->InvalidateChildIndex();
+  }
+  return *sibling;
 }
 
 tNode &tNode::AddNextSibling(tNode &node, bool copy)
 {
+  internal::tArenaScope arena_scope(this->Arena());
   tNode *sibling = &node;
-  if (copy)
+  if (copy || this->RequiresCopyToMove(node))
   {
     sibling = reinterpret_cast<tNode *>(xmlDocCopyNode(sibling, this->doc, 1));
+    if (!copy)
+    {
+      node.FreeNode();
+    }
+  }
+  else
+  {
+    sibling->ContentModified();
+    if (sibling->parent)
+    {
+      reinterpret_cast<tNode *>(sibling->parent)->InvalidateChildIndex();
+    }
   }
   if (sibling->doc != this->doc)
   {
-    xmlUnlinkNode(sibling);
+    sibling->AdoptSubtree(this->doc, this->parent);
   }
   if (this->IsInSubtreeOf(*sibling))
   {
@@ -238,6 +684,11 @@ tNode &tNode::AddNextSibling(tNode &node, bool copy)
     throw tException("Cannot add node as sibling in its own subtree without copying!");
   }
   xmlAddNextSibling(this, sibling);
+  this->ContentModified();
+  if (this->parent)
+  {
+    reinterpret_cast<tNode *>(this->parent)->InvalidateChildIndex();
+  }
   return *sibling;
 }
 
@@ -257,7 +708,9 @@ const std::string tNode::GetTextContent() const
 //----------------------------------------------------------------------
 void tNode::AddTextContent(const std::string &content)
 {
+  internal::tArenaScope arena_scope(this->Arena());
   xmlNodeAddContentLen(this, reinterpret_cast<const xmlChar *>(content.c_str()), content.length());
+  this->ContentModified();
 }
 
 //----------------------------------------------------------------------
@@ -265,7 +718,58 @@ void tNode::AddTextContent(const std::string &content)
 //----------------------------------------------------------------------
 void tNode::SetContent(const std::string &content)
 {
+  internal::tArenaScope arena_scope(this->Arena());
+  for (xmlNodePtr child_node = this->children; child_node; child_node = child_node->next)
+  {
+    reinterpret_cast<tNode *>(child_node)->ReleaseCaches();
+  }
   xmlNodeSetContentLen(this, reinterpret_cast<const xmlChar *>(content.c_str()), content.length());
+  this->ContentModified();
+  this->InvalidateChildIndex();
+}
+
+//----------------------------------------------------------------------
+// tNode GetBinaryContent
+//----------------------------------------------------------------------
+size_t tNode::GetBinaryContent(void *data, size_t size) const
+{
+  internal::tRawValue content(static_cast<const xmlNode *>(this));
+  return internal::DecodeBase64(content.Get(), std::strlen(content.Get()), data, size);
+}
+
+void tNode::GetBinaryContent(std::vector<uint8_t> &data) const
+{
+  internal::tRawValue content(static_cast<const xmlNode *>(this));
+  const size_t length = std::strlen(content.Get());
+  data.resize(internal::Base64DecodedSizeBound(length));
+  data.resize(internal::DecodeBase64(content.Get(), length, data.data(), data.size()));
+}
+
+//----------------------------------------------------------------------
+// tNode SetBinaryContent
+//----------------------------------------------------------------------
+void tNode::SetBinaryContent(const void *data, size_t size)
+{
+  internal::tArenaScope arena_scope(this->Arena());
+  const size_t length = internal::Base64EncodedLength(size);
+  xmlChar *content = static_cast<xmlChar *>(xmlMallocAtomic(length + 1));
+  if (!content)
+  {
+    throw tException("Could not allocate memory for base64 content!");
+  }
+  internal::EncodeBase64(data, size, reinterpret_cast<char *>(content));
+  content[length] = 0;
+
+  for (xmlNodePtr child_node = this->children; child_node; child_node = child_node->next)
+  {
+    reinterpret_cast<tNode *>(child_node)->ReleaseCaches();
+  }
+  xmlNodeSetContent(this, 0);
+  xmlNodePtr text = xmlNewDocText(this->doc, 0);
+  text->content = content;
+  xmlAddChild(this, text);
+  this->ContentModified();
+  this->InvalidateChildIndex();
 }
 
 //----------------------------------------------------------------------
@@ -273,18 +777,30 @@ void tNode::SetContent(const std::string &content)
 //----------------------------------------------------------------------
 void tNode::RemoveTextContent()
 {
-  std::vector<tNode *> nodes_to_delete;
-  for (xmlNodePtr child_node = this->children; child_node; child_node = child_node->next)
+  xmlNodePtr child_node = this->children;
+  while (child_node)
   {
+    xmlNodePtr next_node = child_node->next;
     if (xmlNodeIsText(child_node))
     {
-      nodes_to_delete.push_back(reinterpret_cast<tNode *>(child_node));
+      reinterpret_cast<tNode *>(child_node)->FreeNode();
     }
+    child_node = next_node;
   }
-  for (std::vector<tNode *>::iterator it = nodes_to_delete.begin(); it != nodes_to_delete.end(); ++it)
+}
+
+//----------------------------------------------------------------------
+// tNode GetAttribute
+//----------------------------------------------------------------------
+const xmlAttr &tNode::GetAttribute(const std::string &name) const
+{
+  // Like xmlGetProp, attributes defaulted by the DTD are found via their declaration (see internal::tRawValue)
+  xmlAttrPtr attribute = xmlHasProp(const_cast<tNode *>(this), reinterpret_cast<const xmlChar *>(name.c_str()));
+  if (!attribute)
   {
-    (*it)->FreeNode();
+    throw tException("Requested attribute `" + name + "' does not exist in this node!");
   }
+  return *attribute;
 }
 
 //----------------------------------------------------------------------
@@ -292,16 +808,25 @@ void tNode::RemoveTextContent()
 //----------------------------------------------------------------------
 void tNode::SetStringAttribute(const std::string &name, const std::string &value, bool create)
 {
-  if (!this->HasAttribute(name))
+  internal::tArenaScope arena_scope(this->Arena());
+  xmlAttrPtr attribute = xmlHasProp(this, reinterpret_cast<const xmlChar *>(name.c_str()));
+  if (!attribute)
   {
     if (create)
     {
       xmlNewProp(this, reinterpret_cast<const xmlChar *>(name.c_str()), reinterpret_cast<const xmlChar *>(value.c_str()));
+      this->ContentModified();
       return;
     }
     throw tException("Attribute `" + name + "' does not exist in this node and creation was disabled!");
   }
+  internal::tAttributeCache *cache = this->AttributeCache();
+  if (cache)
+  {
+    cache->Invalidate(attribute);
+  }
   xmlSetProp(this, reinterpret_cast<const xmlChar *>(name.c_str()), reinterpret_cast<const xmlChar *>(value.c_str()));
+  this->ContentModified();
 }
 
 //----------------------------------------------------------------------
@@ -310,24 +835,335 @@ void tNode::SetStringAttribute(const std::string &name, const std::string &value
 void tNode::RemoveAttribute(const std::string &name)
 {
   xmlAttrPtr attr = xmlHasProp(this, reinterpret_cast<const xmlChar *>(name.c_str()));
-  if (attr)
+  // Declarations of DTD default values cannot be removed
+  if (attr && attr->type == XML_ATTRIBUTE_NODE)
   {
+    internal::tAttributeCache *cache = this->AttributeCache();
+    if (cache)
+    {
+      cache->Invalidate(attr);
+    }
     xmlRemoveProp(attr);
+    this->ContentModified();
+  }
+}
+
+//----------------------------------------------------------------------
+// tNode EnableAttributeCache
+//----------------------------------------------------------------------
+void tNode::EnableAttributeCache()
+{
+  if (this->AttributeCache())
+  {
+    return;
+  }
+  tDocument *document = OwningDocument(this);
+  if (!document)
+  {
+    throw tException("Attribute caching is only available for nodes of a tDocument!");
+  }
+  if (this->_private)
+  {
+    throw tException("Private data of node `" + this->Name() + "' is already in use!");
+  }
+  internal::tAttributeCache *cache = new internal::tAttributeCache();
+  document->attribute_caches.insert(cache);
+  this->_private = cache;
+}
+
+//----------------------------------------------------------------------
+// tNode DisableAttributeCache
+//----------------------------------------------------------------------
+void tNode::DisableAttributeCache()
+{
+  internal::tAttributeCache *cache = this->AttributeCache();
+  if (cache)
+  {
+    tDocument *document = OwningDocument(this);
+    if (document)
+    {
+      document->attribute_caches.erase(cache);
+    }
+    delete cache;
+    this->_private = 0;
+  }
+}
+
+//----------------------------------------------------------------------
+// tNode AttributeCache
+//----------------------------------------------------------------------
+internal::tAttributeCache *tNode::AttributeCache() const
+{
+  tDocument *document = this->_private ? OwningDocument(this) : 0;
+  return document ? internal::tAttributeCache::FromPrivateData(this->_private, document->attribute_caches) : 0;
+}
+
+//----------------------------------------------------------------------
+// tNode ReleaseCaches
+//----------------------------------------------------------------------
+void tNode::ReleaseCaches()
+{
+  tDocument *document = OwningDocument(this);
+  if (!document || (document->attribute_caches.empty() && document->fingerprints.empty() && document->child_indices.empty()))
+  {
+    return;
+  }
+  xmlNodePtr current = this;
+  while (current)
+  {
+    reinterpret_cast<tNode *>(current)->DisableAttributeCache();
+    document->fingerprints.erase(current);
+    document->child_indices.erase(current);
+    if (current->type == XML_ELEMENT_NODE && current->children)
+    {
+      current = current->children;
+      continue;
+    }
+    while (current != this && !current->next)
+    {
+      current = current->parent;
+    }
+    current = current != this ? current->next : 0;
+  }
+}
+
+//----------------------------------------------------------------------
+// tNode ContentModified
+//----------------------------------------------------------------------
+void tNode::ContentModified()
+{
+  tDocument *document = OwningDocument(this);
+  if (!document)
+  {
+    return;
+  }
+  ++document->generation;
+  if (document->fingerprints.empty())
+  {
+    return;
+  }
+  // Modifications are not concurrent with readers, so fingerprints are dropped without locking
+  // Memoized elements always have memoized descendants, so the first ancestor without fingerprint ends the walk
+  document->fingerprints.erase(this);
+  for (const xmlNode *ancestor = this->parent; ancestor && document->fingerprints.erase(ancestor); ancestor = ancestor->parent)
+  {}
+}
+
+//----------------------------------------------------------------------
+// tNode Arena
+//----------------------------------------------------------------------
+internal::tArena *tNode::Arena() const
+{
+  tDocument *document = OwningDocument(this);
+  return document ? document->arena.get() : 0;
+}
+
+//----------------------------------------------------------------------
+// tNode RequiresCopyToMove
+//----------------------------------------------------------------------
+bool tNode::RequiresCopyToMove(const tNode &node) const
+{
+  // Heap memory in an arena document would leak and arena memory in another document would be released with the arena
+  return node.doc != this->doc && (node.Arena() || this->Arena());
+}
+
+//----------------------------------------------------------------------
+// tNode AdoptSubtree
+//----------------------------------------------------------------------
+void tNode::AdoptSubtree(xmlDocPtr document, xmlNodePtr parent)
+{
+  // Names and strings owned by the dictionary of the source document are moved to the target document
+  this->ReleaseCaches();
+  if (xmlDOMWrapAdoptNode(0, this->doc, this, document, parent, 0) != 0)
+  {
+    throw tException("Could not move node `" + this->Name() + "' to another document!");
+  }
+}
+
+//----------------------------------------------------------------------
+// tNode ChildAt
+//----------------------------------------------------------------------
+tNode &tNode::ChildAt(size_t index)
+{
+  const std::vector<tNode *> &child_index = this->ChildIndex();
+  if (index >= child_index.size())
+  {
+    throw tException("Child index " + std::to_string(index) + " is out of range!");
   }
+  return *child_index[index];
 }
 
+//----------------------------------------------------------------------
+// tNode ChildIndex
+//----------------------------------------------------------------------
+const std::vector<tNode *> &tNode::ChildIndex() const
+{
+  tDocument *document = OwningDocument(this);
+  if (!document)
+  {
+    throw tException("The child index is only available for nodes of a tDocument!");
+  }
+  std::lock_guard<std::mutex> lock(document->child_index_mutex);
+  auto it = document->child_indices.find(this);
+  if (it == document->child_indices.end())
+  {
+    std::vector<tNode *> child_index;
+    for (xmlNodePtr child_node = this->children; child_node; child_node = child_node->next)
+    {
+      if (child_node->type == XML_ELEMENT_NODE)
+      {
+        child_index.push_back(reinterpret_cast<tNode *>(child_node));
+      }
+    }
+    it = document->child_indices.emplace(static_cast<const xmlNode *>(this), std::move(child_index)).first;
+  }
+  return it->second;
+}
+
+//----------------------------------------------------------------------
+// tNode InvalidateChildIndex
+//----------------------------------------------------------------------
+void tNode::InvalidateChildIndex()
+{
+  // Modifications are not concurrent with readers, so the index can be dropped without locking
+  tDocument *document = OwningDocument(this);
+  if (document && !document->child_indices.empty())
+  {
+    document->child_indices.erase(this);
+  }
+}
+
+//----------------------------------------------------------------------
+// tNode LookupCachedAttribute
+//----------------------------------------------------------------------
+template <typename TValue>
+bool tNode::LookupCachedAttribute(const std::string &name, int base, TValue &value) const
+{
+  internal::tAttributeCache *cache = this->AttributeCache();
+  return cache && cache->Lookup(name, base, value);
+}
+
+//----------------------------------------------------------------------
+// tNode StoreCachedAttribute
+//----------------------------------------------------------------------
+template <typename TValue>
+void tNode::StoreCachedAttribute(const std::string &name, int base, TValue value) const
+{
+  internal::tAttributeCache *cache = this->AttributeCache();
+  xmlAttrPtr attribute = cache ? xmlHasProp(const_cast<tNode *>(this), reinterpret_cast<const xmlChar *>(name.c_str())) : 0;
+  if (attribute && attribute->type == XML_ATTRIBUTE_NODE)
+  {
+    cache->Store(attribute, base, value);
+  }
+}
+
+#define RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE(TValue) \
+  template bool tNode::LookupCachedAttribute<TValue>(const std::string &, int, TValue &) const; \
+  template void tNode::StoreCachedAttribute<TValue>(const std::string &, int, TValue) const;
+
+RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE(long int)
+RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE(long long int)
+RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE(float)
+RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE(double)
+RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE(long double)
+RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE(bool)
+
+#undef RRLIB_XML_INSTANTIATE_ATTRIBUTE_CACHE
+
 //----------------------------------------------------------------------
 // tNode GetXMLDump
 //----------------------------------------------------------------------
 const std::string tNode::GetXMLDump(bool format) const
 {
-  xmlBufferPtr buffer = xmlBufferCreate();
-  xmlNodeDump(buffer, this->doc, const_cast<tNode *>(this), 0, format);
-  std::string result(reinterpret_cast<const char *>(buffer->content));
-  xmlBufferFree(buffer);
+  std::string result;
+  this->GetXMLDump(result, format);
   return result;
 }
 
+void tNode::GetXMLDump(std::string &output, bool format) const
+{
+  this->DumpToOutputBuffer(WriteToString, &output, format);
+}
+
+void tNode::GetXMLDump(std::ostream &stream, bool format) const
+{
+  this->DumpToOutputBuffer(WriteToStream, &stream, format);
+}
+
+//----------------------------------------------------------------------
+// tNode GetXMLDumpToFileDescriptor
+//----------------------------------------------------------------------
+void tNode::GetXMLDumpToFileDescriptor(int file_descriptor, bool format) const
+{
+  this->DumpToOutputBuffer(WriteToFileDescriptor, &file_descriptor, format);
+}
+
+//----------------------------------------------------------------------
+// tNode GetXMLDumpToSink
+//----------------------------------------------------------------------
+void tNode::GetXMLDumpToSink(const std::function<void(const char *data, size_t size)> &sink, bool format) const
+{
+  tSinkContext context = { sink, std::exception_ptr() };
+  try
+  {
+    this->DumpToOutputBuffer(WriteToSink, &context, format);
+  }
+  catch (const tException &)
+  {
+    if (context.exception)
+    {
+      std::rethrow_exception(context.exception);
+    }
+    throw;
+  }
+}
+
+//----------------------------------------------------------------------
+// tNode Fingerprint
+//----------------------------------------------------------------------
+uint64_t tNode::Fingerprint() const
+{
+  tDocument *document = OwningDocument(this);
+  if (!document || !document->fingerprint_cache_enabled)
+  {
+    return SubtreeFingerprint(this, 0);
+  }
+  std::lock_guard<std::mutex> lock(document->fingerprint_mutex);
+  return SubtreeFingerprint(this, &document->fingerprints);
+}
+
+//----------------------------------------------------------------------
+// tNode DeepEquals
+//----------------------------------------------------------------------
+bool tNode::DeepEquals(const tNode &other) const
+{
+  if (this == &other)
+  {
+    return true;
+  }
+  tDocument *document = OwningDocument(this);
+  tDocument *other_document = OwningDocument(&other);
+  const bool compare_fingerprints = document && document->fingerprint_cache_enabled && other_document && other_document->fingerprint_cache_enabled;
+  return SubtreesAreEqual(this, &other, compare_fingerprints);
+}
+
+//----------------------------------------------------------------------
+// tNode DumpToOutputBuffer
+//----------------------------------------------------------------------
+void tNode::DumpToOutputBuffer(xmlOutputWriteCallback write_callback, void *context, bool format) const
+{
+  xmlOutputBufferPtr output = xmlOutputBufferCreateIO(write_callback, 0, context, 0);
+  if (!output)
+  {
+    throw tException("Could not create output buffer!");
+  }
+  xmlNodeDumpOutput(output, this->doc, const_cast<tNode *>(this), 0, format, 0);
+  if (xmlOutputBufferClose(output) < 0)
+  {
+    throw tException("Could not write xml dump!");
+  }
+}
+
 //----------------------------------------------------------------------
 // End of namespace declaration
 //----------------------------------------------------------------------
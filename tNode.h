@@ -52,15 +52,21 @@ extern "C"
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <functional>
 #include <cerrno>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iterator>
+#include <memory>
 #include "rrlib/util/tNoncopyable.h"
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "rrlib/xml/tException.h"
+#include "rrlib/xml/numeric_arrays.h"
+#include "rrlib/xml/tEnumNameTable.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -78,6 +84,72 @@ namespace xml
 //----------------------------------------------------------------------
 // Forward declarations / typedefs / enums
 //----------------------------------------------------------------------
+namespace internal
+{
+
+class tArena;
+class tAttributeCache;
+
+constexpr tEnumNameTable<2> cBOOL_NAMES = CreateEnumNameTable("false", "true");
+
+//! Provides the text of an attribute or node without copying it if it is stored in a single text node
+class tRawValue : public util::tNoncopyable
+{
+public:
+  explicit tRawValue(const xmlAttr *attribute)
+    : value(""), allocated(0)
+  {
+    // xmlHasProp returns the declaration of an attribute that is omitted but has a default value in the DTD
+    if (attribute->type == XML_ATTRIBUTE_DECL)
+    {
+      const xmlChar *default_value = reinterpret_cast<const xmlAttribute *>(attribute)->defaultValue;
+      this->value = default_value ? reinterpret_cast<const char *>(default_value) : "";
+    }
+    else if (!this->UseSingleTextNode(attribute->children) && attribute->children)
+    {
+      this->Adopt(xmlNodeListGetString(attribute->doc, attribute->children, 1));
+    }
+  }
+  explicit tRawValue(const xmlNode *node)
+    : value(""), allocated(0)
+  {
+    if (!this->UseSingleTextNode(node->children))
+    {
+      this->Adopt(xmlNodeGetContent(const_cast<xmlNode *>(node)));
+    }
+  }
+  ~tRawValue()
+  {
+    if (this->allocated)
+    {
+      xmlFree(this->allocated);
+    }
+  }
+  inline const char *Get() const
+  {
+    return this->value;
+  }
+private:
+  const char *value;
+  xmlChar *allocated;
+
+  inline bool UseSingleTextNode(const xmlNode *children)
+  {
+    if (children && !children->next && children->type == XML_TEXT_NODE && children->content)
+    {
+      this->value = reinterpret_cast<const char *>(children->content);
+      return true;
+    }
+    return false;
+  }
+  inline void Adopt(xmlChar *content)
+  {
+    this->allocated = content;
+    this->value = content ? reinterpret_cast<const char *>(content) : "";
+  }
+};
+
+}
 
 //----------------------------------------------------------------------
 // Class declaration
@@ -93,6 +165,8 @@ namespace xml
 class tNode : protected xmlNode, public util::tNoncopyable
 {
   friend class tDocument;
+  friend class tNodeBuilder;
+  friend class tFrozenDocument;
 
 //----------------------------------------------------------------------
 // Public methods and typedefs
@@ -202,6 +276,234 @@ public:
     }
   };
 
+  //! Pre-order iterator over all descendants of type XML_ELEMENT_NODE
+  /*! The traversal follows the parent and sibling links of the nodes,
+   *  so it needs neither recursion nor a stack.
+   */
+  template <typename TNode>
+  class tDescendantIterator : public std::iterator<std::forward_iterator_tag, TNode, size_t>
+  {
+    template <typename> friend class tDescendantIterator;
+    const xmlNode *element;
+    const xmlNode *root;
+
+  public:
+    inline tDescendantIterator() : element(0), root(0) {}
+    inline tDescendantIterator(TNode *root) : element(FirstElement(root->children)), root(root) {}
+    template <typename TOther>
+    inline tDescendantIterator(const tDescendantIterator<TOther> &other) : element(other.element), root(other.root) {}
+
+    inline TNode &operator*() const
+    {
+      return *reinterpret_cast<TNode *>(const_cast<xmlNode *>(this->element));
+    }
+    inline TNode *operator->() const
+    {
+      return &(operator*());
+    }
+
+    inline tDescendantIterator &operator ++ ()
+    {
+      const xmlNode *child = FirstElement(this->element->children);
+      if (child)
+      {
+        this->element = child;
+        return *this;
+      }
+      for (const xmlNode *current = this->element; current != this->root; current = current->parent)
+      {
+        const xmlNode *sibling = FirstElement(current->next);
+        if (sibling)
+        {
+          this->element = sibling;
+          return *this;
+        }
+      }
+      this->element = 0;
+      return *this;
+    }
+    inline tDescendantIterator operator ++ (int)
+    {
+      tDescendantIterator temp(*this);
+      operator++();
+      return temp;
+    }
+
+    inline const bool operator == (const tDescendantIterator &other) const
+    {
+      return element == other.element;
+    }
+    inline const bool operator != (const tDescendantIterator &other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  typedef tDescendantIterator<tNode> descendant_iterator;
+  typedef tDescendantIterator<const tNode> const_descendant_iterator;
+
+  //! Bidirectional iterator over siblings of type XML_ELEMENT_NODE
+  /*! The end-iterator of a parent's children can be decremented to its
+   *  last child, so ranges of children work with std::reverse_iterator.
+   */
+  template <typename TNode>
+  class tSiblingIterator : public std::iterator<std::bidirectional_iterator_tag, TNode, size_t>
+  {
+    template <typename> friend class tSiblingIterator;
+    const xmlNode *element;
+    const xmlNode *parent;
+
+  public:
+    inline tSiblingIterator() : element(0), parent(0) {}
+    inline tSiblingIterator(TNode *element) : element(element), parent(element->parent) {}
+    inline tSiblingIterator(const xmlNode *element, const xmlNode *parent) : element(FirstElement(element)), parent(parent) {}
+    template <typename TOther>
+    inline tSiblingIterator(const tSiblingIterator<TOther> &other) : element(other.element), parent(other.parent) {}
+
+    inline TNode &operator*() const
+    {
+      return *reinterpret_cast<TNode *>(const_cast<xmlNode *>(this->element));
+    }
+    inline TNode *operator->() const
+    {
+      return &(operator*());
+    }
+
+    inline tSiblingIterator &operator ++ ()
+    {
+      this->element = FirstElement(this->element->next);
+      return *this;
+    }
+    inline tSiblingIterator operator ++ (int)
+    {
+      tSiblingIterator temp(*this);
+      operator++();
+      return temp;
+    }
+    inline tSiblingIterator &operator -- ()
+    {
+      this->element = this->element ? this->element->prev : this->parent->last;
+      while (this->element && this->element->type != XML_ELEMENT_NODE)
+      {
+        this->element = this->element->prev;
+      }
+      return *this;
+    }
+    inline tSiblingIterator operator -- (int)
+    {
+      tSiblingIterator temp(*this);
+      operator--();
+      return temp;
+    }
+
+    inline const bool operator == (const tSiblingIterator &other) const
+    {
+      return element == other.element;
+    }
+    inline const bool operator != (const tSiblingIterator &other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  typedef tSiblingIterator<tNode> sibling_iterator;
+  typedef tSiblingIterator<const tNode> const_sibling_iterator;
+
+  //! Iterator over the children of type XML_ELEMENT_NODE with a given name
+  /*! The name is looked up in the dictionary of the document once. As
+   *  nodes of documents with dictionary (e.g. parsed documents) share
+   *  the names stored there, matching names are usually recognized by
+   *  comparing pointers.
+   */
+  template <typename TNode>
+  class tNamedChildIterator : public std::iterator<std::forward_iterator_tag, TNode, size_t>
+  {
+    template <typename> friend class tNamedChildIterator;
+    const xmlNode *element;
+    const xmlChar *name;
+    std::shared_ptr<const std::string> name_storage;
+
+    inline void SkipOtherNames()
+    {
+      while (this->element && (this->element->type != XML_ELEMENT_NODE || (this->element->name != this->name && !xmlStrEqual(this->element->name, this->name))))
+      {
+        this->element = this->element->next;
+      }
+    }
+
+  public:
+    inline tNamedChildIterator() : element(0), name(0) {}
+    inline tNamedChildIterator(TNode *parent, const std::string &name) : element(parent->children), name(0)
+    {
+      if (parent->doc && parent->doc->dict)
+      {
+        this->name = xmlDictExists(parent->doc->dict, reinterpret_cast<const xmlChar *>(name.c_str()), name.length());
+      }
+      if (!this->name)
+      {
+        this->name_storage = std::make_shared<const std::string>(name);
+        this->name = reinterpret_cast<const xmlChar *>(this->name_storage->c_str());
+      }
+      this->SkipOtherNames();
+    }
+    template <typename TOther>
+    inline tNamedChildIterator(const tNamedChildIterator<TOther> &other) : element(other.element), name(other.name), name_storage(other.name_storage) {}
+
+    inline TNode &operator*() const
+    {
+      return *reinterpret_cast<TNode *>(const_cast<xmlNode *>(this->element));
+    }
+    inline TNode *operator->() const
+    {
+      return &(operator*());
+    }
+
+    inline tNamedChildIterator &operator ++ ()
+    {
+      this->element = this->element->next;
+      this->SkipOtherNames();
+      return *this;
+    }
+    inline tNamedChildIterator operator ++ (int)
+    {
+      tNamedChildIterator temp(*this);
+      operator++();
+      return temp;
+    }
+
+    inline const bool operator == (const tNamedChildIterator &other) const
+    {
+      return element == other.element;
+    }
+    inline const bool operator != (const tNamedChildIterator &other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  typedef tNamedChildIterator<tNode> named_child_iterator;
+  typedef tNamedChildIterator<const tNode> const_named_child_iterator;
+
+  //! A pair of iterators for range-based for loops and algorithms
+  template <typename TIterator>
+  class tRange
+  {
+    TIterator first;
+    TIterator last;
+
+  public:
+    inline tRange(const TIterator &first, const TIterator &last) : first(first), last(last) {}
+
+    inline TIterator begin() const
+    {
+      return this->first;
+    }
+    inline TIterator end() const
+    {
+      return this->last;
+    }
+  };
+
   /*! The dtor of tNode
    */
   ~tNode();
@@ -214,6 +516,12 @@ public:
    */
   void FreeNode()
   {
+    this->ContentModified();
+    if (this->type == XML_ELEMENT_NODE && this->parent)
+    {
+      reinterpret_cast<tNode *>(this->parent)->InvalidateChildIndex();
+    }
+    this->ReleaseCaches();
     xmlUnlinkNode(this);
     xmlFreeNode(this);
   }
@@ -315,6 +623,53 @@ public:
    */
   const const_iterator &ChildrenEnd() const;
 
+  /*! Get the children of type XML_ELEMENT_NODE as bidirectional range
+   *
+   * \returns A range for use with range-based for loops and algorithms
+   */
+  inline tRange<sibling_iterator> Children()
+  {
+    return tRange<sibling_iterator>(sibling_iterator(this->children, this), sibling_iterator(0, this));
+  }
+
+  inline tRange<const_sibling_iterator> Children() const
+  {
+    return tRange<const_sibling_iterator>(const_sibling_iterator(this->children, this), const_sibling_iterator(0, this));
+  }
+
+  /*! Get the children of type XML_ELEMENT_NODE with a given name
+   *
+   * \param name   The name of the children
+   *
+   * \returns A range for use with range-based for loops and algorithms
+   */
+  inline tRange<named_child_iterator> ChildrenNamed(const std::string &name)
+  {
+    return tRange<named_child_iterator>(named_child_iterator(this, name), named_child_iterator());
+  }
+
+  inline tRange<const_named_child_iterator> ChildrenNamed(const std::string &name) const
+  {
+    return tRange<const_named_child_iterator>(const_named_child_iterator(this, name), const_named_child_iterator());
+  }
+
+  /*! Get all descendants of type XML_ELEMENT_NODE in pre-order (document order)
+   *
+   * This node itself is not included. The subtree must not be modified
+   * during the traversal.
+   *
+   * \returns A range for use with range-based for loops and algorithms
+   */
+  inline tRange<descendant_iterator> Descendants()
+  {
+    return tRange<descendant_iterator>(descendant_iterator(this), descendant_iterator());
+  }
+
+  inline tRange<const_descendant_iterator> Descendants() const
+  {
+    return tRange<const_descendant_iterator>(const_descendant_iterator(this), const_descendant_iterator());
+  }
+
   /*! Check if this node has children of type XML_ELEMENT_NODE
    *
    * This method can be used to check if a node has children before
@@ -339,6 +694,63 @@ public:
     return std::distance(this->ChildrenBegin(), this->ChildrenEnd());
   }
 
+  /*! Get the number of children of type XML_ELEMENT_NODE using the child index
+   *
+   * The first call to ChildCount, ChildAt or LowerBoundChild builds an
+   * index of the children of this node, which is kept by the document
+   * until the children of this node are added, removed or moved through
+   * tNode. Afterwards, these methods take constant (or logarithmic) time.
+   * Indices of const documents (e.g. snapshots) can be built and used by
+   * several threads concurrently.
+   *
+   * \note Children modified directly via libxml2 are not noticed by the index
+   *
+   * \exception tException is thrown if this node does not belong to a tDocument
+   *
+   * \returns The number of children of type XML_ELEMENT_NODE
+   */
+  inline size_t ChildCount() const
+  {
+    return this->ChildIndex().size();
+  }
+
+  /*! Get access to a child by its position using the child index
+   *
+   * \exception tException is thrown if \a index is out of range or this node does not belong to a tDocument
+   *
+   * \param index   The position among the children of type XML_ELEMENT_NODE
+   *
+   * \returns The child at \a index
+   */
+  tNode &ChildAt(size_t index);
+
+  inline const tNode &ChildAt(size_t index) const
+  {
+    return const_cast<tNode *>(this)->ChildAt(index);
+  }
+
+  /*! Binary search among the children using the child index
+   *
+   * The children must be sorted with respect to \a compare, e.g. table
+   * rows sorted by a key attribute.
+   *
+   * \exception tException is thrown if this node does not belong to a tDocument
+   *
+   * \param value     The value to search for
+   * \param compare   A function or functor that takes a const tNode & and \a value and returns whether the child is ordered before \a value
+   *
+   * \returns The position of the first child that is not ordered before \a value (ChildCount if there is none)
+   */
+  template <typename TValue, typename TCompare>
+  size_t LowerBoundChild(const TValue &value, TCompare compare) const
+  {
+    const std::vector<tNode *> &index = this->ChildIndex();
+    return std::lower_bound(index.begin(), index.end(), value, [&compare](const tNode * child, const TValue & value)
+    {
+      return compare(static_cast<const tNode &>(*child), value);
+    }) - index.begin();
+  }
+
   /*! Get access to first child of this node
    *
    * This method gives access to the first child of \a this
@@ -386,6 +798,15 @@ public:
    * If \a copy is set to true the node and its complete subtree is copied
    * to its new place and the old version remains at its origin.
    *
+   * A node from another document is moved without copying its subtree.
+   * Only names and strings that are owned by the dictionary of the
+   * source document are duplicated for the target document.
+   *
+   * Memory cannot be passed between documents if one of them uses arena
+   * allocation. Moving \a node into or out of such a document therefore
+   * adds a copy and removes \a node, so references to \a node and its
+   * descendants become invalid.
+   *
    * \exception tException is thrown if \this is contained in the subtree of \a node and \a copy is false
    *
    * \param node   The node to be added
@@ -405,6 +826,61 @@ public:
    */
   void RemoveChildNode(tNode &node);
 
+  /*! Remove all children that satisfy a predicate
+   *
+   * The children of type XML_ELEMENT_NODE are visited once in document
+   * order. Each child for which \a predicate returns true is removed
+   * together with its subtree. The predicate must not modify the tree.
+   *
+   * \param predicate   A function or functor that takes a const tNode & and returns bool
+   *
+   * \returns The number of removed children
+   */
+  template <typename TPredicate>
+  size_t RemoveChildrenIf(TPredicate predicate)
+  {
+    size_t removed = 0;
+    xmlNodePtr child_node = this->children;
+    while (child_node)
+    {
+      xmlNodePtr next_node = child_node->next;
+      if (child_node->type == XML_ELEMENT_NODE && predicate(static_cast<const tNode &>(*reinterpret_cast<tNode *>(child_node))))
+      {
+        reinterpret_cast<tNode *>(child_node)->FreeNode();
+        ++removed;
+      }
+      child_node = next_node;
+    }
+    return removed;
+  }
+
+  /*! Remove all children
+   *
+   * Removes all child nodes including text content and comments.
+   */
+  void RemoveAllChildren();
+
+  /*! Move a range of siblings to the children of this node
+   *
+   * The siblings from \a first to \a last, including text content and
+   * comments between them, are appended to the children of this node
+   * in their order. Within a document, the range is moved without
+   * copying or visiting the subtrees of its nodes. Ranges from another
+   * document are moved like in AddChildNode.
+   *
+   * If one of the documents uses arena allocation and the range comes
+   * from another document, copies are added and the range is removed,
+   * so references to its nodes become invalid.
+   *
+   * \exception tException is thrown if \a last is not a following sibling of \a first or this node is contained in the subtree of the range
+   *
+   * \param first   The first node of the range
+   * \param last    The last node of the range (can be \a first)
+   *
+   * \returns A reference to the new child that corresponds to \a first
+   */
+  tNode &AddChildNodes(tNode &first, tNode &last);
+
   /*! Get an iterator to the next of this node's siblings of type XML_ELEMENT_NODE
    *
    * \returns A begin-iterator
@@ -484,6 +960,15 @@ public:
    * If \a copy is set to true the node and its complete subtree is copied
    * to its new place and the old version remains at its origin.
    *
+   * A node from another document is moved without copying its subtree.
+   * Only names and strings that are owned by the dictionary of the
+   * source document are duplicated for the target document.
+   *
+   * Memory cannot be passed between documents if one of them uses arena
+   * allocation. Moving \a node into or out of such a document therefore
+   * adds a copy and removes \a node, so references to \a node and its
+   * descendants become invalid.
+   *
    * \exception tException is thrown if \this is contained in the subtree of \a node and \a copy is false
    *
    * \param node   The node to be added
@@ -520,6 +1005,38 @@ public:
    */
   void SetContent(const std::string &content);
 
+  /*! Get the base64 encoded content of this node as binary data
+   *
+   * The text content of this node is decoded directly into the given
+   * buffer. Whitespace within the text is ignored.
+   *
+   * \exception tException is thrown if the content is not valid base64 or does not fit into the buffer
+   *
+   * \param data   The buffer to store the decoded bytes in
+   * \param size   The capacity of \a data
+   *
+   * \returns The number of decoded bytes
+   */
+  size_t GetBinaryContent(void *data, size_t size) const;
+
+  /*! Get the base64 encoded content of this node as binary data stored in a given vector
+   *
+   * \exception tException is thrown if the content is not valid base64
+   *
+   * \param data   The vector to store the decoded bytes in (resized to the decoded size)
+   */
+  void GetBinaryContent(std::vector<uint8_t> &data) const;
+
+  /*! Set the content of this node to base64 encoded binary data
+   *
+   * The data is encoded directly into the text node that replaces
+   * the current content of this node.
+   *
+   * \param data   The data to store
+   * \param size   The number of bytes in \a data
+   */
+  void SetBinaryContent(const void *data, size_t size);
+
   /*! Get whether this node has the given attribute or not
    *
    * Each XML node can have several attributes. Calling this method
@@ -588,7 +1105,10 @@ public:
    */
   inline const long int GetLongIntAttribute(const std::string &name, int base = 10) const
   {
-    return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtol, base);
+    return this->GetCachedAttribute<long int>(name, base, [&]
+    {
+      return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtol, base);
+    });
   }
 
   /*! Get an XML attribute as long long int
@@ -606,7 +1126,10 @@ public:
    */
   inline const long long int GetLongLongIntAttribute(const std::string &name, int base = 10) const
   {
-    return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtoll, base);
+    return this->GetCachedAttribute<long long int>(name, base, [&]
+    {
+      return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtoll, base);
+    });
   }
 
   /*! Get an XML attribute as float
@@ -622,7 +1145,10 @@ public:
    */
   inline const float GetFloatAttribute(const std::string &name) const
   {
-    return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtof);
+    return this->GetCachedAttribute<float>(name, 0, [&]
+    {
+      return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtof);
+    });
   }
 
   /*! Get an XML attribute as double
@@ -638,7 +1164,10 @@ public:
    */
   inline const double GetDoubleAttribute(const std::string &name) const
   {
-    return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtod);
+    return this->GetCachedAttribute<double>(name, 0, [&]
+    {
+      return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtod);
+    });
   }
 
   /*! Get an XML attribute as long double
@@ -654,7 +1183,10 @@ public:
    */
   inline const long double GetLongDoubleAttribute(const std::string &name) const
   {
-    return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtold);
+    return this->GetCachedAttribute<long double>(name, 0, [&]
+    {
+      return tNode::ConvertStringToNumber(this->GetStringAttribute(name), std::strtold);
+    });
   }
 
   /*! Get an XML attribute as enum (safe variant)
@@ -706,6 +1238,34 @@ public:
     return std::distance(enum_names_begin, it);
   }
 
+  /*! Get an XML attribute as enum (using a perfect hash table of names)
+   *
+   * If the XML node wrapped by this instance has an attribute with
+   * the given name, its value is interpreted as name of an element
+   * in an enumeration. The table of names is created at compile time
+   * using CreateEnumNameTable, so the attribute's value is resolved
+   * with a single hash computation and one comparison, without
+   * copying it.
+   *
+   * \exception tException is thrown if the requested attribute's value is not available or not a member of the given table
+   *
+   * \param name         The name of the attribute
+   * \param enum_names   The table of possible enum strings
+   *
+   * \returns The index of the matching element name as enum value
+   */
+  template <size_t N>
+  inline size_t GetEnumAttribute(const std::string &name, const tEnumNameTable<N> &enum_names) const
+  {
+    internal::tRawValue value(&this->GetAttribute(name));
+    const size_t index = enum_names.Find(value.Get());
+    if (index == N)
+    {
+      throw tException("Invalid value for " + this->Name() + "." + name + ": `" + value.Get() + "'");
+    }
+    return index;
+  }
+
   /*! Get an XML attribute as bool
    *
    * If the XML node wrapped by this instance has an attribute with
@@ -720,8 +1280,84 @@ public:
    */
   inline const bool GetBoolAttribute(const std::string &name) const
   {
-    static const std::vector<std::string> bool_names = { "false", "true" };
-    return this->GetEnumAttribute(name, bool_names.begin(), bool_names.end());
+    return this->GetCachedAttribute<bool>(name, 0, [&]
+    {
+      return this->GetEnumAttribute(name, internal::cBOOL_NAMES) != 0;
+    });
+  }
+
+  /*! Get an XML attribute as list of numbers stored in a given buffer
+   *
+   * If the XML node wrapped by this instance has an attribute with
+   * the given name, its value is interpreted as list of numbers
+   * separated by whitespace or commas. The numbers are parsed directly
+   * from the attribute data into the given buffer.
+   *
+   * \exception tException is thrown if the requested attribute is not available, an element is not a number or the buffer is too small
+   *
+   * \param name     The name of the attribute
+   * \param values   The buffer to store the numbers in
+   * \param size     The capacity of \a values
+   *
+   * \returns The number of elements stored in \a values
+   */
+  template <typename TNumber>
+  inline size_t GetNumericArrayAttribute(const std::string &name, TNumber *values, size_t size) const
+  {
+    internal::tRawValue value(&this->GetAttribute(name));
+    return internal::ParseNumericArray(value.Get(), values, size);
+  }
+
+  /*! Get an XML attribute as list of numbers stored in a given vector
+   *
+   * Like the buffer variant, but \a values is resized to the number of
+   * elements found in the attribute.
+   *
+   * \exception tException is thrown if the requested attribute is not available or an element is not a number
+   *
+   * \param name     The name of the attribute
+   * \param values   The vector to store the numbers in
+   */
+  template <typename TNumber>
+  inline void GetNumericArrayAttribute(const std::string &name, std::vector<TNumber> &values) const
+  {
+    internal::tRawValue value(&this->GetAttribute(name));
+    tNode::ParseNumericArray(value.Get(), values);
+  }
+
+  /*! Get the plain text content of this node as list of numbers stored in a given buffer
+   *
+   * The content is interpreted as list of numbers separated by
+   * whitespace or commas and parsed directly into the given buffer.
+   *
+   * \exception tException is thrown if an element is not a number or the buffer is too small
+   *
+   * \param values   The buffer to store the numbers in
+   * \param size     The capacity of \a values
+   *
+   * \returns The number of elements stored in \a values
+   */
+  template <typename TNumber>
+  inline size_t GetNumericArrayContent(TNumber *values, size_t size) const
+  {
+    internal::tRawValue value(static_cast<const xmlNode *>(this));
+    return internal::ParseNumericArray(value.Get(), values, size);
+  }
+
+  /*! Get the plain text content of this node as list of numbers stored in a given vector
+   *
+   * Like the buffer variant, but \a values is resized to the number of
+   * elements found in the content.
+   *
+   * \exception tException is thrown if an element is not a number
+   *
+   * \param values   The vector to store the numbers in
+   */
+  template <typename TNumber>
+  inline void GetNumericArrayContent(std::vector<TNumber> &values) const
+  {
+    internal::tRawValue value(static_cast<const xmlNode *>(this));
+    tNode::ParseNumericArray(value.Get(), values);
   }
 
   /*! Get list of XML attributes of this node
@@ -804,18 +1440,166 @@ public:
     this->SetStringAttribute(name, value, create);
   }
 
+  /*! Set an XML attribute of this node to a list of numbers
+   *
+   * Floating point numbers are written with full precision so that
+   * reading them back yields the same values.
+   *
+   * \exception tException is thrown if the requested attribute does not exist and should not be created
+   *
+   * \param name        The name of the attribute
+   * \param values      The numbers to store
+   * \param size        The number of elements in \a values
+   * \param delimiter   The character written between two numbers
+   * \param create      Whether a non-existing attribute should be created or not
+   */
+  template <typename TNumber>
+  inline void SetNumericArrayAttribute(const std::string &name, const TNumber *values, size_t size, char delimiter = ' ', bool create = true)
+  {
+    std::string converted_value;
+    internal::FormatNumericArray(values, size, delimiter, converted_value);
+    this->SetStringAttribute(name, converted_value, create);
+  }
+
+  template <typename TNumber>
+  inline void SetNumericArrayAttribute(const std::string &name, const std::vector<TNumber> &values, char delimiter = ' ', bool create = true)
+  {
+    this->SetNumericArrayAttribute(name, values.data(), values.size(), delimiter, create);
+  }
+
+  /*! Set the content of this node to a list of numbers
+   *
+   * \param values      The numbers to store
+   * \param size        The number of elements in \a values
+   * \param delimiter   The character written between two numbers
+   */
+  template <typename TNumber>
+  inline void SetNumericArrayContent(const TNumber *values, size_t size, char delimiter = ' ')
+  {
+    std::string content;
+    internal::FormatNumericArray(values, size, delimiter, content);
+    this->SetContent(content);
+  }
+
+  template <typename TNumber>
+  inline void SetNumericArrayContent(const std::vector<TNumber> &values, char delimiter = ' ')
+  {
+    this->SetNumericArrayContent(values.data(), values.size(), delimiter);
+  }
+
   /*! Remove an attribute from this node
    *
    * \param name     The name of the attribute
    */
   void RemoveAttribute(const std::string &name);
 
+  /*! Enable caching of converted attribute values for this node
+   *
+   * Nodes whose attributes are read repeatedly, e.g. in every control
+   * cycle, can keep the results of the typed getters (numbers and bool)
+   * so that subsequent reads skip string conversion. A cached read
+   * confirms the _private pointer of the node in the hash set of caches
+   * of its document and compares the attribute name with the few
+   * entries of the cache, without searching the attributes of the node.
+   * Setting or removing attributes through this class or
+   * tDocument::Reparse invalidates the cached values.
+   *
+   * \note Attributes modified directly via libxml2 are not noticed by the cache
+   *
+   * \exception tException is thrown if this node does not belong to a tDocument or its _private pointer is already in use
+   */
+  void EnableAttributeCache();
+
+  /*! Disable caching of converted attribute values for this node
+   */
+  void DisableAttributeCache();
+
+  /*! Check if caching of converted attribute values is enabled for this node
+   *
+   * \returns Whether this node has an attribute cache
+   */
+  inline bool HasAttributeCache() const
+  {
+    return this->AttributeCache() != 0;
+  }
+
   /*! Get a dump in form of xml code of the subtree starting at \a this
    *
    * \param format   Set to true if the dumped text should be indented
    */
   const std::string GetXMLDump(bool format = false) const;
 
+  /*! Append a dump in form of xml code of the subtree starting at \a this to a string
+   *
+   * The output is written directly into \a output, so reusing the same
+   * string for repeated dumps avoids any allocation once its capacity
+   * suffices.
+   *
+   * \param output   The string to append the dump to
+   * \param format   Set to true if the dumped text should be indented
+   */
+  void GetXMLDump(std::string &output, bool format = false) const;
+
+  /*! Write a dump in form of xml code of the subtree starting at \a this to a stream
+   *
+   * \exception tException is thrown if writing to \a stream fails
+   *
+   * \param stream   The stream to write the dump to
+   * \param format   Set to true if the dumped text should be indented
+   */
+  void GetXMLDump(std::ostream &stream, bool format = false) const;
+
+  /*! Write a dump in form of xml code of the subtree starting at \a this to a file descriptor
+   *
+   * \exception tException is thrown if writing to \a file_descriptor fails
+   *
+   * \param file_descriptor   The file descriptor to write the dump to (it is not closed)
+   * \param format            Set to true if the dumped text should be indented
+   */
+  void GetXMLDumpToFileDescriptor(int file_descriptor, bool format = false) const;
+
+  /*! Pass a dump in form of xml code of the subtree starting at \a this to a callback in chunks
+   *
+   * The chunks are only valid during the call of \a sink. Exceptions
+   * thrown by \a sink abort the dump and are rethrown to the caller.
+   *
+   * \param sink     The function that receives the chunks of the dump
+   * \param format   Set to true if the dumped text should be indented
+   */
+  void GetXMLDumpToSink(const std::function<void(const char *data, size_t size)> &sink, bool format = false) const;
+
+  /*! Get a fingerprint of the content of the subtree starting at \a this
+   *
+   * The fingerprint is a 64 bit hash of the canonical content of the
+   * subtree, computed without serialization: element names, attributes
+   * independent of their order and text, where adjacent text, CDATA and
+   * entity reference nodes count as one text (with the replacement text
+   * of the entities). Names are qualified by their namespace URI, not by
+   * the prefix. Comments and processing instructions are ignored. Subtrees with equal content have equal fingerprints, so
+   * different fingerprints prove a change. The values are not stable
+   * across platforms and library versions and should not be persisted.
+   *
+   * If the document has a fingerprint cache, the results for all
+   * visited elements are memoized (see tDocument::EnableFingerprintCache).
+   *
+   * \returns The fingerprint of this subtree
+   */
+  uint64_t Fingerprint() const;
+
+  /*! Compare the content of two subtrees
+   *
+   * The content is compared by the same rules that Fingerprint uses.
+   * If both documents have a fingerprint cache, the (usually memoized)
+   * fingerprints are compared first, so differing subtrees are detected
+   * without visiting them. Subtrees with equal fingerprints are compared
+   * node by node to rule out hash collisions.
+   *
+   * \param other   The root of the other subtree
+   *
+   * \returns Whether both subtrees have the same content
+   */
+  bool DeepEquals(const tNode &other) const;
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
@@ -849,6 +1633,64 @@ private:
 
   void SetStringAttribute(const std::string &name, const std::string &value, bool create);
 
+  const xmlAttr &GetAttribute(const std::string &name) const;
+
+  void DumpToOutputBuffer(xmlOutputWriteCallback write_callback, void *context, bool format) const;
+
+  internal::tAttributeCache *AttributeCache() const;
+
+  void ReleaseCaches();
+
+  void ContentModified();
+
+  internal::tArena *Arena() const;
+
+  bool RequiresCopyToMove(const tNode &node) const;
+
+  void AdoptSubtree(xmlDocPtr document, xmlNodePtr parent);
+
+  const std::vector<tNode *> &ChildIndex() const;
+
+  static inline const xmlNode *FirstElement(const xmlNode *node)
+  {
+    while (node && node->type != XML_ELEMENT_NODE)
+    {
+      node = node->next;
+    }
+    return node;
+  }
+
+  void InvalidateChildIndex();
+
+  template <typename TValue>
+  bool LookupCachedAttribute(const std::string &name, int base, TValue &value) const;
+
+  template <typename TValue>
+  void StoreCachedAttribute(const std::string &name, int base, TValue value) const;
+
+  template <typename TValue, typename TConvert>
+  inline TValue GetCachedAttribute(const std::string &name, int base, TConvert convert) const
+  {
+    TValue value;
+    if (this->_private && this->LookupCachedAttribute(name, base, value))
+    {
+      return value;
+    }
+    value = convert();
+    if (this->_private)
+    {
+      this->StoreCachedAttribute(name, base, value);
+    }
+    return value;
+  }
+
+  template <typename TNumber>
+  static void ParseNumericArray(const char *text, std::vector<TNumber> &values)
+  {
+    values.resize(internal::CountNumericArrayElements(text, std::strlen(text)));
+    values.resize(internal::ParseNumericArray(text, values.data(), values.size()));
+  }
+
 };
 
 //----------------------------------------------------------------------
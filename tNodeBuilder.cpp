@@ -0,0 +1,267 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tNodeBuilder.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/tNodeBuilder.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstring>
+
+extern "C"
+{
+#include <libxml/globals.h>
+#include <libxml/parserInternals.h>
+}
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/arena.h"
+#include "rrlib/xml/tException.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// tNodeBuilder constructors
+//----------------------------------------------------------------------
+tNodeBuilder::tNodeBuilder(tNode &parent)
+  : parent(parent),
+    arena(parent.Arena()),
+    register_node(xmlRegisterNodeDefaultValue),
+    element(0),
+    last_attribute(0)
+{
+  if (!parent.doc || !parent.doc->_private)
+  {
+    throw tException("Cannot build children of a node without document!");
+  }
+}
+
+//----------------------------------------------------------------------
+// tNodeBuilder Intern
+//----------------------------------------------------------------------
+tNodeBuilder::tName tNodeBuilder::Intern(const std::string &name)
+{
+  internal::tArenaScope arena_scope(this->arena);
+  xmlDocPtr document = this->parent.doc;
+  if (!document->dict)
+  {
+    // Names of existing nodes are not owned by the new dictionary and are still freed individually
+    document->dict = xmlDictCreate();
+    if (!document->dict)
+    {
+      throw tException("Could not create dictionary for interning names!");
+    }
+  }
+  const xmlChar *result = xmlDictLookup(document->dict, reinterpret_cast<const xmlChar *>(name.data()), name.size());
+  if (!result)
+  {
+    throw tException("Could not intern name `" + name + "'!");
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------
+// tNodeBuilder AddChild
+//----------------------------------------------------------------------
+tNode &tNodeBuilder::AddChild(tName name, const char *text, size_t length)
+{
+  assert(this->parent.doc->dict && xmlDictOwns(this->parent.doc->dict, name) == 1);
+  internal::tArenaScope arena_scope(this->arena);
+  xmlNodePtr element = this->CreateNode(XML_ELEMENT_NODE, name, &this->parent);
+  if (length)
+  {
+    try
+    {
+      xmlNodePtr text_node = this->CreateText(text, length, element);
+      element->children = text_node;
+      element->last = text_node;
+    }
+    catch (...)
+    {
+      xmlFree(element);
+      throw;
+    }
+  }
+
+  element->prev = this->parent.last;
+  if (this->parent.last)
+  {
+    this->parent.last->next = element;
+  }
+  else
+  {
+    this->parent.children = element;
+  }
+  this->parent.last = element;
+  this->element = element;
+  this->last_attribute = 0;
+
+  if (this->register_node)
+  {
+    this->register_node(element);
+  }
+  this->parent.ContentModified();
+  this->parent.InvalidateChildIndex();
+  return *reinterpret_cast<tNode *>(element);
+}
+
+//----------------------------------------------------------------------
+// tNodeBuilder Attribute
+//----------------------------------------------------------------------
+void tNodeBuilder::Attribute(tName name, const char *value, size_t length)
+{
+  if (!this->element)
+  {
+    throw tException("Cannot add attribute before the first element!");
+  }
+  assert(xmlDictOwns(this->parent.doc->dict, name) == 1);
+  internal::tArenaScope arena_scope(this->arena);
+  xmlAttrPtr attribute = reinterpret_cast<xmlAttrPtr>(xmlMalloc(sizeof(xmlAttr)));
+  if (!attribute)
+  {
+    throw tException("Could not allocate memory for attribute!");
+  }
+  std::memset(attribute, 0, sizeof(xmlAttr));
+  attribute->type = XML_ATTRIBUTE_NODE;
+  attribute->name = name;
+  attribute->parent = this->element;
+  attribute->doc = this->parent.doc;
+  try
+  {
+    xmlNodePtr text_node = this->CreateText(value, length, reinterpret_cast<xmlNodePtr>(attribute));
+    attribute->children = text_node;
+    attribute->last = text_node;
+  }
+  catch (...)
+  {
+    xmlFree(attribute);
+    throw;
+  }
+
+  // Attributes of the element are only created here, so the last one is known without walking the list
+  attribute->prev = this->last_attribute;
+  if (this->last_attribute)
+  {
+    this->last_attribute->next = attribute;
+  }
+  else
+  {
+    this->element->properties = attribute;
+  }
+  this->last_attribute = attribute;
+
+  if (this->register_node)
+  {
+    this->register_node(reinterpret_cast<xmlNodePtr>(attribute));
+  }
+  reinterpret_cast<tNode *>(this->element)->ContentModified();
+}
+
+//----------------------------------------------------------------------
+// tNodeBuilder CreateNode
+//----------------------------------------------------------------------
+xmlNodePtr tNodeBuilder::CreateNode(xmlElementType type, const xmlChar *name, xmlNodePtr parent)
+{
+  xmlNodePtr node = reinterpret_cast<xmlNodePtr>(xmlMalloc(sizeof(xmlNode)));
+  if (!node)
+  {
+    throw tException("Could not allocate memory for node!");
+  }
+  std::memset(node, 0, sizeof(xmlNode));
+  node->type = type;
+  node->name = name;
+  node->parent = parent;
+  node->doc = this->parent.doc;
+  return node;
+}
+
+//----------------------------------------------------------------------
+// tNodeBuilder CreateText
+//----------------------------------------------------------------------
+xmlNodePtr tNodeBuilder::CreateText(const char *text, size_t length, xmlNodePtr parent)
+{
+  xmlChar *content = reinterpret_cast<xmlChar *>(xmlMallocAtomic(length + 1));
+  if (!content)
+  {
+    throw tException("Could not allocate memory for text!");
+  }
+  std::memcpy(content, text, length);
+  content[length] = 0;
+  xmlNodePtr node = 0;
+  try
+  {
+    node = this->CreateNode(XML_TEXT_NODE, xmlStringText, parent);
+  }
+  catch (...)
+  {
+    xmlFree(content);
+    throw;
+  }
+  node->content = content;
+  if (this->register_node)
+  {
+    this->register_node(node);
+  }
+  return node;
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
@@ -0,0 +1,228 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tNodeBuilder.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tNodeBuilder
+ *
+ * \b tNodeBuilder
+ *
+ * Appends large numbers of child elements to a node with less work per
+ * element than tNode::AddChildNode: names are interned once in the
+ * dictionary of the document and shared by all nodes, text is stored
+ * literally without parsing entity references and attributes are
+ * appended to the new element without looking for existing ones.
+ *
+ * \code
+ * tNodeBuilder builder(root_node);
+ * const tNodeBuilder::tName sample = builder.Intern("sample");
+ * const tNodeBuilder::tName time = builder.Intern("time");
+ * for (size_t i = 0; i < samples.size(); ++i)
+ * {
+ *   builder.AddChild(sample, samples[i].label);
+ *   builder.Attribute(time, samples[i].time);
+ * }
+ * \endcode
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tNodeBuilder_h__
+#define __rrlib__xml__tNodeBuilder_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <string>
+#include <type_traits>
+
+#include "rrlib/util/tNoncopyable.h"
+
+extern "C"
+{
+#include <libxml/tree.h>
+}
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/numeric_arrays.h"
+#include "rrlib/xml/tNode.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Fast construction of child elements
+/*! New elements are appended after the current last child of the
+ *  parent. Attributes are added to the element created last. As they
+ *  are not checked against existing attributes, each name must only be
+ *  used once per element. Attributes are not registered as IDs.
+ *
+ *  The names are owned by the dictionary of the document, which is
+ *  created if the document does not have one yet. They remain valid as
+ *  long as the document exists.
+ *
+ */
+class tNodeBuilder : public util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! A name interned in the dictionary of a document */
+  typedef const xmlChar *tName;
+
+  /*! Create a builder for the children of a node
+   *
+   * \exception tException is thrown if \a parent does not belong to a tDocument
+   *
+   * \param parent   The node new children are added to
+   */
+  explicit tNodeBuilder(tNode &parent);
+
+  /*! Intern a name for use with this builder and all other builders of the same document
+   *
+   * \exception tException is thrown if the name cannot be interned
+   *
+   * \param name   The element or attribute name
+   */
+  tName Intern(const std::string &name);
+
+  /*! Append a child element
+   *
+   * \exception tException is thrown if memory cannot be allocated
+   *
+   * \param name   The interned name of the element
+   *
+   * \returns A reference to the new element
+   */
+  inline tNode &AddChild(tName name)
+  {
+    return this->AddChild(name, 0, 0);
+  }
+
+  /*! Append a child element with text content
+   *
+   * The text is stored as it is. Unlike tNode::AddChildNode, character
+   * and entity references like &amp; are not resolved.
+   *
+   * \exception tException is thrown if memory cannot be allocated
+   *
+   * \param name     The interned name of the element
+   * \param text     The text content (no text node is added if it is empty)
+   * \param length   The length of \a text
+   *
+   * \returns A reference to the new element
+   */
+  tNode &AddChild(tName name, const char *text, size_t length);
+
+  inline tNode &AddChild(tName name, const std::string &text)
+  {
+    return this->AddChild(name, text.data(), text.size());
+  }
+
+  /*! Add an attribute to the element created last
+   *
+   * \exception tException is thrown if no element was created yet or memory cannot be allocated
+   *
+   * \param name     The interned name of the attribute
+   * \param value    The value of the attribute (it is stored as it is)
+   * \param length   The length of \a value
+   */
+  void Attribute(tName name, const char *value, size_t length);
+
+  inline void Attribute(tName name, const std::string &value)
+  {
+    this->Attribute(name, value.data(), value.size());
+  }
+
+  inline void Attribute(tName name, const char *value)
+  {
+    this->Attribute(name, value, std::char_traits<char>::length(value));
+  }
+
+  inline void Attribute(tName name, bool value)
+  {
+    this->Attribute(name, value ? "true" : "false", value ? 4 : 5);
+  }
+
+  /*! Add a numeric attribute to the element created last
+   *
+   * Floating point numbers are written with full precision like
+   * tWriter::Attribute does.
+   *
+   * \exception tException is thrown if no element was created yet or memory cannot be allocated
+   *
+   * \param name    The interned name of the attribute
+   * \param value   The value of the attribute
+   */
+  template <typename TNumber>
+  inline typename std::enable_if<std::is_arithmetic<TNumber>::value>::type Attribute(tName name, TNumber value)
+  {
+    char buffer[internal::cMAX_FORMATTED_NUMBER_LENGTH];
+    this->Attribute(name, buffer, internal::FormatNumber(buffer, sizeof(buffer), value));
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  tNode &parent;
+  internal::tArena *arena;
+  xmlRegisterNodeFunc register_node;
+  xmlNodePtr element;
+  xmlAttrPtr last_attribute;
+
+  xmlNodePtr CreateNode(xmlElementType type, const xmlChar *name, xmlNodePtr parent);
+
+  xmlNodePtr CreateText(const char *text, size_t length, xmlNodePtr parent);
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+#endif
@@ -0,0 +1,531 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tStructBinding.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tStructBinding
+ *
+ * \b tStructBinding
+ *
+ * A declarative description of how the fields of a C++ struct map to
+ * attributes and children of an XML node. Loading walks the node's
+ * attribute list and its children exactly once and dispatches each
+ * entry to the matching field. The mapping is part of the binding's
+ * type, so the dispatch is resolved at compile time and no strings
+ * are allocated for field names.
+ *
+ * \code
+ * struct tConfig { double gain; int cycles; std::string mode; };
+ *
+ * static const auto cCONFIG_BINDING = CreateStructBinding(BindAttribute("gain", &tConfig::gain, 1.0),
+ *                                                         BindAttribute("cycles", &tConfig::cycles),
+ *                                                         BindChild("mode", &tConfig::mode, std::string("auto")));
+ * tConfig config;
+ * cCONFIG_BINDING.Load(node, config);
+ * cCONFIG_BINDING.Save(config, other_node);
+ * \endcode
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tStructBinding_h__
+#define __rrlib__xml__tStructBinding_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+extern "C"
+{
+#include <libxml/tree.h>
+}
+
+#include <string>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tNode.h"
+#include "rrlib/xml/tException.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+namespace internal
+{
+
+template <typename TValue>
+inline std::string FormatStreamed(const TValue &value)
+{
+  std::stringstream converted_value;
+  converted_value << value;
+  return converted_value.str();
+}
+
+//! Conversion between the raw bytes of an XML value and a bound field
+template <typename TValue, typename TEnable = void>
+struct tBindingValue
+{
+  static bool Parse(const char *text, TValue &value)
+  {
+    std::istringstream stream(text);
+    stream >> value;
+    return !stream.fail() && stream.eof();
+  }
+  static std::string Format(const TValue &value)
+  {
+    return FormatStreamed(value);
+  }
+};
+
+template <>
+struct tBindingValue<std::string>
+{
+  static bool Parse(const char *text, std::string &value)
+  {
+    value.assign(text);
+    return true;
+  }
+  static const std::string &Format(const std::string &value)
+  {
+    return value;
+  }
+};
+
+template <>
+struct tBindingValue<bool>
+{
+  static bool Parse(const char *text, bool &value)
+  {
+    if (std::strcmp(text, "true") == 0)
+    {
+      value = true;
+      return true;
+    }
+    if (std::strcmp(text, "false") == 0)
+    {
+      value = false;
+      return true;
+    }
+    return false;
+  }
+  static std::string Format(bool value)
+  {
+    return value ? "true" : "false";
+  }
+};
+
+template <typename TValue>
+struct tBindingValue<TValue, typename std::enable_if < std::is_integral<TValue>::value && !std::is_same<TValue, bool>::value >::type>
+{
+  static bool Parse(const char *text, TValue &value)
+  {
+    errno = 0;
+    char *endptr;
+    if (std::is_signed<TValue>::value)
+    {
+      long long int result = std::strtoll(text, &endptr, 10);
+      value = static_cast<TValue>(result);
+      return !errno && !*endptr && endptr != text && static_cast<long long int>(value) == result;
+    }
+    // strtoull accepts a sign and negates the result, which would turn "-1" into the maximum value
+    if (std::strchr(text, '-'))
+    {
+      return false;
+    }
+    unsigned long long int result = std::strtoull(text, &endptr, 10);
+    value = static_cast<TValue>(result);
+    return !errno && !*endptr && endptr != text && static_cast<unsigned long long int>(value) == result;
+  }
+  static std::string Format(TValue value)
+  {
+    return FormatStreamed(value);
+  }
+};
+
+inline void ParseFloatingPoint(const char *text, char **endptr, float &value)
+{
+  value = std::strtof(text, endptr);
+}
+inline void ParseFloatingPoint(const char *text, char **endptr, double &value)
+{
+  value = std::strtod(text, endptr);
+}
+inline void ParseFloatingPoint(const char *text, char **endptr, long double &value)
+{
+  value = std::strtold(text, endptr);
+}
+
+template <typename TValue>
+struct tBindingValue<TValue, typename std::enable_if<std::is_floating_point<TValue>::value>::type>
+{
+  static bool Parse(const char *text, TValue &value)
+  {
+    errno = 0;
+    char *endptr;
+    ParseFloatingPoint(text, &endptr, value);
+    // Overflow yields infinity and is rejected, while underflow yields the nearest representable value
+    return !(errno == ERANGE && std::isinf(value)) && !*endptr && endptr != text;
+  }
+  static std::string Format(TValue value)
+  {
+    return FormatStreamed(value);
+  }
+};
+
+template <typename TValue>
+struct tBindingValue<TValue, typename std::enable_if<std::is_enum<TValue>::value>::type>
+{
+  static bool Parse(const char *text, TValue &value)
+  {
+    try
+    {
+      value = make_builder::GetEnumValueFromString<TValue>(text, make_builder::tEnumStringsFormat::LOWER);
+    }
+    catch (const std::runtime_error &)
+    {
+      return false;
+    }
+    return true;
+  }
+  static std::string Format(TValue value)
+  {
+    return make_builder::GetEnumString(value, make_builder::tEnumStringsFormat::LOWER);
+  }
+};
+
+//! Compile-time iteration over the fields of a binding
+template <size_t Index, size_t Count>
+struct tBindingDispatch
+{
+  template <typename TFields, typename TStruct>
+  static inline bool LoadAttribute(const TFields &fields, const char *name, const char *value, TStruct &object, bool *assigned)
+  {
+    typedef typename std::tuple_element<Index, TFields>::type tField;
+    if (!tField::cIS_ATTRIBUTE || assigned[Index] || std::strcmp(std::get<Index>(fields).Name(), name) != 0)
+    {
+      return tBindingDispatch < Index + 1, Count >::LoadAttribute(fields, name, value, object, assigned);
+    }
+    std::get<Index>(fields).Load(value, object);
+    return assigned[Index] = true;
+  }
+
+  template <typename TFields, typename TStruct>
+  static inline bool LoadChild(const TFields &fields, const char *name, const tNode &child, TStruct &object, bool *assigned)
+  {
+    typedef typename std::tuple_element<Index, TFields>::type tField;
+    if (tField::cIS_ATTRIBUTE || assigned[Index] || std::strcmp(std::get<Index>(fields).Name(), name) != 0)
+    {
+      return tBindingDispatch < Index + 1, Count >::LoadChild(fields, name, child, object, assigned);
+    }
+    internal::tRawValue value(reinterpret_cast<const xmlNode *>(&child));
+    std::get<Index>(fields).Load(value.Get(), object);
+    return assigned[Index] = true;
+  }
+
+  template <typename TFields, typename TStruct>
+  static inline void LoadDefaults(const TFields &fields, const tNode &node, TStruct &object, const bool *assigned)
+  {
+    if (!assigned[Index])
+    {
+      std::get<Index>(fields).LoadDefault(node, object);
+    }
+    tBindingDispatch < Index + 1, Count >::LoadDefaults(fields, node, object, assigned);
+  }
+
+  template <typename TFields, typename TStruct>
+  static inline void Save(const TFields &fields, const TStruct &object, tNode &node)
+  {
+    std::get<Index>(fields).Save(object, node);
+    tBindingDispatch < Index + 1, Count >::Save(fields, object, node);
+  }
+};
+
+template <size_t Count>
+struct tBindingDispatch<Count, Count>
+{
+  template <typename TFields, typename TStruct>
+  static inline bool LoadAttribute(const TFields &, const char *, const char *, TStruct &, bool *)
+  {
+    return false;
+  }
+  template <typename TFields, typename TStruct>
+  static inline bool LoadChild(const TFields &, const char *, const tNode &, TStruct &, bool *)
+  {
+    return false;
+  }
+  template <typename TFields, typename TStruct>
+  static inline void LoadDefaults(const TFields &, const tNode &, TStruct &, const bool *)
+  {}
+  template <typename TFields, typename TStruct>
+  static inline void Save(const TFields &, const TStruct &, tNode &)
+  {}
+};
+
+}
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Binding of a single struct field to an attribute or child of an XML node
+/*! Instances are created using BindAttribute or BindChild and then
+ *  combined into a tStructBinding. The name must outlive the binding,
+ *  which is naturally the case for string literals.
+ *
+ */
+template <typename TStruct, typename TValue, bool IS_ATTRIBUTE>
+class tFieldBinding
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  typedef TStruct tStruct;
+
+  static const bool cIS_ATTRIBUTE = IS_ATTRIBUTE;
+
+  /*! The ctor of tFieldBinding
+   *
+   * \param name            The name of the attribute or child
+   * \param member          Pointer to the bound member of \a TStruct
+   * \param default_value   The value to use if the attribute or child is missing
+   * \param has_default     Whether \a default_value is valid or missing entries are errors
+   */
+  tFieldBinding(const char *name, TValue TStruct::*member, const TValue &default_value, bool has_default)
+    : name(name), member(member), default_value(default_value), has_default(has_default)
+  {}
+
+  inline const char *Name() const
+  {
+    return this->name;
+  }
+
+  void Load(const char *text, TStruct &object) const
+  {
+    if (!internal::tBindingValue<TValue>::Parse(text, object.*this->member))
+    {
+      throw tException("Invalid value for " + std::string(IS_ATTRIBUTE ? "attribute" : "child") + " `" + this->name + "': `" + text + "'");
+    }
+  }
+
+  void LoadDefault(const tNode &node, TStruct &object) const
+  {
+    if (!this->has_default)
+    {
+      throw tException("Node `" + node.Name() + "' has no " + (IS_ATTRIBUTE ? "attribute" : "child") + " `" + this->name + "'!");
+    }
+    object.*this->member = this->default_value;
+  }
+
+  void Save(const TStruct &object, tNode &node) const
+  {
+    if (IS_ATTRIBUTE)
+    {
+      node.SetAttribute(this->name, internal::tBindingValue<TValue>::Format(object.*this->member));
+      return;
+    }
+    for (auto it = node.ChildrenBegin(); it != node.ChildrenEnd(); ++it)
+    {
+      if (xmlStrEqual(reinterpret_cast<const xmlNode &>(*it).name, reinterpret_cast<const xmlChar *>(this->name)))
+      {
+        it->SetContent(internal::tBindingValue<TValue>::Format(object.*this->member));
+        return;
+      }
+    }
+    node.AddChildNode(this->name, internal::tBindingValue<TValue>::Format(object.*this->member));
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  const char *name;
+  TValue TStruct::*member;
+  TValue default_value;
+  bool has_default;
+
+};
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Mapping between the fields of a struct and the content of an XML node
+/*! A tStructBinding combines several field bindings into a description
+ *  of the complete struct. Loading visits every attribute and every
+ *  child of the given node once, assigns the matching fields and
+ *  finally falls back to the default values of fields that were not
+ *  found. Saving writes each field as attribute or child text.
+ *
+ */
+template <typename TStruct, typename ... TFields>
+class tStructBinding
+{
+  typedef std::tuple<TFields...> tFields;
+  typedef internal::tBindingDispatch<0, sizeof...(TFields)> tDispatch;
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  explicit tStructBinding(const TFields &... fields)
+    : fields(fields...)
+  {}
+
+  /*! Load a struct from the attributes and children of a node
+   *
+   * Unknown attributes and children are ignored. If the same child
+   * occurs multiple times, only the first one is used.
+   *
+   * \exception tException is thrown if a value cannot be converted or a field without default value is missing
+   *
+   * \param node     The node to read from
+   * \param object   The struct to fill
+   */
+  void Load(const tNode &node, TStruct &object) const
+  {
+    bool assigned[sizeof...(TFields) + 1] = { false };
+    for (const xmlAttr *attribute = node.GetAttributeList(); attribute; attribute = attribute->next)
+    {
+      internal::tRawValue value(attribute);
+      tDispatch::LoadAttribute(this->fields, reinterpret_cast<const char *>(attribute->name), value.Get(), object, assigned);
+    }
+    for (auto it = node.ChildrenBegin(); it != node.ChildrenEnd(); ++it)
+    {
+      tDispatch::LoadChild(this->fields, reinterpret_cast<const char *>(reinterpret_cast<const xmlNode &>(*it).name), *it, object, assigned);
+    }
+    tDispatch::LoadDefaults(this->fields, node, object, assigned);
+  }
+
+  /*! Save a struct into the attributes and children of a node
+   *
+   * Attributes are set or created. Child fields update the text of
+   * the first child with the bound name or create a new child.
+   *
+   * \param object   The struct to write
+   * \param node     The node to write to
+   */
+  void Save(const TStruct &object, tNode &node) const
+  {
+    tDispatch::Save(this->fields, object, node);
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  tFields fields;
+
+};
+
+//----------------------------------------------------------------------
+// Function declaration
+//----------------------------------------------------------------------
+
+/*! Bind a struct member to a mandatory attribute
+ *
+ * \param name     The name of the attribute
+ * \param member   Pointer to the bound member
+ */
+template <typename TStruct, typename TValue>
+inline tFieldBinding<TStruct, TValue, true> BindAttribute(const char *name, TValue TStruct::*member)
+{
+  return tFieldBinding<TStruct, TValue, true>(name, member, TValue(), false);
+}
+
+/*! Bind a struct member to an optional attribute
+ *
+ * \param name            The name of the attribute
+ * \param member          Pointer to the bound member
+ * \param default_value   The value used if the attribute is missing
+ */
+template <typename TStruct, typename TValue, typename TDefault>
+inline tFieldBinding<TStruct, TValue, true> BindAttribute(const char *name, TValue TStruct::*member, const TDefault &default_value)
+{
+  return tFieldBinding<TStruct, TValue, true>(name, member, default_value, true);
+}
+
+/*! Bind a struct member to the text content of a mandatory child
+ *
+ * \param name     The name of the child
+ * \param member   Pointer to the bound member
+ */
+template <typename TStruct, typename TValue>
+inline tFieldBinding<TStruct, TValue, false> BindChild(const char *name, TValue TStruct::*member)
+{
+  return tFieldBinding<TStruct, TValue, false>(name, member, TValue(), false);
+}
+
+/*! Bind a struct member to the text content of an optional child
+ *
+ * \param name            The name of the child
+ * \param member          Pointer to the bound member
+ * \param default_value   The value used if the child is missing
+ */
+template <typename TStruct, typename TValue, typename TDefault>
+inline tFieldBinding<TStruct, TValue, false> BindChild(const char *name, TValue TStruct::*member, const TDefault &default_value)
+{
+  return tFieldBinding<TStruct, TValue, false>(name, member, default_value, true);
+}
+
+/*! Combine field bindings into the binding of a complete struct
+ *
+ * \param fields   The field bindings created by BindAttribute and BindChild
+ */
+template <typename TField, typename ... TFields>
+inline tStructBinding<typename TField::tStruct, TField, TFields...> CreateStructBinding(const TField &field, const TFields &... fields)
+{
+  return tStructBinding<typename TField::tStruct, TField, TFields...>(field, fields...);
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+#endif
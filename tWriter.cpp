@@ -0,0 +1,619 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tWriter.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/xml/tWriter.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include <libxml/parserInternals.h>
+}
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/tException.h"
+#include "rrlib/xml/escape.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+namespace
+{
+
+const size_t cBUFFER_SIZE = 64 << 10;
+
+// Same limit as libxml2's indentation string (60 characters)
+const size_t cMAX_INDENTATION_LEVEL = 30;
+const char cINDENTATION[] = "                                                            ";
+
+const char cXML_DECLARATION[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+}
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+void WriteToFileDescriptor(int file_descriptor, const char *data, size_t size)
+{
+  while (size > 0)
+  {
+    const ssize_t result = write(file_descriptor, data, size);
+    if (result < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw tException("Could not write XML output!");
+    }
+    data += result;
+    size -= result;
+  }
+}
+
+inline size_t Length(const xmlChar *text)
+{
+  return std::char_traits<char>::length(reinterpret_cast<const char *>(text));
+}
+
+inline bool IsTextNode(const xmlNode *node)
+{
+  return node->type == XML_TEXT_NODE || node->type == XML_CDATA_SECTION_NODE || node->type == XML_ENTITY_REF_NODE;
+}
+
+}
+
+//----------------------------------------------------------------------
+// tWriter constructors
+//----------------------------------------------------------------------
+tWriter::tWriter(const std::string &file_name)
+  : file_descriptor(open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666))
+{
+  if (this->file_descriptor < 0)
+  {
+    throw tException("Could not open file `" + file_name + "' for writing!");
+  }
+  const int file_descriptor = this->file_descriptor;
+  this->sink = [file_descriptor](const char *data, size_t size)
+  {
+    WriteToFileDescriptor(file_descriptor, data, size);
+  };
+  this->Initialize();
+}
+
+tWriter::tWriter(int file_descriptor)
+  : file_descriptor(-1)
+{
+  this->sink = [file_descriptor](const char *data, size_t size)
+  {
+    WriteToFileDescriptor(file_descriptor, data, size);
+  };
+  this->Initialize();
+}
+
+tWriter::tWriter(std::string *output)
+  : file_descriptor(-1)
+{
+  this->sink = [output](const char *data, size_t size)
+  {
+    output->append(data, size);
+  };
+  this->Initialize();
+}
+
+tWriter::tWriter(const std::function<void(const char *data, size_t size)> &sink)
+  : sink(sink),
+    file_descriptor(-1)
+{
+  this->Initialize();
+}
+
+//----------------------------------------------------------------------
+// tWriter destructor
+//----------------------------------------------------------------------
+tWriter::~tWriter()
+{
+  try
+  {
+    this->Close();
+  }
+  catch (...)
+  {}
+  if (this->file_descriptor >= 0)
+  {
+    close(this->file_descriptor);
+  }
+}
+
+//----------------------------------------------------------------------
+// tWriter Initialize
+//----------------------------------------------------------------------
+void tWriter::Initialize()
+{
+  this->closed = false;
+  this->root_finished = false;
+  this->buffer.resize(cBUFFER_SIZE);
+  this->buffer_fill = 0;
+  this->Write(cXML_DECLARATION, sizeof(cXML_DECLARATION) - 1);
+}
+
+//----------------------------------------------------------------------
+// tWriter StartElement
+//----------------------------------------------------------------------
+void tWriter::StartElement(const std::string &name)
+{
+  if (this->closed || this->root_finished)
+  {
+    throw tException("Cannot add element `" + name + "' after the root element!");
+  }
+  bool formatted = true;
+  if (!this->open_elements.empty())
+  {
+    tElement &parent = this->open_elements.back();
+    if (parent.start_tag_open)
+    {
+      this->CloseStartTag(parent.formatted);
+    }
+    formatted = parent.formatted;
+    if (formatted)
+    {
+      this->WriteIndentation(this->open_elements.size());
+    }
+  }
+
+  this->Write("<", 1);
+  this->Write(name.data(), name.size());
+
+  tElement element = { this->element_names.size(), true, formatted };
+  this->element_names.append(name);
+  this->open_elements.push_back(element);
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteAttribute
+//----------------------------------------------------------------------
+void tWriter::WriteAttribute(const std::string &name, const char *value, size_t length)
+{
+  if (this->open_elements.empty() || !this->open_elements.back().start_tag_open)
+  {
+    throw tException("Cannot add attribute `" + name + "' after the content of an element!");
+  }
+  this->Write(" ", 1);
+  this->Write(name.data(), name.size());
+  this->Write("=\"", 2);
+  this->WriteEscaped(value, length, true);
+  this->Write("\"", 1);
+}
+
+//----------------------------------------------------------------------
+// tWriter Text
+//----------------------------------------------------------------------
+void tWriter::Text(const std::string &text)
+{
+  if (this->open_elements.empty())
+  {
+    throw tException("Cannot add text outside of an element!");
+  }
+  tElement &element = this->open_elements.back();
+  if (element.start_tag_open)
+  {
+    element.formatted = false;
+    this->CloseStartTag(false);
+  }
+  else if (element.formatted)
+  {
+    throw tException("Cannot add text after child elements that were formatted already!");
+  }
+  this->WriteEscaped(text.data(), text.size(), false);
+}
+
+//----------------------------------------------------------------------
+// tWriter EndElement
+//----------------------------------------------------------------------
+void tWriter::EndElement()
+{
+  if (this->open_elements.empty())
+  {
+    throw tException("No element to end!");
+  }
+  const tElement element = this->open_elements.back();
+  this->open_elements.pop_back();
+  if (element.start_tag_open)
+  {
+    this->Write("/>", 2);
+  }
+  else
+  {
+    if (element.formatted)
+    {
+      this->WriteIndentation(this->open_elements.size());
+    }
+    this->Write("</", 2);
+    this->Write(this->element_names.data() + element.name_offset, this->element_names.size() - element.name_offset);
+    this->Write(">", 1);
+  }
+  this->element_names.resize(element.name_offset);
+
+  if (this->open_elements.empty())
+  {
+    this->root_finished = true;
+    this->Write("\n", 1);
+  }
+  else if (this->open_elements.back().formatted)
+  {
+    this->Write("\n", 1);
+  }
+}
+
+//----------------------------------------------------------------------
+// tWriter Close
+//----------------------------------------------------------------------
+void tWriter::Close()
+{
+  if (this->closed)
+  {
+    return;
+  }
+  while (!this->open_elements.empty())
+  {
+    this->EndElement();
+  }
+  this->closed = true;
+  this->Flush();
+  if (this->file_descriptor >= 0)
+  {
+    const int file_descriptor = this->file_descriptor;
+    this->file_descriptor = -1;
+    if (close(file_descriptor) != 0)
+    {
+      throw tException("Could not write XML output!");
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// tWriter CloseStartTag
+//----------------------------------------------------------------------
+void tWriter::CloseStartTag(bool formatted_children)
+{
+  this->open_elements.back().start_tag_open = false;
+  this->Write(formatted_children ? ">\n" : ">", formatted_children ? 2 : 1);
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteIndentation
+//----------------------------------------------------------------------
+void tWriter::WriteIndentation(size_t level)
+{
+  this->Write(cINDENTATION, 2 * std::min(level, cMAX_INDENTATION_LEVEL));
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteEscaped
+//----------------------------------------------------------------------
+void tWriter::WriteEscaped(const char *text, size_t length, bool attribute)
+{
+  // Pieces are small enough to fit into the buffer even if every character is escaped
+  const size_t piece_size = this->buffer.size() / internal::cMAX_ESCAPED_CHARACTER_LENGTH;
+  while (length > 0)
+  {
+    const size_t piece = std::min(length, piece_size);
+    if (this->buffer.size() - this->buffer_fill < piece * internal::cMAX_ESCAPED_CHARACTER_LENGTH)
+    {
+      this->Flush();
+    }
+    this->buffer_fill += internal::EscapeText(text, piece, attribute, this->buffer.data() + this->buffer_fill);
+    text += piece;
+    length -= piece;
+  }
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteSubtree
+//----------------------------------------------------------------------
+void tWriter::WriteSubtree(const tNode &node)
+{
+  const xmlNode *element = reinterpret_cast<const xmlNode *>(&node);
+  if (element->type != XML_ELEMENT_NODE)
+  {
+    throw tException("Only element nodes can be written as subtree!");
+  }
+  this->WriteElementNode(element);
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteElementNode
+//----------------------------------------------------------------------
+void tWriter::WriteElementNode(const xmlNode *node)
+{
+  this->qualified_name.clear();
+  if (node->ns && node->ns->prefix)
+  {
+    this->qualified_name.append(reinterpret_cast<const char *>(node->ns->prefix)).append(1, ':');
+  }
+  this->qualified_name.append(reinterpret_cast<const char *>(node->name));
+  this->StartElement(this->qualified_name);
+
+  for (const xmlNs *ns = node->nsDef; ns; ns = ns->next)
+  {
+    if (ns->type != XML_LOCAL_NAMESPACE || !ns->href || xmlStrEqual(ns->prefix, reinterpret_cast<const xmlChar *>("xml")))
+    {
+      continue;
+    }
+    this->Write(" xmlns", 6);
+    if (ns->prefix)
+    {
+      this->Write(":", 1);
+      this->Write(reinterpret_cast<const char *>(ns->prefix), Length(ns->prefix));
+    }
+    this->Write("=", 1);
+    this->WriteQuoted(reinterpret_cast<const char *>(ns->href));
+  }
+
+  for (const xmlAttr *attribute = node->properties; attribute; attribute = attribute->next)
+  {
+    this->Write(" ", 1);
+    if (attribute->ns && attribute->ns->prefix)
+    {
+      this->Write(reinterpret_cast<const char *>(attribute->ns->prefix), Length(attribute->ns->prefix));
+      this->Write(":", 1);
+    }
+    this->Write(reinterpret_cast<const char *>(attribute->name), Length(attribute->name));
+    this->Write("=\"", 2);
+    for (const xmlNode *child = attribute->children; child; child = child->next)
+    {
+      if (child->type == XML_TEXT_NODE && child->content)
+      {
+        this->WriteEscaped(reinterpret_cast<const char *>(child->content), Length(child->content), true);
+      }
+      else if (child->type == XML_ENTITY_REF_NODE)
+      {
+        this->WriteEntityReference(child);
+      }
+    }
+    this->Write("\"", 1);
+  }
+
+  if (!node->children)
+  {
+    this->EndElement();
+    return;
+  }
+
+  // Like libxml2, do not indent inside elements with text
+  tElement &element = this->open_elements.back();
+  for (const xmlNode *child = node->children; child && element.formatted; child = child->next)
+  {
+    element.formatted = !IsTextNode(child);
+  }
+  const bool formatted = element.formatted;
+  this->CloseStartTag(formatted);
+
+  for (const xmlNode *child = node->children; child; child = child->next)
+  {
+    switch (child->type)
+    {
+    case XML_ELEMENT_NODE:
+      this->WriteElementNode(child);
+      break;
+    case XML_TEXT_NODE:
+      if (child->content)
+      {
+        if (child->name == xmlStringTextNoenc)
+        {
+          this->Write(reinterpret_cast<const char *>(child->content), Length(child->content));
+        }
+        else
+        {
+          this->WriteEscaped(reinterpret_cast<const char *>(child->content), Length(child->content), false);
+        }
+      }
+      break;
+    case XML_CDATA_SECTION_NODE:
+      this->WriteCData(child->content ? reinterpret_cast<const char *>(child->content) : "");
+      break;
+    case XML_ENTITY_REF_NODE:
+      this->WriteEntityReference(child);
+      break;
+    case XML_COMMENT_NODE:
+    case XML_PI_NODE:
+      if (formatted)
+      {
+        this->WriteIndentation(this->open_elements.size());
+      }
+      if (child->type == XML_COMMENT_NODE)
+      {
+        if (child->content)
+        {
+          this->Write("<!--", 4);
+          this->Write(reinterpret_cast<const char *>(child->content), Length(child->content));
+          this->Write("-->", 3);
+        }
+      }
+      else
+      {
+        this->Write("<?", 2);
+        this->Write(reinterpret_cast<const char *>(child->name), Length(child->name));
+        if (child->content)
+        {
+          this->Write(" ", 1);
+          this->Write(reinterpret_cast<const char *>(child->content), Length(child->content));
+        }
+        this->Write("?>", 2);
+      }
+      if (formatted)
+      {
+        this->Write("\n", 1);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  this->EndElement();
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteQuoted
+//----------------------------------------------------------------------
+void tWriter::WriteQuoted(const char *text)
+{
+  // Same quoting as xmlBufWriteQuotedString
+  const size_t length = std::char_traits<char>::length(text);
+  if (!std::char_traits<char>::find(text, length, '"'))
+  {
+    this->Write("\"", 1);
+    this->Write(text, length);
+    this->Write("\"", 1);
+    return;
+  }
+  if (!std::char_traits<char>::find(text, length, '\''))
+  {
+    this->Write("'", 1);
+    this->Write(text, length);
+    this->Write("'", 1);
+    return;
+  }
+  this->Write("\"", 1);
+  for (const char *end = text + length; text != end; ++text)
+  {
+    if (*text == '"')
+    {
+      this->Write("&quot;", 6);
+    }
+    else
+    {
+      this->Write(text, 1);
+    }
+  }
+  this->Write("\"", 1);
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteCData
+//----------------------------------------------------------------------
+void tWriter::WriteCData(const char *text)
+{
+  // Like libxml2, split sections at "]]>" so that the content stays intact
+  const char *start = text;
+  const char *end = text;
+  for (; *end; ++end)
+  {
+    if (end[0] == ']' && end[1] == ']' && end[2] == '>')
+    {
+      end += 2;
+      this->Write("<![CDATA[", 9);
+      this->Write(start, end - start);
+      this->Write("]]>", 3);
+      start = end;
+    }
+  }
+  if (start != end || !*text)
+  {
+    this->Write("<![CDATA[", 9);
+    this->Write(start, end - start);
+    this->Write("]]>", 3);
+  }
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteEntityReference
+//----------------------------------------------------------------------
+void tWriter::WriteEntityReference(const xmlNode *node)
+{
+  this->Write("&", 1);
+  this->Write(reinterpret_cast<const char *>(node->name), Length(node->name));
+  this->Write(";", 1);
+}
+
+//----------------------------------------------------------------------
+// tWriter WriteSlow
+//----------------------------------------------------------------------
+void tWriter::WriteSlow(const char *data, size_t size)
+{
+  this->Flush();
+  if (size >= this->buffer.size())
+  {
+    this->sink(data, size);
+    return;
+  }
+  std::char_traits<char>::copy(this->buffer.data(), data, size);
+  this->buffer_fill = size;
+}
+
+//----------------------------------------------------------------------
+// tWriter Flush
+//----------------------------------------------------------------------
+void tWriter::Flush()
+{
+  if (this->buffer_fill)
+  {
+    const size_t fill = this->buffer_fill;
+    this->buffer_fill = 0;
+    this->sink(this->buffer.data(), fill);
+  }
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
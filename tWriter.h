@@ -0,0 +1,290 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tWriter.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * \brief   Contains tWriter
+ *
+ * \b tWriter
+ *
+ * A streaming emitter for XML documents. Elements, attributes and text
+ * are written in document order into a fixed size buffer that is
+ * flushed to a file, a file descriptor or memory, so generating a
+ * document does not need a DOM tree. The output is identical to what
+ * tDocument::WriteToFile produces for the equivalent tree.
+ *
+ * \code
+ * tWriter writer("export.xml");
+ * writer.StartElement("samples");
+ * writer.StartElement("sample");
+ * writer.Attribute("time", 0.25);
+ * writer.Text("ok");
+ * writer.EndElement();
+ * writer.EndElement();
+ * writer.Close();
+ * \endcode
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__xml__tWriter_h__
+#define __rrlib__xml__tWriter_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "rrlib/util/tNoncopyable.h"
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/xml/numeric_arrays.h"
+#include "rrlib/xml/tNode.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace xml
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Streaming XML writer
+/*! Writes an XML document incrementally with memory usage bounded by
+ *  the output buffer and the nesting depth. Indentation follows the
+ *  rules of libxml2's formatted output: elements with text content are
+ *  written without indentation inside. As this has to be known when
+ *  the first child is written, text may not follow child elements in
+ *  an element whose first child was an element.
+ *
+ */
+class tWriter : public util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Create a writer for a file
+   *
+   * \exception tException is thrown if the file cannot be opened
+   *
+   * \param file_name   The name of the file to create or truncate
+   */
+  explicit tWriter(const std::string &file_name);
+
+  /*! Create a writer for a file descriptor
+   *
+   * \param file_descriptor   The file descriptor to write to (it is not closed)
+   */
+  explicit tWriter(int file_descriptor);
+
+  /*! Create a writer for memory
+   *
+   * \param output   The string the document is appended to
+   */
+  explicit tWriter(std::string *output);
+
+  /*! Create a writer for a callback
+   *
+   * \param sink   The function that receives the output in chunks
+   */
+  explicit tWriter(const std::function<void(const char *data, size_t size)> &sink);
+
+  /*! The dtor of tWriter
+   *
+   * Closes the document if Close was not called. Errors are ignored.
+   */
+  ~tWriter();
+
+  /*! Start a new element
+   *
+   * \exception tException is thrown if the document already has a finished root element
+   *
+   * \param name   The name of the element
+   */
+  void StartElement(const std::string &name);
+
+  /*! Add an attribute to the element started last
+   *
+   * \exception tException is thrown if content was already added to the current element
+   *
+   * \param name    The name of the attribute
+   * \param value   The value of the attribute
+   */
+  inline void Attribute(const std::string &name, const std::string &value)
+  {
+    this->WriteAttribute(name, value.data(), value.size());
+  }
+
+  inline void Attribute(const std::string &name, const char *value)
+  {
+    this->WriteAttribute(name, value, std::char_traits<char>::length(value));
+  }
+
+  inline void Attribute(const std::string &name, bool value)
+  {
+    this->WriteAttribute(name, value ? "true" : "false", value ? 4 : 5);
+  }
+
+  /*! Add a numeric attribute to the element started last
+   *
+   * Floating point numbers are written with full precision like
+   * tNode::SetNumericArrayAttribute does for a single element.
+   *
+   * \exception tException is thrown if content was already added to the current element
+   *
+   * \param name    The name of the attribute
+   * \param value   The value of the attribute
+   */
+  template <typename TNumber>
+  inline typename std::enable_if<std::is_arithmetic<TNumber>::value>::type Attribute(const std::string &name, TNumber value)
+  {
+    internal::FormatNumericArray(&value, 1, ' ', this->number_buffer);
+    this->WriteAttribute(name, this->number_buffer.data(), this->number_buffer.size());
+  }
+
+  /*! Add text content to the current element
+   *
+   * \exception tException is thrown if no element is open or the current element already contains formatted child elements
+   *
+   * \param text   The text (it is escaped as necessary)
+   */
+  void Text(const std::string &text);
+
+  /*! Write a subtree of a DOM tree
+   *
+   * Writes the element \a node with its attributes, namespace
+   * declarations and content, including comments, processing
+   * instructions, CDATA sections and entity references. The output is
+   * byte-identical to what libxml2 writes for the subtree, so a writer
+   * to which only the root node of a tDocument is passed produces the
+   * same file as tDocument::WriteToFile. Escaped characters are found
+   * with vector instructions and clean runs are copied in bulk.
+   *
+   * \exception tException is thrown if the document already has a finished root element
+   *
+   * \param node   The root of the subtree (an element node)
+   */
+  void WriteSubtree(const tNode &node);
+
+  /*! End the element started last
+   *
+   * \exception tException is thrown if no element is open
+   */
+  void EndElement();
+
+  /*! Finish the document
+   *
+   * Ends all open elements and flushes the output buffer. Closes the
+   * file if the writer was created for a file name.
+   *
+   * \exception tException is thrown if writing the output fails
+   */
+  void Close();
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  struct tElement
+  {
+    size_t name_offset;
+    bool start_tag_open;
+    bool formatted;
+  };
+
+  std::function<void(const char *, size_t)> sink;
+  int file_descriptor;
+  bool closed;
+  bool root_finished;
+
+  std::vector<char> buffer;
+  size_t buffer_fill;
+
+  std::vector<tElement> open_elements;
+  std::string element_names;
+  std::string number_buffer;
+  std::string qualified_name;
+
+  void Initialize();
+
+  void WriteAttribute(const std::string &name, const char *value, size_t length);
+
+  void CloseStartTag(bool formatted_children);
+
+  void WriteIndentation(size_t level);
+
+  void WriteEscaped(const char *text, size_t length, bool attribute);
+
+  void WriteElementNode(const xmlNode *node);
+
+  void WriteQuoted(const char *text);
+
+  void WriteCData(const char *text);
+
+  void WriteEntityReference(const xmlNode *node);
+
+  inline void Write(const char *data, size_t size)
+  {
+    if (this->buffer.size() - this->buffer_fill < size)
+    {
+      this->WriteSlow(data, size);
+      return;
+    }
+    std::char_traits<char>::copy(this->buffer.data() + this->buffer_fill, data, size);
+    this->buffer_fill += size;
+  }
+
+  void WriteSlow(const char *data, size_t size);
+
+  void Flush();
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+#endif
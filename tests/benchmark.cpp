@@ -0,0 +1,912 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/xml/tests/benchmark.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-18
+ *
+ * Throughput measurements for the performance critical parts of this
+ * library. Run without arguments to execute all benchmarks or give
+ * the names of the benchmarks to run.
+ *
+ */
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rrlib/xml/tCompressionCodec.h"
+#include "rrlib/xml/tDocument.h"
+#include "rrlib/xml/tNodeBuilder.h"
+#include "rrlib/xml/tWriter.h"
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+using namespace rrlib::xml;
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+const size_t cNUMERIC_ARRAY_SIZE = 1000000;
+const size_t cBINARY_CONTENT_SIZE = 64 << 20;
+const size_t cWRITER_ELEMENTS = 1000000;
+const size_t cCOMPRESSION_ENTRIES = 200000;
+const size_t cPARALLEL_ENTRIES = 500000;
+const size_t cESCAPING_ENTRIES = 100000;
+const size_t cARENA_ENTRIES = 200000;
+const size_t cBUILDER_ELEMENTS = 1000000;
+const size_t cMERGE_MODULES = 50;
+const size_t cMERGE_PARAMETERS = 5000;
+const size_t cSNAPSHOT_PARAMETERS = 20000;
+const size_t cSNAPSHOT_CONSUMERS = 16;
+const size_t cINDEX_ROWS = 100000;
+const size_t cINDEX_LOOKUPS = 1000;
+const size_t cTRAVERSAL_FAN_OUT = 40;
+const size_t cTRAVERSAL_CHILDREN = 1000000;
+const size_t cFROZEN_FAN_OUT = 32;
+const size_t cCOMPACT_FAN_OUT = 100;
+const size_t cREPARSE_SENSORS = 50;
+const size_t cREPARSE_MESSAGES = 20000;
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+namespace
+{
+
+/*! Measure the best of several runs of a function
+ *
+ * \param name          Description of the measured operation
+ * \param bytes         Amount of data processed per run (for throughput output)
+ * \param function      The operation to measure
+ * \param repetitions   Number of runs
+ */
+void Measure(const std::string &name, size_t bytes, const std::function<void()> &function, unsigned int repetitions = 5)
+{
+  double best = 0;
+  for (unsigned int i = 0; i < repetitions; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = (i == 0 || seconds < best) ? seconds : best;
+  }
+  std::cout << std::left << std::setw(56) << name << std::right << std::setw(10) << std::fixed << std::setprecision(2) << best * 1000 << " ms";
+  if (bytes)
+  {
+    std::cout << std::setw(10) << std::setprecision(1) << bytes / best / (1 << 20) << " MiB/s";
+  }
+  std::cout << std::endl;
+}
+
+void BenchmarkNumericArrays()
+{
+  tDocument document;
+  tNode &root_node = document.AddRootNode("benchmark");
+
+  std::vector<double> doubles(cNUMERIC_ARRAY_SIZE);
+  std::vector<int> ints(cNUMERIC_ARRAY_SIZE);
+  for (size_t i = 0; i < cNUMERIC_ARRAY_SIZE; ++i)
+  {
+    doubles[i] = (i * 0.731) - 1000.0 / (i + 1);
+    ints[i] = int(i * 7919) - 5000000;
+  }
+
+  Measure("SetNumericArrayAttribute<double> (10^6)", 0, [&]
+  {
+    root_node.SetNumericArrayAttribute("doubles", doubles);
+  });
+  Measure("SetNumericArrayAttribute<int> (10^6)", 0, [&]
+  {
+    root_node.SetNumericArrayAttribute("ints", ints, ',');
+  });
+
+  const size_t double_bytes = root_node.GetStringAttribute("doubles").size();
+  const size_t int_bytes = root_node.GetStringAttribute("ints").size();
+
+  std::vector<double> read_doubles;
+  Measure("GetNumericArrayAttribute<double> (10^6)", double_bytes, [&]
+  {
+    root_node.GetNumericArrayAttribute("doubles", read_doubles);
+  });
+  assert(read_doubles == doubles);
+  Measure("GetStringAttribute + std::istringstream <double> (10^6)", double_bytes, [&]
+  {
+    std::istringstream stream(root_node.GetStringAttribute("doubles"));
+    read_doubles.clear();
+    double value;
+    while (stream >> value)
+    {
+      read_doubles.push_back(value);
+    }
+  });
+
+  std::vector<int> read_ints;
+  Measure("GetNumericArrayAttribute<int> (10^6)", int_bytes, [&]
+  {
+    root_node.GetNumericArrayAttribute("ints", read_ints);
+  });
+  assert(read_ints == ints);
+  Measure("GetStringAttribute + std::strtol <int> (10^6)", int_bytes, [&]
+  {
+    const std::string value = root_node.GetStringAttribute("ints");
+    read_ints.clear();
+    for (const char *current = value.c_str(); *current;)
+    {
+      char *end;
+      read_ints.push_back(std::strtol(current, &end, 10));
+      current = *end ? end + 1 : end;
+    }
+  });
+
+  tNode &content_node = root_node.AddChildNode("content");
+  content_node.SetNumericArrayContent(doubles);
+  Measure("GetNumericArrayContent<double> into buffer (10^6)", double_bytes, [&]
+  {
+    content_node.GetNumericArrayContent(read_doubles.data(), read_doubles.size());
+  });
+}
+
+void BenchmarkBase64()
+{
+  tDocument document;
+  tNode &root_node = document.AddRootNode("benchmark");
+
+  std::vector<uint8_t> data(cBINARY_CONTENT_SIZE);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] = (i * 2654435761u) >> 13;
+  }
+  std::vector<uint8_t> read(data.size());
+
+  Measure("memcpy (64 MiB, reference)", data.size(), [&]
+  {
+    std::memcpy(read.data(), data.data(), data.size());
+  });
+  Measure("SetBinaryContent (64 MiB)", data.size(), [&]
+  {
+    root_node.SetBinaryContent(data.data(), data.size());
+  });
+  Measure("GetBinaryContent into buffer (64 MiB)", data.size(), [&]
+  {
+    root_node.GetBinaryContent(read.data(), read.size());
+  });
+  assert(read == data);
+  Measure("GetTextContent (64 MiB, for comparison)", data.size(), [&]
+  {
+    root_node.GetTextContent();
+  });
+}
+
+
+void BenchmarkWriter()
+{
+  std::string output;
+  auto write_document = [&]
+  {
+    output.clear();
+    tWriter writer(&output);
+    writer.StartElement("benchmark");
+    for (size_t i = 0; i < cWRITER_ELEMENTS; ++i)
+    {
+      writer.StartElement("sample");
+      writer.Attribute("index", i);
+      writer.Attribute("value", i * 0.5);
+      writer.Text("a < b");
+      writer.EndElement();
+    }
+    writer.Close();
+  };
+  write_document();
+  Measure("tWriter into std::string (10^6 elements)", output.size(), write_document);
+
+  std::string dump;
+  Measure("tDocument + GetXMLDump (10^6 elements, for comparison)", output.size(), [&]
+  {
+    tDocument document;
+    tNode &root_node = document.AddRootNode("benchmark");
+    for (size_t i = 0; i < cWRITER_ELEMENTS; ++i)
+    {
+      tNode &node = root_node.AddChildNode("sample", "a < b");
+      node.SetAttribute("index", i);
+      node.SetAttribute("value", i * 0.5);
+    }
+    dump.clear();
+    root_node.GetXMLDump(dump, true);
+  });
+}
+
+
+size_t FileSize(const std::string &file_name)
+{
+  FILE *file = std::fopen(file_name.c_str(), "rb");
+  std::fseek(file, 0, SEEK_END);
+  const size_t size = std::ftell(file);
+  std::fclose(file);
+  return size;
+}
+
+void BenchmarkCompression()
+{
+  tDocument document;
+  tNode &root_node = document.AddRootNode("log");
+  for (size_t i = 0; i < cCOMPRESSION_ENTRIES; ++i)
+  {
+    tNode &entry = root_node.AddChildNode("entry", i % 7 ? "cycle completed" : "sensor value out of range");
+    entry.SetAttribute("time", i * 0.01);
+    entry.SetAttribute("source", i % 3 ? "controller" : "sensor_" + std::to_string(i % 17));
+  }
+  const std::string file_name = "/tmp/rrlib_xml_benchmark.xml";
+  document.WriteToFile(file_name);
+  const size_t size = FileSize(file_name);
+
+  struct tCase
+  {
+    std::string codec;
+    int level;
+  };
+  std::vector<tCase> cases = { { "", 0 } };
+  const std::vector<std::string> codecs = GetCompressionCodecNames();
+  for (auto it = codecs.begin(); it != codecs.end(); ++it)
+  {
+    const std::vector<int> levels = *it == "gzip" ? std::vector<int> { 1, 6 } : (*it == "zstd" ? std::vector<int> { 1, 3, 9 } : std::vector<int> { 0, 9 });
+    for (auto level = levels.begin(); level != levels.end(); ++level)
+    {
+      cases.push_back({ *it, *level });
+    }
+  }
+  cases.push_back({ "libxml2 gzip", 6 }); // last, as it changes the compression mode of the document
+
+  for (auto it = cases.begin(); it != cases.end(); ++it)
+  {
+    auto write = [&]
+    {
+      if (it->codec.empty())
+      {
+        document.WriteToFile(file_name);
+      }
+      else if (it->codec == "libxml2 gzip")
+      {
+        document.WriteToFile(file_name, it->level);
+      }
+      else
+      {
+        document.WriteToFile(file_name, it->codec, it->level);
+      }
+    };
+    write();
+    std::ostringstream name;
+    name << (it->codec.empty() ? "uncompressed" : it->codec) << " level " << it->level << " (ratio " << std::setprecision(3) << double(size) / FileSize(file_name) << ")";
+    Measure("write " + name.str(), size, write);
+    Measure("read  " + name.str(), size, [&]
+    {
+      tDocument read(file_name, false);
+    });
+  }
+  std::remove(file_name.c_str());
+}
+
+void BenchmarkParallelSerialization()
+{
+  tDocument document;
+  tNode &root_node = document.AddRootNode("trajectory");
+  for (size_t i = 0; i < cPARALLEL_ENTRIES; ++i)
+  {
+    tNode &pose = root_node.AddChildNode("pose");
+    pose.SetAttribute("time", i * 0.01);
+    pose.SetAttribute("frame", i % 5 ? "odometry" : "map");
+    pose.AddChildNode("position").SetNumericArrayAttribute("xyz", std::vector<double> { i * 0.1, i * 0.2, 0.5 });
+  }
+  const std::string file_name = "/tmp/rrlib_xml_benchmark.xml";
+  document.WriteToFile(file_name);
+  const size_t size = FileSize(file_name);
+
+  Measure("WriteToFile (5 * 10^5 children)", size, [&]
+  {
+    document.WriteToFile(file_name);
+  });
+  const unsigned int hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  for (unsigned int threads = 1; ; threads = std::min(threads * 2, hardware_threads))
+  {
+    Measure("WriteToFileParallel (5 * 10^5 children, " + std::to_string(threads) + " threads)", size, [&]
+    {
+      document.WriteToFileParallel(file_name, threads);
+    });
+    if (threads == hardware_threads)
+    {
+      break;
+    }
+  }
+  std::remove(file_name.c_str());
+}
+
+void BenchmarkEscaping()
+{
+  const std::string clean_text = "The quick brown fox jumps over the lazy dog while the robot keeps track of its pose estimate. ";
+  const std::string heavy_text = "if (a < b && c > d) { print(\"<tag attr='1'>\"); } & \"quoted\"\t<>&\r\n";
+  struct tCase
+  {
+    std::string name;
+    std::string text;
+  };
+  const std::vector<tCase> cases = { { "mostly clean", clean_text + clean_text }, { "escape-heavy", heavy_text + heavy_text } };
+
+  for (auto it = cases.begin(); it != cases.end(); ++it)
+  {
+    tDocument document;
+    tNode &root_node = document.AddRootNode("log");
+    for (size_t i = 0; i < cESCAPING_ENTRIES; ++i)
+    {
+      tNode &entry = root_node.AddChildNode("entry");
+      entry.SetAttribute("description", it->text);
+      entry.AddTextContent(it->text);
+    }
+
+    std::string dump;
+    root_node.GetXMLDump(dump, true);
+    const size_t size = dump.size();
+    Measure("GetXMLDump (" + it->name + ")", size, [&]
+    {
+      dump.clear();
+      root_node.GetXMLDump(dump, true);
+    });
+    std::string output;
+    Measure("tWriter::WriteSubtree (" + it->name + ")", size, [&]
+    {
+      output.clear();
+      tWriter writer(&output);
+      writer.WriteSubtree(root_node);
+      writer.Close();
+    });
+  }
+}
+
+
+void BenchmarkArena()
+{
+  tDocument document;
+  tNode &root_node = document.AddRootNode("configuration");
+  for (size_t i = 0; i < cARENA_ENTRIES; ++i)
+  {
+    tNode &parameter = root_node.AddChildNode("parameter", "value " + std::to_string(i));
+    parameter.SetAttribute("name", "parameter_" + std::to_string(i));
+    parameter.SetAttribute("unit", i % 3 ? "m" : "rad");
+  }
+  std::string xml;
+  root_node.GetXMLDump(xml, true);
+
+  const unsigned int cREPETITIONS = 5;
+  struct tCase
+  {
+    std::string name;
+    bool arena;
+  };
+  const std::vector<tCase> cases = { { "heap", false }, { "arena", true } };
+  for (auto it = cases.begin(); it != cases.end(); ++it)
+  {
+    std::vector<std::unique_ptr<tDocument>> documents;
+    Measure("Parse (2 * 10^5 children, " + it->name + ")", xml.size(), [&]
+    {
+      documents.emplace_back(it->arena ? new tDocument(tDocument::cARENA_ALLOCATION, xml.data(), xml.size(), false) : new tDocument(xml.data(), xml.size(), false));
+    }, cREPETITIONS);
+    Measure("Destroy (2 * 10^5 children, " + it->name + ")", 0, [&]
+    {
+      documents.pop_back();
+    }, cREPETITIONS);
+  }
+}
+
+
+void BenchmarkNodeBuilder()
+{
+  const unsigned int cREPETITIONS = 3;
+  Measure("tNode::AddChildNode (10^6 elements)", 0, [&]
+  {
+    tDocument document;
+    tNode &root_node = document.AddRootNode("samples");
+    for (size_t i = 0; i < cBUILDER_ELEMENTS; ++i)
+    {
+      tNode &sample = root_node.AddChildNode("sample", "value");
+      sample.SetAttribute("index", static_cast<int>(i));
+      sample.SetAttribute("valid", true);
+    }
+  }, cREPETITIONS);
+  Measure("tNodeBuilder (10^6 elements)", 0, [&]
+  {
+    tDocument document;
+    tNode &root_node = document.AddRootNode("samples");
+    tNodeBuilder builder(root_node);
+    const tNodeBuilder::tName sample = builder.Intern("sample");
+    const tNodeBuilder::tName index = builder.Intern("index");
+    const tNodeBuilder::tName valid = builder.Intern("valid");
+    for (size_t i = 0; i < cBUILDER_ELEMENTS; ++i)
+    {
+      builder.AddChild(sample, "value", 5);
+      builder.Attribute(index, static_cast<int>(i));
+      builder.Attribute(valid, true);
+    }
+  }, cREPETITIONS);
+}
+
+
+void BenchmarkMerge()
+{
+  tDocument module;
+  tNode &module_root = module.AddRootNode("module");
+  for (size_t i = 0; i < cMERGE_PARAMETERS; ++i)
+  {
+    tNode &parameter = module_root.AddChildNode("parameter", "value " + std::to_string(i));
+    parameter.SetAttribute("name", "parameter_" + std::to_string(i));
+  }
+  std::string xml;
+  module_root.GetXMLDump(xml, true);
+
+  struct tCase
+  {
+    std::string name;
+    bool copy;
+  };
+  const std::vector<tCase> cases = { { "copy", true }, { "move", false } };
+  for (auto it = cases.begin(); it != cases.end(); ++it)
+  {
+    std::vector<std::unique_ptr<tDocument>> sources;
+    for (size_t i = 0; i < cMERGE_MODULES; ++i)
+    {
+      sources.emplace_back(new tDocument(xml.data(), xml.size(), false));
+    }
+    tDocument master;
+    tNode &master_root = master.AddRootNode("master");
+    Measure("Merge 50 parsed modules (" + it->name + ")", xml.size() * cMERGE_MODULES, [&]
+    {
+      for (auto source = sources.begin(); source != sources.end(); ++source)
+      {
+        master_root.AddChildNode((*source)->RootNode(), it->copy);
+      }
+    }, 1);
+  }
+}
+
+
+void BenchmarkSnapshot()
+{
+  tDocument document;
+  tNode &root_node = document.AddRootNode("configuration");
+  for (size_t i = 0; i < cSNAPSHOT_PARAMETERS; ++i)
+  {
+    tNode &parameter = root_node.AddChildNode("parameter", "value " + std::to_string(i));
+    parameter.SetAttribute("name", "parameter_" + std::to_string(i));
+  }
+
+  std::vector<std::shared_ptr<const tDocument>> consumers(cSNAPSHOT_CONSUMERS);
+  Measure("Publish to 16 consumers (deep copies)", 0, [&]
+  {
+    for (auto it = consumers.begin(); it != consumers.end(); ++it)
+    {
+      std::shared_ptr<tDocument> copy(new tDocument());
+      *copy = document;
+      *it = copy;
+    }
+  });
+  Measure("Publish to 16 consumers (Snapshot)", 0, [&]
+  {
+    root_node.SetAttribute("revision", 1);
+    for (auto it = consumers.begin(); it != consumers.end(); ++it)
+    {
+      *it = document.Snapshot();
+    }
+  });
+}
+
+void BenchmarkChildIndex()
+{
+  tDocument document;
+  tNode &table = document.AddRootNode("table");
+  for (size_t i = 0; i < cINDEX_ROWS; ++i)
+  {
+    table.AddChildNode("row").SetAttribute("key", static_cast<int>(i));
+  }
+
+  size_t iterated = 0;
+  Measure("Access 1000 of 10^5 rows by position (iteration)", 0, [&]
+  {
+    iterated = 0;
+    for (size_t i = 0; i < cINDEX_LOOKUPS; ++i)
+    {
+      auto it = table.ChildrenBegin();
+      std::advance(it, (i * 7919) % cINDEX_ROWS);
+      iterated += it->GetIntAttribute("key");
+    }
+  }, 1);
+  size_t indexed = 0;
+  Measure("Access 1000 of 10^5 rows by position (ChildAt)", 0, [&]
+  {
+    indexed = 0;
+    for (size_t i = 0; i < cINDEX_LOOKUPS; ++i)
+    {
+      indexed += table.ChildAt((i * 7919) % cINDEX_ROWS).GetIntAttribute("key");
+    }
+  });
+  assert(iterated == indexed);
+
+  size_t counted = 0;
+  Measure("Count 10^5 rows 1000 times (GetNumberOfChildren)", 0, [&]
+  {
+    counted = 0;
+    for (size_t i = 0; i < cINDEX_LOOKUPS; ++i)
+    {
+      counted += table.GetNumberOfChildren();
+    }
+  }, 1);
+  size_t indexed_count = 0;
+  Measure("Count 10^5 rows 1000 times (ChildCount)", 0, [&]
+  {
+    indexed_count = 0;
+    for (size_t i = 0; i < cINDEX_LOOKUPS; ++i)
+    {
+      indexed_count += table.ChildCount();
+    }
+  });
+  assert(counted == indexed_count);
+}
+
+size_t CountRecursively(const tNode &node)
+{
+  size_t count = 0;
+  for (auto it = node.ChildrenBegin(); it != node.ChildrenEnd(); ++it)
+  {
+    count += 1 + CountRecursively(*it);
+  }
+  return count;
+}
+
+void BenchmarkTraversal()
+{
+  // Four levels with 40 children per element (2.6 * 10^6 elements)
+  tDocument document;
+  tNode &root_node = document.AddRootNode("configuration");
+  tNodeBuilder builder(root_node);
+  const tNodeBuilder::tName names[] = { builder.Intern("parameter"), builder.Intern("group") };
+  std::vector<tNode *> level(1, &root_node);
+  for (int depth = 0; depth < 4; ++depth)
+  {
+    std::vector<tNode *> next_level;
+    for (auto it = level.begin(); it != level.end(); ++it)
+    {
+      tNodeBuilder level_builder(**it);
+      for (size_t i = 0; i < cTRAVERSAL_FAN_OUT; ++i)
+      {
+        next_level.push_back(&level_builder.AddChild(names[i % 2]));
+      }
+    }
+    level.swap(next_level);
+  }
+  const tNode &tree = root_node;
+
+  size_t recursive_count = 0;
+  Measure("Count descendants (recursion)", 0, [&]
+  {
+    recursive_count = CountRecursively(tree);
+  });
+  size_t iterated_count = 0;
+  Measure("Count descendants (Descendants)", 0, [&]
+  {
+    iterated_count = std::distance(tree.Descendants().begin(), tree.Descendants().end());
+  });
+  assert(recursive_count == iterated_count);
+
+  // One level of 10^6 elements, every second one a parameter
+  tDocument flat_document;
+  tNodeBuilder flat_builder(flat_document.AddRootNode("configuration"));
+  for (size_t i = 0; i < cTRAVERSAL_CHILDREN; ++i)
+  {
+    flat_builder.AddChild(flat_builder.Intern(i % 2 ? "group" : "parameter"));
+  }
+  const tNode &children = flat_document.RootNode();
+
+  size_t compared = 0;
+  Measure("Filter 10^6 children by name (Name() ==)", 0, [&]
+  {
+    compared = 0;
+    for (auto it = children.ChildrenBegin(); it != children.ChildrenEnd(); ++it)
+    {
+      compared += it->Name() == "parameter";
+    }
+  });
+  size_t filtered = 0;
+  Measure("Filter 10^6 children by name (ChildrenNamed)", 0, [&]
+  {
+    auto parameters = children.ChildrenNamed("parameter");
+    filtered = std::distance(parameters.begin(), parameters.end());
+  });
+  assert(compared == filtered);
+}
+
+template <typename TNode>
+size_t CountChildrenRecursively(const TNode &node)
+{
+  size_t count = 0;
+  for (auto it = node.ChildrenBegin(); it != node.ChildrenEnd(); ++it)
+  {
+    count += 1 + CountChildrenRecursively(*it);
+  }
+  return count;
+}
+
+template <typename TNode>
+double SumRates(const TNode &node)
+{
+  double sum = 0;
+  for (auto &descendant : node.Descendants())
+  {
+    if (descendant.HasAttribute("rate"))
+    {
+      sum += descendant.GetDoubleAttribute("rate");
+    }
+  }
+  return sum;
+}
+
+void BenchmarkFrozenDocument()
+{
+  // Four levels with 32 children per element (1.1 * 10^6 elements), each with two attributes and text
+  tDocument document;
+  {
+    std::vector<tNode *> level(1, &document.AddRootNode("configuration"));
+    for (int depth = 0; depth < 4; ++depth)
+    {
+      std::vector<tNode *> next_level;
+      for (auto it = level.begin(); it != level.end(); ++it)
+      {
+        tNodeBuilder builder(**it);
+        const tNodeBuilder::tName names[] = { builder.Intern("parameter"), builder.Intern("id"), builder.Intern("rate") };
+        for (size_t i = 0; i < cFROZEN_FAN_OUT; ++i)
+        {
+          next_level.push_back(&builder.AddChild(names[0], "value"));
+          builder.Attribute(names[1], next_level.size());
+          builder.Attribute(names[2], i * 0.25);
+        }
+      }
+      level.swap(next_level);
+    }
+  }
+  const tNode &root_node = document.RootNode();
+
+  std::unique_ptr<tFrozenDocument> frozen;
+  Measure("Freeze 1.1 * 10^6 elements", 0, [&]
+  {
+    frozen.reset(new tFrozenDocument(document.Freeze()));
+  });
+  const tFrozenNode &frozen_root = frozen->RootNode();
+  std::cout << "Memory: DOM " << (document.MemoryFootprint().Total() >> 20) << " MiB, frozen " << (frozen->MemoryUsage() >> 20) << " MiB" << std::endl;
+
+  size_t live_count = 0;
+  Measure("Count descendants (recursion, DOM)", 0, [&]
+  {
+    live_count = CountChildrenRecursively(root_node);
+  });
+  size_t frozen_count = 0;
+  Measure("Count descendants (recursion, frozen)", 0, [&]
+  {
+    frozen_count = CountChildrenRecursively(frozen_root);
+  });
+  assert(live_count == frozen_count);
+
+  double live_sum = 0;
+  Measure("Sum attribute of all descendants (DOM)", 0, [&]
+  {
+    live_sum = SumRates(root_node);
+  });
+  double frozen_sum = 0;
+  Measure("Sum attribute of all descendants (frozen)", 0, [&]
+  {
+    frozen_sum = SumRates(frozen_root);
+  });
+  assert(live_sum == frozen_sum);
+
+  size_t live_text = 0;
+  Measure("Read text of all descendants (DOM)", 0, [&]
+  {
+    live_text = 0;
+    for (auto &node : root_node.Descendants())
+    {
+      live_text += node.GetTextContent().length();
+    }
+  });
+  size_t frozen_text = 0;
+  Measure("Read text of all descendants (frozen)", 0, [&]
+  {
+    frozen_text = 0;
+    for (auto &node : frozen_root.Descendants())
+    {
+      frozen_text += node.GetTextContent().length();
+    }
+  });
+  assert(live_text == frozen_text);
+}
+
+size_t TraverseAndCompare(const tNode &root_node)
+{
+  size_t parameters = 0;
+  for (auto &node : root_node.Descendants())
+  {
+    parameters += node.Name() == "parameter" && node.HasAttribute("value");
+  }
+  return parameters;
+}
+
+void BenchmarkCompact()
+{
+  // Three levels with 100 children per element (10^6 elements), built breadth-first with interleaved
+  // temporary allocations, so neighbours in depth-first order are far apart on the heap
+  tDocument document;
+  {
+    tDocument scratch;
+    tNode &scratch_root = scratch.AddRootNode("scratch");
+    std::vector<tNode *> level(1, &document.AddRootNode("configuration"));
+    for (int depth = 0; depth < 3; ++depth)
+    {
+      std::vector<tNode *> next_level;
+      for (size_t i = 0; i < cCOMPACT_FAN_OUT; ++i)
+      {
+        for (auto it = level.begin(); it != level.end(); ++it)
+        {
+          next_level.push_back(&(*it)->AddChildNode(i % 2 ? "group" : "parameter"));
+          next_level.back()->SetAttribute("value", i);
+          scratch_root.AddChildNode("temporary", "content");
+        }
+      }
+      level.swap(next_level);
+    }
+  }
+  const tNode *root_node = &document.RootNode();
+
+  size_t fragmented = 0;
+  Measure("Traverse 10^6 elements (fragmented)", 0, [&]
+  {
+    fragmented = TraverseAndCompare(*root_node);
+  });
+  Measure("Compact 10^6 elements", 0, [&]
+  {
+    document.Compact();
+  }, 1);
+  root_node = &document.RootNode();
+  size_t compacted = 0;
+  Measure("Traverse 10^6 elements (compacted)", 0, [&]
+  {
+    compacted = TraverseAndCompare(*root_node);
+  });
+  assert(fragmented == compacted);
+}
+
+void BenchmarkReparse()
+{
+  // Periodic state messages of the same shape with changing sensor readings
+  std::vector<std::string> messages(16);
+  for (size_t m = 0; m < messages.size(); ++m)
+  {
+    std::ostringstream message;
+    message << "<?xml version=\"1.0\"?>\n<state cycle=\"" << m << "\">\n";
+    for (size_t i = 0; i < cREPARSE_SENSORS; ++i)
+    {
+      message << "  <sensor id=\"" << i << "\" value=\"" << (i * 0.37 + m * 1.25) << "\" valid=\"" << ((i + m) % 7 ? "true" : "false") << "\">"
+              << (m % 3 ? "ok" : "recalibrating") << "</sensor>\n";
+    }
+    message << "</state>\n";
+    messages[m] = message.str();
+  }
+  size_t bytes = 0;
+  for (size_t i = 0; i < cREPARSE_MESSAGES; ++i)
+  {
+    bytes += messages[i % messages.size()].size();
+  }
+
+  Measure("Parse 20000 messages with tDocument", bytes, [&]
+  {
+    for (size_t i = 0; i < cREPARSE_MESSAGES; ++i)
+    {
+      const std::string &message = messages[i % messages.size()];
+      tDocument document(message.data(), message.size(), false);
+    }
+  });
+  tDocument document(messages[0].data(), messages[0].size(), false);
+  size_t updated = 0;
+  Measure("Reparse 20000 messages in place", bytes, [&]
+  {
+    updated = 0;
+    for (size_t i = 0; i < cREPARSE_MESSAGES; ++i)
+    {
+      const std::string &message = messages[i % messages.size()];
+      updated += document.Reparse(message.data(), message.size(), false);
+    }
+  });
+  assert(updated == cREPARSE_MESSAGES);
+}
+
+}
+
+//----------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  const std::vector<std::pair<std::string, std::function<void()>>> benchmarks =
+  {
+    { "numeric_arrays", BenchmarkNumericArrays },
+    { "base64", BenchmarkBase64 },
+    { "writer", BenchmarkWriter },
+    { "compression", BenchmarkCompression },
+    { "parallel", BenchmarkParallelSerialization },
+    { "escaping", BenchmarkEscaping },
+    { "arena", BenchmarkArena },
+    { "builder", BenchmarkNodeBuilder },
+    { "merge", BenchmarkMerge },
+    { "snapshot", BenchmarkSnapshot },
+    { "child_index", BenchmarkChildIndex },
+    { "traversal", BenchmarkTraversal },
+    { "frozen", BenchmarkFrozenDocument },
+    { "compact", BenchmarkCompact },
+    { "reparse", BenchmarkReparse }
+  };
+
+  for (auto it = benchmarks.begin(); it != benchmarks.end(); ++it)
+  {
+    bool selected = argc == 1;
+    for (int i = 1; i < argc; ++i)
+    {
+      selected |= it->first == argv[i];
+    }
+    if (selected)
+    {
+      std::cout << "=== " << it->first << " ===" << std::endl;
+      it->second();
+    }
+  }
+  return 0;
+}
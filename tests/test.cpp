@@ -33,10 +33,22 @@
 //----------------------------------------------------------------------
 #include "rrlib/util/tUnitTestSuite.h"
 
+#include <atomic>
 #include <cstdlib>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <thread>
 #include <unistd.h>
 
 #include "rrlib/xml/tDocument.h"
+#include "rrlib/xml/tCompressionCodec.h"
+#include "rrlib/xml/tEventEmitter.h"
+#include "rrlib/xml/tNodeBuilder.h"
+#include "rrlib/xml/tStructBinding.h"
+#include "rrlib/xml/tWriter.h"
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -51,6 +63,31 @@
 // Namespace usage
 //----------------------------------------------------------------------
 
+//----------------------------------------------------------------------
+// Allocation counting (global operator new is replaced for the whole test binary)
+//----------------------------------------------------------------------
+namespace
+{
+thread_local size_t allocation_count = 0;
+}
+
+void *operator new(size_t size)
+{
+  allocation_count++;
+  void *memory = std::malloc(size ? size : 1);
+  if (!memory)
+  {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+// Not inlined, so that the compiler does not pair the inner free with operator new
+__attribute__((noinline)) void operator delete(void *memory) noexcept
+{
+  std::free(memory);
+}
+
 //----------------------------------------------------------------------
 // Namespace declaration
 //----------------------------------------------------------------------
@@ -70,6 +107,85 @@ namespace xml
 //----------------------------------------------------------------------
 // Implementation
 //----------------------------------------------------------------------
+struct tBindingTestStruct
+{
+  double gain;
+  int cycles;
+  bool enabled;
+  std::string mode;
+  unsigned int count;
+  float ratio;
+};
+
+//! Codec that inverts all bits after a magic header (only for testing the codec registry)
+class tInvertingCodec : public tCompressionCodec
+{
+  class tCompressor : public tCompressionCodec::tCompressor
+  {
+  public:
+    explicit tCompressor(const tSink &sink) : sink(sink)
+    {
+      this->sink("INV1", 4);
+    }
+    virtual void Write(const char *data, size_t size) override
+    {
+      std::string inverted(data, size);
+      for (auto &c : inverted)
+      {
+        c = ~c;
+      }
+      this->sink(inverted.data(), inverted.size());
+    }
+    virtual void Finish() override
+    {}
+  private:
+    tSink sink;
+  };
+
+  class tDecompressor : public tCompressionCodec::tDecompressor
+  {
+  public:
+    explicit tDecompressor(const tSource &source) : source(source), header_skipped(false)
+    {}
+    virtual size_t Read(char *data, size_t size) override
+    {
+      char header[4];
+      if (!this->header_skipped)
+      {
+        this->header_skipped = true;
+        this->source(header, 4);
+      }
+      size_t count = this->source(data, size);
+      for (size_t i = 0; i < count; ++i)
+      {
+        data[i] = ~data[i];
+      }
+      return count;
+    }
+  private:
+    tSource source;
+    bool header_skipped;
+  };
+
+public:
+  virtual const char *Name() const override
+  {
+    return "inverting";
+  }
+  virtual bool Detect(const char *header, size_t size) const override
+  {
+    return size >= 4 && std::string(header, 4) == "INV1";
+  }
+  virtual std::unique_ptr<tCompressionCodec::tCompressor> CreateCompressor(const tSink &sink, int) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tCompressor>(new tCompressor(sink));
+  }
+  virtual std::unique_ptr<tCompressionCodec::tDecompressor> CreateDecompressor(const tSource &source) const override
+  {
+    return std::unique_ptr<tCompressionCodec::tDecompressor>(new tDecompressor(source));
+  }
+};
+
 class Test : public util::tUnitTestSuite
 {
   RRLIB_UNIT_TESTS_BEGIN_SUITE(Test);
@@ -79,6 +195,31 @@ class Test : public util::tUnitTestSuite
   RRLIB_UNIT_TESTS_ADD_TEST(WriteReadFile);
   RRLIB_UNIT_TESTS_ADD_TEST(Exceptions);
   RRLIB_UNIT_TESTS_ADD_TEST(Content);
+  RRLIB_UNIT_TESTS_ADD_TEST(StructBinding);
+  RRLIB_UNIT_TESTS_ADD_TEST(NumericArrays);
+  RRLIB_UNIT_TESTS_ADD_TEST(BinaryContent);
+  RRLIB_UNIT_TESTS_ADD_TEST(AttributeCache);
+  RRLIB_UNIT_TESTS_ADD_TEST(EnumNameTable);
+  RRLIB_UNIT_TESTS_ADD_TEST(XMLDumpSinks);
+  RRLIB_UNIT_TESTS_ADD_TEST(Writer);
+  RRLIB_UNIT_TESTS_ADD_TEST(WriteToFileAsync);
+  RRLIB_UNIT_TESTS_ADD_TEST(CompressionCodecs);
+  RRLIB_UNIT_TESTS_ADD_TEST(Fingerprints);
+  RRLIB_UNIT_TESTS_ADD_TEST(ModificationTracking);
+  RRLIB_UNIT_TESTS_ADD_TEST(WriteToFileParallel);
+  RRLIB_UNIT_TESTS_ADD_TEST(WriterSubtree);
+  RRLIB_UNIT_TESTS_ADD_TEST(EventEmitter);
+  RRLIB_UNIT_TESTS_ADD_TEST(ArenaAllocation);
+  RRLIB_UNIT_TESTS_ADD_TEST(NodeBuilder);
+  RRLIB_UNIT_TESTS_ADD_TEST(BulkMutation);
+  RRLIB_UNIT_TESTS_ADD_TEST(CrossDocumentMove);
+  RRLIB_UNIT_TESTS_ADD_TEST(Snapshot);
+  RRLIB_UNIT_TESTS_ADD_TEST(ChildIndex);
+  RRLIB_UNIT_TESTS_ADD_TEST(Iterators);
+  RRLIB_UNIT_TESTS_ADD_TEST(MemoryFootprint);
+  RRLIB_UNIT_TESTS_ADD_TEST(FrozenDocument);
+  RRLIB_UNIT_TESTS_ADD_TEST(Compact);
+  RRLIB_UNIT_TESTS_ADD_TEST(Reparse);
   RRLIB_UNIT_TESTS_END_SUITE;
 
 private:
@@ -178,6 +319,1519 @@ private:
 
     RRLIB_UNIT_TESTS_EXCEPTION(this->document.FindNode("/test/test2"), tException);
   }
+
+  void StructBinding()
+  {
+    const auto binding = CreateStructBinding(BindAttribute("prop_3", &tBindingTestStruct::gain),
+                                             BindAttribute("cycles", &tBindingTestStruct::cycles, 7),
+                                             BindAttribute("prop_2", &tBindingTestStruct::enabled, false),
+                                             BindChild("mode", &tBindingTestStruct::mode, std::string("auto")));
+
+    tBindingTestStruct object;
+    binding.Load(this->document.RootNode(), object);
+    RRLIB_UNIT_TESTS_EQUALITY(4.3, object.gain);
+    RRLIB_UNIT_TESTS_EQUALITY(7, object.cycles);
+    RRLIB_UNIT_TESTS_EQUALITY(true, object.enabled);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("auto"), object.mode);
+
+    tDocument doc;
+    object.cycles = 12;
+    object.mode = "manual";
+    binding.Save(object, doc.AddRootNode("config"));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("<config prop_3=\"4.3\" cycles=\"12\" prop_2=\"true\"><mode>manual</mode></config>"), doc.RootNode().GetXMLDump());
+
+    tBindingTestStruct loaded;
+    binding.Load(doc.RootNode(), loaded);
+    RRLIB_UNIT_TESTS_EQUALITY(12, loaded.cycles);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("manual"), loaded.mode);
+
+    doc.RootNode().SetAttribute("cycles", "many");
+    RRLIB_UNIT_TESTS_EXCEPTION(binding.Load(doc.RootNode(), loaded), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(binding.Load(doc.RootNode().FirstChild(), loaded), tException);
+
+    const auto numeric_binding = CreateStructBinding(BindAttribute("count", &tBindingTestStruct::count),
+                                                     BindChild("ratio", &tBindingTestStruct::ratio));
+    const std::string numbers = "<numbers count=\"42\"><ratio>0.<![CDATA[25]]></ratio></numbers>";
+    tDocument numeric_document(numbers.data(), numbers.size(), false);
+    tNode &numeric_node = numeric_document.RootNode();
+    tNode &ratio_node = numeric_node.FirstChild();
+    numeric_binding.Load(numeric_node, loaded);
+    RRLIB_UNIT_TESTS_EQUALITY(42u, loaded.count);
+    RRLIB_UNIT_TESTS_EQUALITY(0.25f, loaded.ratio);
+
+    numeric_node.SetAttribute("count", "-1");
+    RRLIB_UNIT_TESTS_EXCEPTION(numeric_binding.Load(numeric_node, loaded), tException);
+    numeric_node.SetAttribute("count", " -0");
+    RRLIB_UNIT_TESTS_EXCEPTION(numeric_binding.Load(numeric_node, loaded), tException);
+    numeric_node.SetAttribute("count", "4294967296");
+    RRLIB_UNIT_TESTS_EXCEPTION(numeric_binding.Load(numeric_node, loaded), tException);
+    numeric_node.SetAttribute("count", "4294967295");
+    ratio_node.SetContent("1e300");
+    RRLIB_UNIT_TESTS_EXCEPTION(numeric_binding.Load(numeric_node, loaded), tException);
+    ratio_node.SetContent("1e-50");
+    numeric_binding.Load(numeric_node, loaded);
+    RRLIB_UNIT_TESTS_EQUALITY(4294967295u, loaded.count);
+    RRLIB_UNIT_TESTS_EQUALITY(0.0f, loaded.ratio);
+  }
+
+  void NumericArrays()
+  {
+    tDocument doc;
+    tNode &root_node = doc.AddRootNode("matrix");
+    root_node.SetAttribute("row", " 1, -2,3\n\t4 ");
+    root_node.SetContent("0.5 1e-3,  -2.25\n");
+
+    std::vector<int> row;
+    root_node.GetNumericArrayAttribute("row", row);
+    RRLIB_UNIT_TESTS_EQUALITY(std::vector<int>({ 1, -2, 3, 4 }), row);
+
+    double buffer[4];
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(3), root_node.GetNumericArrayContent(buffer, 4));
+    RRLIB_UNIT_TESTS_EQUALITY(1e-3, buffer[1]);
+    RRLIB_UNIT_TESTS_EQUALITY(-2.25, buffer[2]);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetNumericArrayContent(buffer, 2), tException);
+
+    std::vector<double> values = { 0.1, 1.0 / 3, -7 };
+    root_node.SetNumericArrayAttribute("values", values, ',');
+    std::vector<double> read_values;
+    root_node.GetNumericArrayAttribute("values", read_values);
+    RRLIB_UNIT_TESTS_EQUALITY(values, read_values);
+
+    std::vector<unsigned char> bytes = { 0, 17, 255 };
+    root_node.SetNumericArrayContent(bytes);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("0 17 255"), root_node.GetTextContent());
+    root_node.SetContent("0 17 256");
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetNumericArrayContent(bytes), tException);
+    root_node.SetContent("1 2x");
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetNumericArrayContent(values), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetNumericArrayAttribute("missing", values), tException);
+
+    // Omitted attributes with a default value in the DTD are read like with GetStringAttribute
+    const std::string defaulted = "<!DOCTYPE r [<!ATTLIST r list CDATA \"1 2 3\">]><r/>";
+    tDocument defaulted_document(defaulted.data(), defaulted.size(), false);
+    std::vector<int> list;
+    defaulted_document.RootNode().GetNumericArrayAttribute("list", list);
+    RRLIB_UNIT_TESTS_EQUALITY(std::vector<int>({ 1, 2, 3 }), list);
+  }
+
+  void BinaryContent()
+  {
+    tDocument doc;
+    tNode &root_node = doc.AddRootNode("blob");
+
+    root_node.SetBinaryContent("foobar", 5);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("<blob>Zm9vYmE=</blob>"), root_node.GetXMLDump());
+    root_node.SetContent("Zm9v\n  YmFy\n");
+    std::vector<uint8_t> data;
+    root_node.GetBinaryContent(data);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("foobar"), std::string(data.begin(), data.end()));
+
+    data.resize(1000);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      data[i] = (i * 131) ^ (i >> 3);
+    }
+    for (size_t size = 0; size < 40; ++size)
+    {
+      std::vector<uint8_t> read;
+      root_node.SetBinaryContent(data.data() + 3, size);
+      root_node.GetBinaryContent(read);
+      RRLIB_UNIT_TESTS_EQUALITY(std::vector<uint8_t>(data.begin() + 3, data.begin() + 3 + size), read);
+    }
+    root_node.SetBinaryContent(data.data(), data.size());
+    std::vector<uint8_t> read(data.size());
+    RRLIB_UNIT_TESTS_EQUALITY(data.size(), root_node.GetBinaryContent(read.data(), read.size()));
+    RRLIB_UNIT_TESTS_EQUALITY(data, read);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetBinaryContent(read.data(), read.size() - 1), tException);
+
+    root_node.SetContent("Zm9v!mFy");
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetBinaryContent(data), tException);
+    root_node.SetContent("Zm9vYmE=Zm9v");
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetBinaryContent(data), tException);
+    root_node.SetContent("Zm9vY");
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetBinaryContent(data), tException);
+  }
+
+  void AttributeCache()
+  {
+    tNode &node = this->document.RootNode().FirstChild();
+    RRLIB_UNIT_TESTS_EQUALITY(false, node.HasAttributeCache());
+    node.EnableAttributeCache();
+    RRLIB_UNIT_TESTS_EQUALITY(true, node.HasAttributeCache());
+    RRLIB_UNIT_TESTS_EQUALITY(4.3, node.GetDoubleAttribute("prop_3"));
+    RRLIB_UNIT_TESTS_EQUALITY(true, node.GetBoolAttribute("prop_2"));
+
+    // bypassing tNode shows that cached values are used
+    xmlSetProp(reinterpret_cast<xmlNode *>(&node), reinterpret_cast<const xmlChar *>("prop_3"), reinterpret_cast<const xmlChar *>("1.5"));
+    RRLIB_UNIT_TESTS_EQUALITY(4.3, node.GetDoubleAttribute("prop_3"));
+    RRLIB_UNIT_TESTS_EQUALITY(1.5f, node.GetFloatAttribute("prop_3"));
+
+    node.SetAttribute("prop_3", 2.5);
+    RRLIB_UNIT_TESTS_EQUALITY(2.5, node.GetDoubleAttribute("prop_3"));
+    node.SetAttribute("prop_2", false);
+    RRLIB_UNIT_TESTS_EQUALITY(false, node.GetBoolAttribute("prop_2"));
+    node.SetAttribute("prop_4", "0x1f");
+    RRLIB_UNIT_TESTS_EQUALITY(31, node.GetIntAttribute("prop_4", 16));
+    RRLIB_UNIT_TESTS_EXCEPTION(node.GetIntAttribute("prop_4"), tException);
+    node.RemoveAttribute("prop_4");
+    RRLIB_UNIT_TESTS_EXCEPTION(node.GetIntAttribute("prop_4", 16), tException);
+    node.SetAttribute("prop_4", "0x20");
+    RRLIB_UNIT_TESTS_EQUALITY(32, node.GetIntAttribute("prop_4", 16));
+
+    node.AddChildNode("child").EnableAttributeCache();
+    node.SetContent("text");
+    node.DisableAttributeCache();
+    RRLIB_UNIT_TESTS_EQUALITY(false, node.HasAttributeCache());
+    RRLIB_UNIT_TESTS_EQUALITY(2.5, node.GetDoubleAttribute("prop_3"));
+
+    node.EnableAttributeCache();
+    this->document.RootNode().RemoveChildNode(node);
+
+    // _private pointers holding application data are left alone
+    tNode &foreign = this->document.RootNode().AddChildNode("foreign", "text");
+    reinterpret_cast<xmlNode *>(&foreign)->_private = reinterpret_cast<void *>(0x10);
+    reinterpret_cast<xmlNode *>(&foreign)->children->_private = reinterpret_cast<void *>(0x10);
+    RRLIB_UNIT_TESTS_EQUALITY(false, foreign.HasAttributeCache());
+    foreign.SetAttribute("k", 1);
+    foreign.SetAttribute("k", 2);
+    RRLIB_UNIT_TESTS_EQUALITY(2, foreign.GetIntAttribute("k"));
+    foreign.RemoveAttribute("k");
+    RRLIB_UNIT_TESTS_EXCEPTION(foreign.EnableAttributeCache(), tException);
+    this->document.RootNode().RemoveChildNode(foreign);
+  }
+
+  void EnumNameTable()
+  {
+    constexpr auto cNAMES = CreateEnumNameTable("idle", "running", "stopped", "error", "calibrating", "emergency_stop",
+                            "homing", "paused", "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l");
+    static_assert(cNAMES.Size() == 20, "Unexpected table size");
+    for (size_t i = 0; i < cNAMES.Size(); ++i)
+    {
+      RRLIB_UNIT_TESTS_EQUALITY(i, cNAMES.Find(cNAMES.Name(i)));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(cNAMES.Size(), cNAMES.Find(""));
+    RRLIB_UNIT_TESTS_EQUALITY(cNAMES.Size(), cNAMES.Find("Idle"));
+    RRLIB_UNIT_TESTS_EQUALITY(cNAMES.Size(), cNAMES.Find("runnin"));
+
+    tDocument document;
+    tNode &node = document.AddRootNode("test");
+    node.SetAttribute("state", "homing");
+    node.SetAttribute("invalid", "home");
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(6), node.GetEnumAttribute("state", cNAMES));
+    RRLIB_UNIT_TESTS_EXCEPTION(node.GetEnumAttribute("invalid", cNAMES), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(node.GetEnumAttribute("missing", cNAMES), tException);
+
+    node.SetAttribute("flag", "true");
+    RRLIB_UNIT_TESTS_EQUALITY(true, node.GetBoolAttribute("flag"));
+    node.SetAttribute("flag", "false");
+    RRLIB_UNIT_TESTS_EQUALITY(false, node.GetBoolAttribute("flag"));
+    node.SetAttribute("flag", "yes");
+    RRLIB_UNIT_TESTS_EXCEPTION(node.GetBoolAttribute("flag"), tException);
+
+    // Omitted attributes with a default value in the DTD
+    const std::string defaulted = "<!DOCTYPE r [<!ATTLIST r flag (true|false) \"true\" state CDATA \"paused\">]><r/>";
+    tDocument defaulted_document(defaulted.data(), defaulted.size(), false);
+    tNode &defaulted_node = defaulted_document.RootNode();
+    RRLIB_UNIT_TESTS_EQUALITY(true, defaulted_node.GetBoolAttribute("flag"));
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(7), defaulted_node.GetEnumAttribute("state", cNAMES));
+    defaulted_node.EnableAttributeCache();
+    RRLIB_UNIT_TESTS_EQUALITY(true, defaulted_node.GetBoolAttribute("flag"));
+    RRLIB_UNIT_TESTS_EQUALITY(true, defaulted_node.GetBoolAttribute("flag"));
+    defaulted_node.RemoveAttribute("flag");
+    defaulted_node.SetAttribute("flag", false);
+    RRLIB_UNIT_TESTS_EQUALITY(false, defaulted_node.GetBoolAttribute("flag"));
+    defaulted_node.RemoveAttribute("flag");
+    RRLIB_UNIT_TESTS_EQUALITY(true, defaulted_node.GetBoolAttribute("flag"));
+  }
+
+  void XMLDumpSinks()
+  {
+    tDocument document;
+    tNode &root_node = document.AddRootNode("root");
+    root_node.SetAttribute("text", "\"a\" & <b>");
+    for (int i = 0; i < 1000; ++i)
+    {
+      root_node.AddChildNode("child", "content " + std::to_string(i)).SetAttribute("index", i);
+    }
+    const std::string expected = root_node.GetXMLDump(true);
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(0), expected.find("<root text=\"&quot;a&quot; &amp; &lt;b&gt;\">\n  <child index=\"0\">content 0</child>"));
+
+    std::string output("prefix");
+    root_node.GetXMLDump(output, true);
+    RRLIB_UNIT_TESTS_EQUALITY("prefix" + expected, output);
+
+    std::ostringstream stream;
+    root_node.GetXMLDump(stream, true);
+    RRLIB_UNIT_TESTS_EQUALITY(expected, stream.str());
+    std::ostringstream failed_stream;
+    failed_stream.setstate(std::ios::badbit);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetXMLDump(failed_stream), tException);
+
+    FILE *file = std::tmpfile();
+    root_node.GetXMLDumpToFileDescriptor(fileno(file), true);
+    std::string file_content(expected.size() + 1, 0);
+    std::rewind(file);
+    file_content.resize(std::fread(&file_content[0], 1, file_content.size(), file));
+    std::fclose(file);
+    RRLIB_UNIT_TESTS_EQUALITY(expected, file_content);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetXMLDumpToFileDescriptor(-1), tException);
+
+    std::string chunks;
+    size_t calls = 0;
+    root_node.GetXMLDumpToSink([&](const char *data, size_t size)
+    {
+      chunks.append(data, size);
+      ++calls;
+    }, true);
+    RRLIB_UNIT_TESTS_EQUALITY(expected, chunks);
+    RRLIB_UNIT_TESTS_ASSERT(calls > 1);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetXMLDumpToSink([](const char *, size_t)
+    {
+      throw std::runtime_error("sink failed");
+    }), std::runtime_error);
+  }
+
+  void Writer()
+  {
+    char filename[] = "/tmp/tmp.XXXXXX";
+    close(mkstemp(filename));
+    std::string output;
+    {
+      tDocument document;
+      tNode &root_node = document.AddRootNode("root");
+      root_node.SetAttribute("escaped", "\"<&>\n\t\r'");
+      root_node.SetAttribute("number", 42);
+      root_node.SetAttribute("fraction", 0.25);
+      root_node.SetAttribute("flag", true);
+      root_node.AddChildNode("empty");
+      root_node.AddChildNode("text", "1 < 2 &amp; \"3\" >\r\n");
+      tNode &mixed = root_node.AddChildNode("mixed", "text");
+      mixed.AddChildNode("inner").AddChildNode("deeper");
+      tNode *deep = &root_node.AddChildNode("deep");
+      for (int i = 0; i < 35; ++i)
+      {
+        deep = &deep->AddChildNode("level");
+      }
+      deep->SetAttribute("last", "yes");
+      document.WriteToFile(filename);
+
+      tWriter writer(&output);
+      writer.StartElement("root");
+      writer.Attribute("escaped", "\"<&>\n\t\r'");
+      writer.Attribute("number", 42);
+      writer.Attribute("fraction", 0.25);
+      writer.Attribute("flag", true);
+      writer.StartElement("empty");
+      writer.EndElement();
+      writer.StartElement("text");
+      writer.Text("1 < 2 & \"3\" >\r\n");
+      writer.EndElement();
+      writer.StartElement("mixed");
+      writer.Text("text");
+      writer.StartElement("inner");
+      writer.StartElement("deeper");
+      writer.EndElement();
+      writer.EndElement();
+      RRLIB_UNIT_TESTS_EXCEPTION(writer.Attribute("late", 1), tException);
+      writer.EndElement();
+      writer.StartElement("deep");
+      for (int i = 0; i < 35; ++i)
+      {
+        writer.StartElement("level");
+      }
+      writer.Attribute("last", "yes");
+      RRLIB_UNIT_TESTS_EXCEPTION(writer.EndElement(); writer.Text("late"), tException);
+      writer.Close();
+      RRLIB_UNIT_TESTS_EXCEPTION(writer.StartElement("second_root"), tException);
+    }
+    FILE *file = std::fopen(filename, "r");
+    std::string file_content(output.size() + 1, 0);
+    file_content.resize(std::fread(&file_content[0], 1, file_content.size(), file));
+    std::fclose(file);
+    RRLIB_UNIT_TESTS_EQUALITY(file_content, output);
+
+    {
+      tWriter writer(filename);
+      writer.StartElement("root");
+    }
+    tDocument read(std::string(filename), false);
+    remove(filename);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("root"), read.RootNode().Name());
+  }
+
+  void WriteToFileAsync()
+  {
+    char directory[] = "/tmp/tmp.XXXXXX";
+    RRLIB_UNIT_TESTS_ASSERT(mkdtemp(directory));
+    const std::string filename = std::string(directory) + "/state.xml";
+
+    tDocument document;
+    tNode &root_node = document.AddRootNode("state");
+    for (int i = 0; i < 1000; ++i)
+    {
+      root_node.AddChildNode("entry").SetAttribute("index", i);
+    }
+    const std::string expected = root_node.GetXMLDump(true);
+    std::future<void> result = document.WriteToFileAsync(filename);
+    root_node.RemoveChildNode(root_node.FirstChild());
+    root_node.SetAttribute("modified", true);
+    result.get();
+    RRLIB_UNIT_TESTS_EQUALITY(true, document.IsModified());
+
+    tDocument read(filename, false);
+    RRLIB_UNIT_TESTS_EQUALITY(expected, read.RootNode().GetXMLDump(true));
+    document.WriteToFileAsync(filename).get();
+    RRLIB_UNIT_TESTS_EQUALITY(root_node.GetXMLDump(true), tDocument(filename, false).RootNode().GetXMLDump(true));
+    RRLIB_UNIT_TESTS_EQUALITY(false, document.IsModified());
+
+    root_node.SetAttribute("unsaved", true);
+    result = document.WriteToFileAsync(std::string(directory) + "/missing/state.xml");
+    RRLIB_UNIT_TESTS_EXCEPTION(result.get(), tException);
+    RRLIB_UNIT_TESTS_EQUALITY(true, document.IsModified());
+    RRLIB_UNIT_TESTS_EXCEPTION(document.WriteToFile(std::string(directory) + "/missing/state.xml"), tException);
+
+    // The write may outlive the document
+    {
+      tDocument temporary;
+      temporary.AddRootNode("temporary");
+      result = temporary.WriteToFileAsync(filename);
+    }
+    result.get();
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("temporary"), tDocument(filename, false).RootNode().Name());
+
+    remove(filename.c_str());
+    RRLIB_UNIT_TESTS_EQUALITY(0, rmdir(directory));
+  }
+
+  static std::string ReadFile(const std::string &filename)
+  {
+    FILE *file = std::fopen(filename.c_str(), "rb");
+    std::string content;
+    char buffer[4096];
+    for (size_t count; (count = std::fread(buffer, 1, sizeof(buffer), file)) > 0;)
+    {
+      content.append(buffer, count);
+    }
+    std::fclose(file);
+    return content;
+  }
+
+  void CompressionCodecs()
+  {
+    RegisterCompressionCodec(std::make_shared<tInvertingCodec>());
+    char filename[] = "/tmp/tmp.XXXXXX";
+    close(mkstemp(filename));
+
+    tDocument document;
+    tNode &root_node = document.AddRootNode("log");
+    for (int i = 0; i < 10000; ++i)
+    {
+      root_node.AddChildNode("entry", "message " + std::to_string(i)).SetAttribute("time", i * 0.01);
+    }
+    document.WriteToFile(filename);
+    const std::string plain = ReadFile(filename);
+
+    const std::vector<std::string> codecs = GetCompressionCodecNames();
+    for (auto it = codecs.begin(); it != codecs.end(); ++it)
+    {
+      for (int level = 0; level < 2; ++level)
+      {
+        document.WriteToFile(filename, *it, level);
+        const std::string compressed = ReadFile(filename);
+        RRLIB_UNIT_TESTS_EQUALITY(*it, std::string(DetectCompressionCodec(compressed.data(), compressed.size())->Name()));
+        RRLIB_UNIT_TESTS_ASSERT(*it == "inverting" || compressed.size() < plain.size() / 2);
+
+        std::string decompressed(plain.size() + 1, 0);
+        size_t position = 0;
+        auto decompressor = GetCompressionCodec(*it)->CreateDecompressor([&](char *data, size_t size)
+        {
+          const size_t count = std::min(size, compressed.size() - position);
+          std::memcpy(data, compressed.data() + position, count);
+          position += count;
+          return count;
+        });
+        decompressed.resize(decompressor->Read(&decompressed[0], decompressed.size()));
+        RRLIB_UNIT_TESTS_EQUALITY(plain, decompressed);
+
+        RRLIB_UNIT_TESTS_EQUALITY(root_node.GetXMLDump(true), tDocument(std::string(filename), false).RootNode().GetXMLDump(true));
+        RRLIB_UNIT_TESTS_EQUALITY(root_node.GetXMLDump(true), tDocument(compressed.data(), compressed.size(), false).RootNode().GetXMLDump(true));
+        if (*it != "inverting")
+        {
+          RRLIB_UNIT_TESTS_EXCEPTION(tDocument(compressed.data(), compressed.size() / 2, false), tException);
+        }
+      }
+      document.WriteToFileAsync(filename, *it).get();
+      RRLIB_UNIT_TESTS_EQUALITY(root_node.GetXMLDump(true), tDocument(std::string(filename), false).RootNode().GetXMLDump(true));
+    }
+    RRLIB_UNIT_TESTS_EXCEPTION(document.WriteToFile(filename, "unknown"), tException);
+    remove(filename);
+  }
+
+  void Fingerprints()
+  {
+    const char xml[] = "<config><motor id=\"1\" gain=\"0.5\">fast<!-- note --><![CDATA[ mode]]></motor><sensor/></config>";
+    const char reordered_xml[] = "<config><motor gain=\"0.5\" id=\"1\">fast mode</motor><sensor></sensor></config>";
+    tDocument first(xml, sizeof(xml), false);
+    tDocument second(reordered_xml, sizeof(reordered_xml), false);
+    tNode &first_root = first.RootNode();
+    tNode &second_root = second.RootNode();
+    RRLIB_UNIT_TESTS_EQUALITY(first_root.Fingerprint(), second_root.Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(first_root.DeepEquals(second_root));
+
+    second_root.FirstChild().SetAttribute("gain", 0.25);
+    RRLIB_UNIT_TESTS_ASSERT(first_root.Fingerprint() != second_root.Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(!first_root.DeepEquals(second_root));
+    RRLIB_UNIT_TESTS_ASSERT(first_root.ChildrenBegin()->DeepEquals(*first_root.ChildrenBegin()));
+
+    first.EnableFingerprintCache();
+    second.EnableFingerprintCache();
+    RRLIB_UNIT_TESTS_ASSERT(!first_root.DeepEquals(second_root));
+    RRLIB_UNIT_TESTS_ASSERT(first_root.DeepEquals(first_root));
+    RRLIB_UNIT_TESTS_ASSERT(!first.RootNode().FirstChild().DeepEquals(second_root.FirstChild()));
+
+    const uint64_t unchanged = first_root.Fingerprint();
+    tNode &sensor = first_root.FirstChild().NextSibling();
+    sensor.SetAttribute("rate", 100);
+    RRLIB_UNIT_TESTS_ASSERT(first_root.Fingerprint() != unchanged);
+    sensor.RemoveAttribute("rate");
+    RRLIB_UNIT_TESTS_EQUALITY(unchanged, first_root.Fingerprint());
+    sensor.AddChildNode("filter");
+    RRLIB_UNIT_TESTS_ASSERT(first_root.Fingerprint() != unchanged);
+    sensor.RemoveChildNode(sensor.FirstChild());
+    RRLIB_UNIT_TESTS_EQUALITY(unchanged, first_root.Fingerprint());
+    first_root.FirstChild().AddTextContent("!");
+    RRLIB_UNIT_TESTS_ASSERT(first_root.Fingerprint() != unchanged);
+    first_root.FirstChild().SetContent("fast mode");
+    RRLIB_UNIT_TESTS_EQUALITY(unchanged, first_root.Fingerprint());
+
+    second_root.FirstChild().SetAttribute("gain", 0.5);
+    RRLIB_UNIT_TESTS_ASSERT(first_root.DeepEquals(second_root));
+    tDocument spare;
+    spare.AddRootNode("spare").AddChildNode("a");
+    spare.EnableFingerprintCache();
+    const uint64_t spare_fingerprint = spare.RootNode().Fingerprint();
+    second_root.AddChildNode(spare.RootNode().FirstChild());
+    RRLIB_UNIT_TESTS_ASSERT(spare.RootNode().Fingerprint() != spare_fingerprint);
+    RRLIB_UNIT_TESTS_ASSERT(!first_root.DeepEquals(second_root));
+    first_root.AddChildNode("a");
+    RRLIB_UNIT_TESTS_ASSERT(first_root.DeepEquals(second_root));
+
+    tDocument uncached(xml, sizeof(xml), false);
+    first.DisableFingerprintCache();
+    RRLIB_UNIT_TESTS_EQUALITY(uncached.RootNode().Fingerprint(), tDocument(xml, sizeof(xml), false).RootNode().Fingerprint());
+
+    // Values only defaulted by the DTD do not match present attributes
+    const char defaulted_xml[] = "<!DOCTYPE r [<!ATTLIST e flag CDATA \"true\">]><r><e flag=\"true\"/><e x=\"1\"/></r>";
+    tDocument defaulted(defaulted_xml, sizeof(defaulted_xml), false);
+    RRLIB_UNIT_TESTS_ASSERT(!defaulted.RootNode().FirstChild().DeepEquals(defaulted.RootNode().FirstChild().NextSibling()));
+
+    // Names are qualified by the namespace URI, but the prefix does not matter
+    const char namespaced_xml[] = "<r><a:x xmlns:a=\"urn:one\" a:k=\"1\"/><b:x xmlns:b=\"urn:two\" k=\"1\"/><c:x xmlns:c=\"urn:one\" c:k=\"1\"/>"
+                                  "<b:x xmlns:b=\"urn:two\" b:k=\"1\"/></r>";
+    tDocument namespaced(namespaced_xml, sizeof(namespaced_xml), false);
+    const tNode &one = namespaced.RootNode().ChildAt(0);
+    const tNode &two = namespaced.RootNode().ChildAt(1);
+    RRLIB_UNIT_TESTS_ASSERT(one.Fingerprint() != two.Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(!one.DeepEquals(two));
+    RRLIB_UNIT_TESTS_EQUALITY(one.Fingerprint(), namespaced.RootNode().ChildAt(2).Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(one.DeepEquals(namespaced.RootNode().ChildAt(2)));
+    RRLIB_UNIT_TESTS_ASSERT(two.Fingerprint() != namespaced.RootNode().ChildAt(3).Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(!two.DeepEquals(namespaced.RootNode().ChildAt(3)));
+
+    // Entity references count as their replacement text
+    const char entity_xml[] = "<!DOCTYPE r [<!ENTITY e \"hello\">]><r><a>&e;</a><a></a><a>hello</a><a>say &e;!</a><a>say hello!</a></r>";
+    tDocument entities(entity_xml, sizeof(entity_xml), false);
+    const tNode &reference = entities.RootNode().ChildAt(0);
+    RRLIB_UNIT_TESTS_ASSERT(reference.Fingerprint() != entities.RootNode().ChildAt(1).Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(!reference.DeepEquals(entities.RootNode().ChildAt(1)));
+    RRLIB_UNIT_TESTS_EQUALITY(reference.Fingerprint(), entities.RootNode().ChildAt(2).Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(reference.DeepEquals(entities.RootNode().ChildAt(2)));
+    RRLIB_UNIT_TESTS_EQUALITY(entities.RootNode().ChildAt(3).Fingerprint(), entities.RootNode().ChildAt(4).Fingerprint());
+    RRLIB_UNIT_TESTS_ASSERT(entities.RootNode().ChildAt(3).DeepEquals(entities.RootNode().ChildAt(4)));
+
+    // Fingerprints of const documents are memoized by concurrent readers
+    tDocument shared;
+    tNode &shared_root = shared.AddRootNode("modules");
+    for (int i = 0; i < 200; ++i)
+    {
+      shared_root.AddChildNode("module").AddChildNode("parameter", std::to_string(i % 10)).SetAttribute("index", i % 10);
+    }
+    const tDocument uncached_copy(shared.RootNode().GetXMLDump().c_str(), shared.RootNode().GetXMLDump().size(), false);
+    shared.EnableFingerprintCache();
+    const tDocument &const_shared = shared;
+    std::atomic<int> fingerprint_mismatches(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+      readers.emplace_back([&, i]
+      {
+        const tNode &modules = const_shared.RootNode();
+        for (size_t j = 0; j < modules.ChildCount(); ++j)
+        {
+          const size_t k = (j + i * 50) % modules.ChildCount();
+          fingerprint_mismatches += modules.ChildAt(k).Fingerprint() != uncached_copy.RootNode().ChildAt(k).Fingerprint();
+          fingerprint_mismatches += !modules.ChildAt(k).DeepEquals(modules.ChildAt((k + 10) % modules.ChildCount()));
+        }
+        fingerprint_mismatches += modules.Fingerprint() != uncached_copy.RootNode().Fingerprint();
+      });
+    }
+    for (auto it = readers.begin(); it != readers.end(); ++it)
+    {
+      it->join();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(0, fingerprint_mismatches.load());
+  }
+
+  void ModificationTracking()
+  {
+    char filename[] = "/tmp/tmp.XXXXXX";
+    close(mkstemp(filename));
+
+    tDocument document;
+    RRLIB_UNIT_TESTS_EQUALITY(false, document.IsModified());
+    RRLIB_UNIT_TESTS_EQUALITY(false, document.WriteToFileIfModified(filename));
+    tNode &root_node = document.AddRootNode("state");
+    RRLIB_UNIT_TESTS_EQUALITY(true, document.IsModified());
+    tNode &counter = root_node.AddChildNode("counter");
+    counter.SetAttribute("value", 1);
+    RRLIB_UNIT_TESTS_EQUALITY(true, document.WriteToFileIfModified(filename));
+    RRLIB_UNIT_TESTS_EQUALITY(false, document.IsModified());
+    RRLIB_UNIT_TESTS_EQUALITY(false, document.WriteToFileIfModified(filename));
+
+    const uint64_t generation = document.Generation();
+    counter.GetIntAttribute("value");
+    root_node.GetXMLDump();
+    RRLIB_UNIT_TESTS_EQUALITY(generation, document.Generation());
+
+    std::vector<std::function<void()>> modifications =
+    {
+      [&] { counter.SetAttribute("value", 2); },
+      [&] { counter.RemoveAttribute("value"); },
+      [&] { counter.SetContent("text"); },
+      [&] { counter.AddTextContent(" more"); },
+      [&] { counter.RemoveTextContent(); },
+      [&] { counter.AddNextSibling("sibling"); },
+      [&] { root_node.RemoveChildNode(counter.NextSibling()); }
+    };
+    for (auto it = modifications.begin(); it != modifications.end(); ++it)
+    {
+      const uint64_t before = document.Generation();
+      (*it)();
+      RRLIB_UNIT_TESTS_ASSERT(document.Generation() > before);
+      RRLIB_UNIT_TESTS_EQUALITY(true, document.IsModified());
+      document.WriteToFile(filename);
+      RRLIB_UNIT_TESTS_EQUALITY(false, document.IsModified());
+    }
+
+    tDocument loaded(std::string(filename), false);
+    RRLIB_UNIT_TESTS_EQUALITY(false, loaded.IsModified());
+    loaded.RootNode().FirstChild().SetAttribute("value", 3);
+    RRLIB_UNIT_TESTS_EQUALITY(true, loaded.WriteToFileIfModified(filename));
+    RRLIB_UNIT_TESTS_EQUALITY(3, tDocument(std::string(filename), false).RootNode().FirstChild().GetIntAttribute("value"));
+    remove(filename);
+  }
+
+  void WriteToFileParallel()
+  {
+    char filename[] = "/tmp/tmp.XXXXXX";
+    close(mkstemp(filename));
+    const std::string parallel_filename = std::string(filename) + ".parallel";
+
+    tDocument generated;
+    tNode &root_node = generated.AddRootNode("log");
+    root_node.SetAttribute("note", "<\"escaped\"> & \xc3\xa4");
+    for (int i = 0; i < 1000; ++i)
+    {
+      tNode &entry = root_node.AddChildNode("entry", i % 3 ? "" : "value &lt; " + std::to_string(i));
+      entry.SetAttribute("index", i);
+      entry.SetAttribute("unit", "\xc2\xb5m\t");
+      if (i % 7 == 0)
+      {
+        entry.AddChildNode("nested").AddChildNode("deeper", "\xc3\xbc\r");
+      }
+    }
+
+    const char mixed_xml[] = "<m:root xmlns:m=\"urn:m\" a=\"1\">text<m:a>x</m:a><!-- c --><b/><?pi data?><![CDATA[<raw>]]>tail</m:root>";
+    const char blank_xml[] = "<root>\n  <a><b/></a>\n  <!-- c -->\n  <c d=\"e\"/>\n</root>";
+    const char compact_xml[] = "<root><!-- c --><a><!--d--><b/></a><?pi data?></root>";
+    const char doctype_xml[] = "<!DOCTYPE root><root><a/></root>";
+    const char single_xml[] = "<root/>";
+    const char latin_xml[] = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><root><a b=\"\xe4\"/><c>\xfc</c></root>";
+    std::vector<tDocument> documents;
+    documents.push_back(std::move(generated));
+    documents.push_back(tDocument(mixed_xml, sizeof(mixed_xml) - 1, false));
+    documents.push_back(tDocument(blank_xml, sizeof(blank_xml) - 1, false));
+    documents.push_back(tDocument(compact_xml, sizeof(compact_xml) - 1, false));
+    documents.push_back(tDocument(doctype_xml, sizeof(doctype_xml) - 1, false));
+    documents.push_back(tDocument(single_xml, sizeof(single_xml) - 1, false));
+    documents.push_back(tDocument(latin_xml, sizeof(latin_xml) - 1, false));
+
+    for (auto it = documents.begin(); it != documents.end(); ++it)
+    {
+      it->WriteToFile(filename);
+      const std::string expected = ReadFile(filename);
+      for (unsigned int threads = 0; threads < 5; ++threads)
+      {
+        it->WriteToFileParallel(parallel_filename, threads);
+        RRLIB_UNIT_TESTS_EQUALITY(expected, ReadFile(parallel_filename));
+      }
+      RRLIB_UNIT_TESTS_EQUALITY(false, it->IsModified());
+    }
+    RRLIB_UNIT_TESTS_EXCEPTION(documents.front().WriteToFileParallel("/nonexistent/directory/file.xml"), tException);
+
+    remove(filename);
+    remove(parallel_filename.c_str());
+  }
+
+  void WriterSubtree()
+  {
+    char filename[] = "/tmp/tmp.XXXXXX";
+    close(mkstemp(filename));
+
+    tDocument generated;
+    tNode &root_node = generated.AddRootNode("root");
+    root_node.SetAttribute("escaped", "\"<&>\n\t\r' \xc3\xa4 long enough to be scanned in blocks \"");
+    root_node.AddChildNode("text", "clean text that spans several blocks of sixteen bytes &amp; ends with \r");
+    root_node.AddChildNode("unicode", "\xc3\xa4\xc3\xb6\xc3\xbc <>").SetAttribute("name", "\xc2\xb5");
+    tNode *deep = &root_node.AddChildNode("deep");
+    for (int i = 0; i < 35; ++i)
+    {
+      deep = &deep->AddChildNode("level");
+    }
+    tNode &cdata = root_node.AddChildNode("cdata");
+    xmlNodePtr cdata_node = reinterpret_cast<xmlNodePtr>(&cdata);
+    xmlAddChild(cdata_node, xmlNewCDataBlock(cdata_node->doc, reinterpret_cast<const xmlChar *>("a]]>b]]]>"), 9));
+    xmlAddChild(cdata_node, xmlNewCDataBlock(cdata_node->doc, reinterpret_cast<const xmlChar *>(""), 0));
+
+    const char namespaces_xml[] = "<m:root xmlns:m=\"urn:m\" xmlns=\"urn:'d'\" xmlns:q='urn:\"q\"' m:a=\"1\">text<m:a>x</m:a><!-- c --><b/><?pi data?><![CDATA[<raw>]]>tail</m:root>";
+    const char compact_xml[] = "<root><!-- c --><a><!--d--><b q=\"&quot;&lt;\"/><?pi?></a><c>\n  <d/>\n</c></root>";
+    const char blank_xml[] = "<root>\n  <a><b/></a>\n  <!-- c -->\n  <c d=\"e\"/>\n</root>";
+    std::vector<tDocument> documents;
+    documents.push_back(std::move(generated));
+    documents.push_back(tDocument(namespaces_xml, sizeof(namespaces_xml) - 1, false));
+    documents.push_back(tDocument(compact_xml, sizeof(compact_xml) - 1, false));
+    documents.push_back(tDocument(blank_xml, sizeof(blank_xml) - 1, false));
+
+    for (auto it = documents.begin(); it != documents.end(); ++it)
+    {
+      it->WriteToFile(filename);
+      std::string output;
+      tWriter writer(&output);
+      writer.WriteSubtree(it->RootNode());
+      writer.Close();
+      RRLIB_UNIT_TESTS_EQUALITY(ReadFile(filename), output);
+    }
+
+    const char entities_xml[] = "<!DOCTYPE r [<!ENTITY e \"v\">]><r a=\"x&e;\"><s>&e;</s></r>";
+    tDocument entities(entities_xml, sizeof(entities_xml) - 1, false);
+    std::string output;
+    tWriter writer(&output);
+    writer.StartElement("outer");
+    writer.WriteSubtree(entities.RootNode());
+    writer.WriteSubtree(entities.RootNode().FirstChild());
+    writer.Close();
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<outer>\n  <r a=\"x&e;\">\n    <s>&e;</s>\n  </r>\n  <s>&e;</s>\n</outer>\n"), output);
+    RRLIB_UNIT_TESTS_EXCEPTION(writer.WriteSubtree(entities.RootNode()), tException);
+    remove(filename);
+  }
+  void EventEmitter()
+  {
+    std::string output;
+    {
+      tEventEmitter emitter([&output](const char *data, size_t size)
+      {
+        output.append(data, size);
+      }, "telemetry", 1 << 18, 256);
+      const std::string mode = "auto & \"manual\"";
+
+      const size_t allocations = allocation_count;
+      for (int i = 0; i < 1000; ++i)
+      {
+        emitter.StartElement("cycle");
+        emitter.Attribute("index", i);
+        emitter.Attribute("time", i * 0.001);
+        emitter.Attribute("ok", i % 2 == 0);
+        emitter.Attribute("mode", mode);
+        emitter.StartElement("joint");
+        emitter.Attribute("name", "elbow");
+        emitter.Text("<1.5>");
+        emitter.EndElement();
+        emitter.StartElement("empty");
+        emitter.EndElement();
+        RRLIB_UNIT_TESTS_ASSERT(emitter.EndElement());
+      }
+      RRLIB_UNIT_TESTS_EQUALITY(allocations, allocation_count);
+      RRLIB_UNIT_TESTS_EQUALITY(uint64_t(0), emitter.DroppedRecords());
+
+      RRLIB_UNIT_TESTS_EXCEPTION(emitter.EndElement(), tException);
+      RRLIB_UNIT_TESTS_EXCEPTION(emitter.Attribute("a", 1), tException);
+      emitter.StartElement("incomplete");
+      emitter.Text("text");
+      RRLIB_UNIT_TESTS_EXCEPTION(emitter.Attribute("a", 1), tException);
+      emitter.Close();
+      RRLIB_UNIT_TESTS_EXCEPTION(emitter.StartElement("closed"), tException);
+    }
+    const std::string first_record = "  <cycle index=\"0\" time=\"0\" ok=\"true\" mode=\"auto &amp; &quot;manual&quot;\"><joint name=\"elbow\">&lt;1.5&gt;</joint><empty/></cycle>\n";
+    const std::string expected_start = std::string("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<telemetry>\n") + first_record;
+    RRLIB_UNIT_TESTS_EQUALITY(expected_start, output.substr(0, expected_start.size()));
+    tDocument document(output.data(), output.size(), false);
+    int index = 0;
+    for (auto it = document.RootNode().ChildrenBegin(); it != document.RootNode().ChildrenEnd(); ++it, ++index)
+    {
+      RRLIB_UNIT_TESTS_EQUALITY(index, it->GetIntAttribute("index"));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(1000, index);
+
+    // A blocked sink makes the ring buffer overflow
+    output.clear();
+    std::atomic<bool> blocked(false);
+    tEventEmitter emitter([&output, &blocked](const char *data, size_t size)
+    {
+      while (blocked.load())
+      {
+        std::this_thread::yield();
+      }
+      output.append(data, size);
+    }, "telemetry", 256, 64);
+    blocked = true;
+    const int cRECORDS = 200;
+    int committed = 0;
+    for (int i = 0; i < cRECORDS; ++i)
+    {
+      emitter.StartElement("r");
+      emitter.Attribute("i", i);
+      committed += emitter.EndElement();
+    }
+    emitter.StartElement("oversized");
+    emitter.Text("this text does not fit into a record of at most sixty-four characters");
+    RRLIB_UNIT_TESTS_ASSERT(!emitter.EndElement());
+    for (size_t i = 0; i <= tEventEmitter::cMAX_DEPTH; ++i)
+    {
+      emitter.StartElement("deep");
+    }
+    emitter.Attribute("a", 1);
+    emitter.Text("text");
+    for (size_t i = 0; i < tEventEmitter::cMAX_DEPTH; ++i)
+    {
+      RRLIB_UNIT_TESTS_ASSERT(emitter.EndElement());
+    }
+    RRLIB_UNIT_TESTS_ASSERT(!emitter.EndElement());
+    blocked = false;
+    emitter.Close();
+
+    RRLIB_UNIT_TESTS_ASSERT(committed < cRECORDS);
+    RRLIB_UNIT_TESTS_EQUALITY(uint64_t(cRECORDS - committed + 2), emitter.DroppedRecords());
+    tDocument overflowed(output.data(), output.size(), false);
+    int records = 0;
+    uint64_t reported_drops = 0;
+    std::string last_name;
+    for (auto it = overflowed.RootNode().ChildrenBegin(); it != overflowed.RootNode().ChildrenEnd(); ++it)
+    {
+      last_name = it->Name();
+      if (it->Name() == "dropped")
+      {
+        reported_drops += it->GetIntAttribute("count");
+      }
+      else
+      {
+        RRLIB_UNIT_TESTS_EQUALITY(std::string("r"), it->Name());
+        records++;
+      }
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(committed, records);
+    RRLIB_UNIT_TESTS_EQUALITY(emitter.DroppedRecords(), reported_drops);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("dropped"), last_name);
+
+    RRLIB_UNIT_TESTS_EXCEPTION(tEventEmitter("/nonexistent/directory/file.xml"), tException);
+  }
+  void ArenaAllocation()
+  {
+    char filename[] = "/tmp/tmp.XXXXXX";
+    close(mkstemp(filename));
+
+    auto build = [](tDocument & document)
+    {
+      tNode &root_node = document.AddRootNode("root");
+      root_node.SetAttribute("name", "arena");
+      for (int i = 0; i < 1000; ++i)
+      {
+        tNode &entry = root_node.AddChildNode("entry", "text " + std::to_string(i));
+        entry.SetAttribute("index", i);
+        entry.SetAttribute("index", i * 2);
+        entry.AddTextContent(" more");
+        if (i % 10 == 0)
+        {
+          entry.AddNextSibling("sibling").SetBinaryContent("binary", 6);
+        }
+      }
+      root_node.RemoveAttribute("name");
+      root_node.RemoveChildNode(root_node.FirstChild());
+      tNode &large = root_node.AddChildNode("large");
+      large.SetContent(std::string(3 << 20, 'x'));
+      for (int i = 0; i < 100; ++i)
+      {
+        large.AddTextContent(std::string(1000, 'y'));
+      }
+    };
+    tDocument heap_document;
+    build(heap_document);
+    std::unique_ptr<tDocument> arena_document(new tDocument(tDocument::cARENA_ALLOCATION));
+    build(*arena_document);
+    RRLIB_UNIT_TESTS_ASSERT(arena_document->UsesArena());
+    RRLIB_UNIT_TESTS_ASSERT(!heap_document.UsesArena());
+    RRLIB_UNIT_TESTS_EQUALITY(heap_document.RootNode().GetXMLDump(), arena_document->RootNode().GetXMLDump());
+
+    // Parsing, also while other documents are created and destroyed on the heap
+    arena_document->WriteToFile(filename);
+    tDocument loaded(tDocument::cARENA_ALLOCATION, std::string(filename), false);
+    {
+      tDocument heap_loaded(std::string(filename), false);
+      RRLIB_UNIT_TESTS_ASSERT(heap_loaded.RootNode().DeepEquals(loaded.RootNode()));
+    }
+    const char xml[] = "<config><value id=\"1\">a &amp; b</value><value id=\"2\"/></config>";
+    tDocument from_memory(tDocument::cARENA_ALLOCATION, xml, sizeof(xml) - 1, false);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("a & b"), from_memory.RootNode().FirstChild().GetTextContent());
+    RRLIB_UNIT_TESTS_EXCEPTION(tDocument(tDocument::cARENA_ALLOCATION, "<broken", 7, false), tException);
+
+    // Nodes moved between arena and heap documents are copied and survive their origin
+    const std::string moved_dump = arena_document->RootNode().FirstChild().GetXMLDump();
+    tNode &moved_to_heap = heap_document.RootNode().AddChildNode(arena_document->RootNode().FirstChild());
+    tNode &moved_to_arena = from_memory.RootNode().AddChildNode(heap_document.RootNode().FirstChild());
+    from_memory.RootNode().FirstChild().AddNextSibling(loaded.RootNode().FirstChild());
+    arena_document.reset();
+    RRLIB_UNIT_TESTS_EQUALITY(moved_dump, moved_to_heap.GetXMLDump());
+    RRLIB_UNIT_TESTS_EQUALITY(moved_dump, moved_to_arena.GetXMLDump());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(4), from_memory.RootNode().GetNumberOfChildren());
+
+    // Assignment keeps the allocation mode
+    tDocument assigned(tDocument::cARENA_ALLOCATION);
+    assigned = heap_document;
+    RRLIB_UNIT_TESTS_ASSERT(assigned.UsesArena());
+    RRLIB_UNIT_TESTS_ASSERT(assigned.RootNode().DeepEquals(heap_document.RootNode()));
+    tDocument moved(std::move(assigned));
+    RRLIB_UNIT_TESTS_ASSERT(moved.UsesArena());
+    RRLIB_UNIT_TESTS_ASSERT(moved.RootNode().DeepEquals(heap_document.RootNode()));
+
+    remove(filename);
+  }
+
+  void NodeBuilder()
+  {
+    auto build = [](tDocument & document)
+    {
+      tNode &root_node = document.AddRootNode("root");
+      root_node.AddChildNode("existing");
+      tNodeBuilder builder(root_node);
+      const tNodeBuilder::tName entry = builder.Intern("entry");
+      const tNodeBuilder::tName index = builder.Intern("index");
+      const tNodeBuilder::tName scale = builder.Intern("scale");
+      const tNodeBuilder::tName valid = builder.Intern("valid");
+      RRLIB_UNIT_TESTS_ASSERT(entry == builder.Intern("entry"));
+      RRLIB_UNIT_TESTS_EXCEPTION(builder.Attribute(index, 0), tException);
+      for (int i = 0; i < 100; ++i)
+      {
+        builder.AddChild(entry, "text " + std::to_string(i));
+        builder.Attribute(index, i);
+        builder.Attribute(scale, i * 0.25);
+        builder.Attribute(valid, i % 2 == 0);
+      }
+      builder.AddChild(builder.Intern("empty"));
+      builder.Attribute(builder.Intern("note"), "");
+    };
+    auto build_with_nodes = [](tDocument & document)
+    {
+      tNode &root_node = document.AddRootNode("root");
+      root_node.AddChildNode("existing");
+      for (int i = 0; i < 100; ++i)
+      {
+        tNode &entry = root_node.AddChildNode("entry", "text " + std::to_string(i));
+        entry.SetAttribute("index", i);
+        entry.SetAttribute("scale", i * 0.25);
+        entry.SetAttribute("valid", i % 2 == 0);
+      }
+      root_node.AddChildNode("empty").SetAttribute("note", "");
+    };
+    tDocument expected;
+    build_with_nodes(expected);
+    tDocument document;
+    build(document);
+    RRLIB_UNIT_TESTS_EQUALITY(expected.RootNode().GetXMLDump(), document.RootNode().GetXMLDump());
+    RRLIB_UNIT_TESTS_ASSERT(expected.RootNode().DeepEquals(document.RootNode()));
+
+    tDocument arena_document(tDocument::cARENA_ALLOCATION);
+    build(arena_document);
+    RRLIB_UNIT_TESTS_EQUALITY(expected.RootNode().GetXMLDump(), arena_document.RootNode().GetXMLDump());
+
+    // Text is not parsed and nodes created by the builder behave like all others
+    tNode &root_node = document.RootNode();
+    tNodeBuilder builder(root_node.FirstChild());
+    tNode &raw = builder.AddChild(builder.Intern("raw"), "a &amp; b");
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("a &amp; b"), raw.GetTextContent());
+    raw.SetAttribute("index", 1);
+    RRLIB_UNIT_TESTS_EQUALITY(1, raw.GetIntAttribute("index"));
+    while (root_node.HasChildren())
+    {
+      root_node.RemoveChildNode(root_node.FirstChild());
+    }
+  }
+
+  void BulkMutation()
+  {
+    tDocument document;
+    tNode &root_node = document.AddRootNode("root");
+    for (int i = 0; i < 1000; ++i)
+    {
+      root_node.AddChildNode("entry", "text").SetAttribute("index", i);
+      root_node.AddTextContent(" ");
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(500), root_node.RemoveChildrenIf([](const tNode & node)
+    {
+      return node.GetIntAttribute("index") % 2 == 1;
+    }));
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(500), root_node.GetNumberOfChildren());
+    RRLIB_UNIT_TESTS_EQUALITY(2, root_node.FirstChild().NextSibling().GetIntAttribute("index"));
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.RemoveChildNode(root_node), tException);
+    root_node.RemoveTextContent();
+    RRLIB_UNIT_TESTS_ASSERT(root_node.GetTextContent().find(' ') == std::string::npos);
+
+    // Moving nodes within a document
+    tNode &target = root_node.AddChildNode("target");
+    tNode &moved = root_node.FirstChild();
+    target.AddChildNode(moved);
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(500), root_node.GetNumberOfChildren());
+    RRLIB_UNIT_TESTS_EQUALITY(2, root_node.FirstChild().GetIntAttribute("index"));
+    RRLIB_UNIT_TESTS_ASSERT(&target.FirstChild() == &moved);
+
+    tNode *first = &root_node.FirstChild();
+    tNode *last = first;
+    for (int i = 0; i < 9; ++i)
+    {
+      last = &last->NextSibling();
+    }
+    RRLIB_UNIT_TESTS_EXCEPTION(target.AddChildNodes(*last, *first), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(target.AddChildNodes(*first, moved), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(moved.AddChildNodes(*first, target), tException);
+    RRLIB_UNIT_TESTS_ASSERT(&target.AddChildNodes(*first, *last) == first);
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(11), target.GetNumberOfChildren());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(490), root_node.GetNumberOfChildren());
+    RRLIB_UNIT_TESTS_EQUALITY(22, root_node.FirstChild().GetIntAttribute("index"));
+    int expected_index = 0;
+    for (auto it = target.ChildrenBegin(); it != target.ChildrenEnd(); ++it, expected_index += 2)
+    {
+      RRLIB_UNIT_TESTS_EQUALITY(expected_index, it->GetIntAttribute("index"));
+      RRLIB_UNIT_TESTS_ASSERT(&it->Parent() == &target);
+    }
+    const std::string dump = root_node.GetXMLDump();
+    tDocument reparsed(dump.data(), dump.size(), false);
+    RRLIB_UNIT_TESTS_ASSERT(reparsed.RootNode().DeepEquals(root_node));
+
+    // Moving ranges between documents, with and without arena
+    tDocument other;
+    tNode &other_root = other.AddRootNode("other");
+    other_root.AddChildNodes(target.FirstChild(), target.FirstChild().NextSibling());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(2), other_root.GetNumberOfChildren());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(9), target.GetNumberOfChildren());
+    tDocument arena_document(tDocument::cARENA_ALLOCATION);
+    tNode &arena_root = arena_document.AddRootNode("arena");
+    tNode &copied = arena_root.AddChildNodes(other_root.FirstChild(), other_root.FirstChild().NextSibling());
+    RRLIB_UNIT_TESTS_EQUALITY(0, copied.GetIntAttribute("index"));
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(2), arena_root.GetNumberOfChildren());
+    RRLIB_UNIT_TESTS_ASSERT(!other_root.HasChildren());
+
+    root_node.RemoveAllChildren();
+    RRLIB_UNIT_TESTS_ASSERT(!root_node.HasChildren());
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("<root/>"), root_node.GetXMLDump());
+  }
+
+  void CrossDocumentMove()
+  {
+    const std::string module = "<module xmlns:m=\"urn:module\"><m:parameter name=\"gain\" id=\"p1\">1.5</m:parameter>"
+                               "<parameter name=\"offset\">a</parameter><group><parameter name=\"x\"/></group></module>";
+    tDocument master;
+    tNode &master_root = master.AddRootNode("master");
+    const char master_xml[] = "<master/>";
+    tDocument parsed_master(master_xml, sizeof(master_xml) - 1, false);
+    for (int i = 0; i < 3; ++i)
+    {
+      std::unique_ptr<tDocument> source(new tDocument(module.data(), module.size(), false));
+      tNode &source_root = source->RootNode();
+      tNode &first = source_root.FirstChild();
+      tNode &moved = master_root.AddChildNode(first);
+      RRLIB_UNIT_TESTS_ASSERT(&moved == &first);
+      tNode &group = source_root.FirstChild().NextSibling();
+      RRLIB_UNIT_TESTS_ASSERT(&master_root.FirstChild().AddNextSibling(group) == &group);
+      tNode &range_first = source_root.FirstChild();
+      parsed_master.RootNode().AddChildNodes(range_first, range_first);
+      RRLIB_UNIT_TESTS_ASSERT(!source_root.HasChildren());
+      source.reset();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(6), master_root.GetNumberOfChildren());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(3), parsed_master.RootNode().GetNumberOfChildren());
+    const std::string dump = master_root.GetXMLDump();
+    RRLIB_UNIT_TESTS_ASSERT(dump.find("xmlns:m=\"urn:module\"") != std::string::npos);
+    tDocument reparsed(dump.data(), dump.size(), false);
+    RRLIB_UNIT_TESTS_ASSERT(reparsed.RootNode().DeepEquals(master_root));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("gain"), master_root.FirstChild().GetStringAttribute("name"));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("a"), parsed_master.RootNode().FirstChild().GetTextContent());
+    master_root.RemoveAllChildren();
+    parsed_master.RootNode().RemoveAllChildren();
+  }
+
+  void Snapshot()
+  {
+    tDocument document;
+    tNode &root_node = document.AddRootNode("config");
+    root_node.SetAttribute("version", 0);
+    for (int i = 0; i < 100; ++i)
+    {
+      root_node.AddChildNode("parameter").SetAttribute("value", i);
+    }
+    std::shared_ptr<const tDocument> snapshot = document.Snapshot();
+    RRLIB_UNIT_TESTS_ASSERT(snapshot == document.Snapshot());
+    RRLIB_UNIT_TESTS_ASSERT(snapshot->RootNode().DeepEquals(root_node));
+
+    // Readers keep a consistent state while the document is modified and published again
+    std::atomic<bool> stop(false);
+    std::atomic<int> inconsistent_reads(0);
+    std::vector<std::thread> readers;
+    std::shared_ptr<const tDocument> published = snapshot;
+    std::mutex published_mutex;
+    for (int i = 0; i < 2; ++i)
+    {
+      readers.emplace_back([&]
+      {
+        while (!stop)
+        {
+          std::shared_ptr<const tDocument> current;
+          {
+            std::lock_guard<std::mutex> lock(published_mutex);
+            current = published;
+          }
+          const tNode &config = current->RootNode();
+          const int version = config.GetIntAttribute("version");
+          for (auto it = config.ChildrenBegin(); it != config.ChildrenEnd(); ++it)
+          {
+            inconsistent_reads += it->GetIntAttribute("value") % 100 + version * 100 != it->GetIntAttribute("value");
+          }
+        }
+      });
+    }
+    for (int version = 1; version <= 20; ++version)
+    {
+      root_node.SetAttribute("version", version);
+      for (auto it = root_node.ChildrenBegin(); it != root_node.ChildrenEnd(); ++it)
+      {
+        it->SetAttribute("value", it->GetIntAttribute("value") + 100);
+      }
+      std::lock_guard<std::mutex> lock(published_mutex);
+      published = document.Snapshot();
+    }
+    stop = true;
+    for (auto it = readers.begin(); it != readers.end(); ++it)
+    {
+      it->join();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(0, inconsistent_reads.load());
+    RRLIB_UNIT_TESTS_EQUALITY(0, snapshot->RootNode().GetIntAttribute("version"));
+    RRLIB_UNIT_TESTS_ASSERT(published != snapshot);
+    RRLIB_UNIT_TESTS_ASSERT(published->RootNode().DeepEquals(root_node));
+
+    tDocument arena_document(tDocument::cARENA_ALLOCATION);
+    arena_document = document;
+    std::shared_ptr<const tDocument> arena_snapshot = arena_document.Snapshot();
+    RRLIB_UNIT_TESTS_ASSERT(arena_snapshot->UsesArena());
+    arena_document.RootNode().RemoveAllChildren();
+    RRLIB_UNIT_TESTS_ASSERT(arena_snapshot->RootNode().DeepEquals(root_node));
+    RRLIB_UNIT_TESTS_ASSERT(arena_snapshot != arena_document.Snapshot());
+  }
+
+  void ChildIndex()
+  {
+    tDocument document;
+    tNode &table = document.AddRootNode("table");
+    for (int i = 0; i < 1000; ++i)
+    {
+      tNode &row = table.AddChildNode("row");
+      row.SetAttribute("key", i * 2);
+      row.AddChildNode("cell", std::to_string(i));
+      table.AddTextContent("\n");
+    }
+    auto key_less = [](const tNode & row, int key)
+    {
+      return row.GetIntAttribute("key") < key;
+    };
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(1000), table.ChildCount());
+    RRLIB_UNIT_TESTS_EQUALITY(1000, table.ChildAt(500).GetIntAttribute("key"));
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(1), table.ChildAt(500).ChildCount());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(250), table.LowerBoundChild(500, key_less));
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(251), table.LowerBoundChild(501, key_less));
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(1000), table.LowerBoundChild(5000, key_less));
+    RRLIB_UNIT_TESTS_EXCEPTION(table.ChildAt(1000), tException);
+
+    // The index follows all modifications through tNode
+    table.RemoveChildNode(table.ChildAt(0));
+    RRLIB_UNIT_TESTS_EQUALITY(2, table.ChildAt(0).GetIntAttribute("key"));
+    table.ChildAt(0).AddNextSibling("row").SetAttribute("key", 3);
+    RRLIB_UNIT_TESTS_EQUALITY(3, table.ChildAt(1).GetIntAttribute("key"));
+    table.AddChildNode("row").SetAttribute("key", 2000);
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(1001), table.ChildCount());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(500), table.RemoveChildrenIf([](const tNode & row)
+    {
+      return row.GetIntAttribute("key") % 4 == 0;
+    }));
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(501), table.ChildCount());
+    tNode &last_row = table.ChildAt(500);
+    table.ChildAt(0).AddChildNode(last_row);
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(500), table.ChildCount());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(2), table.ChildAt(0).ChildCount());
+    {
+      tNodeBuilder builder(table);
+      builder.AddChild(builder.Intern("row"));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(501), table.ChildCount());
+    table.AddChildNodes(table.ChildAt(1), table.ChildAt(10));
+    RRLIB_UNIT_TESTS_EQUALITY(table.GetNumberOfChildren(), table.ChildCount());
+    size_t position = 0;
+    for (auto it = table.ChildrenBegin(); it != table.ChildrenEnd(); ++it, ++position)
+    {
+      RRLIB_UNIT_TESTS_ASSERT(&*it == &table.ChildAt(position));
+    }
+
+    // Indices of const snapshots are built by concurrent readers
+    std::shared_ptr<const tDocument> snapshot = document.Snapshot();
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+      readers.emplace_back([&]
+      {
+        const tNode &rows = snapshot->RootNode();
+        for (size_t j = 0; j < rows.ChildCount(); ++j)
+        {
+          mismatches += rows.ChildAt(j).ChildCount() != rows.ChildAt(j).GetNumberOfChildren();
+        }
+      });
+    }
+    for (auto it = readers.begin(); it != readers.end(); ++it)
+    {
+      it->join();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(0, mismatches.load());
+
+    table.SetContent("cleared");
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(0), table.ChildCount());
+    table.AddChildNode("row");
+    table.FirstChild().AddChildNode("cell");
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(1), table.ChildAt(0).ChildCount());
+    table.RemoveAllChildren();
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(0), table.ChildCount());
+  }
+
+  void Iterators()
+  {
+    const char xml[] = "<a><b><c/>text<d><e/></d></b><!-- comment --><f/>tail<b><g/></b></a>";
+    tDocument document(xml, sizeof(xml) - 1, false);
+    tNode &root_node = document.RootNode();
+    std::string names;
+    for (auto &node : root_node.Descendants())
+    {
+      names += node.Name();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("bcdefbg"), names);
+    const tNode &const_root = root_node;
+    RRLIB_UNIT_TESTS_EQUALITY(7, std::distance(const_root.Descendants().begin(), const_root.Descendants().end()));
+    RRLIB_UNIT_TESTS_ASSERT(std::find_if(const_root.Descendants().begin(), const_root.Descendants().end(), [](const tNode & node)
+    {
+      return node.Name() == "e";
+    })->Parent().Name() == "d");
+    tNode &leaf = root_node.FirstChild().FirstChild();
+    RRLIB_UNIT_TESTS_ASSERT(leaf.Descendants().begin() == leaf.Descendants().end());
+
+    // Siblings in both directions
+    names.clear();
+    auto children = root_node.Children();
+    for (auto it = std::reverse_iterator<tNode::sibling_iterator>(children.end()); it != std::reverse_iterator<tNode::sibling_iterator>(children.begin()); ++it)
+    {
+      names += it->Name();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("bfb"), names);
+    tNode::sibling_iterator middle(&root_node.FirstChild().NextSibling());
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("b"), (--middle)->Name());
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("f"), (++middle)->Name());
+    tNode::const_sibling_iterator converted = middle;
+    RRLIB_UNIT_TESTS_ASSERT(&*converted == &*middle);
+    RRLIB_UNIT_TESTS_EQUALITY(3, std::distance(const_root.Children().begin(), const_root.Children().end()));
+
+    // Children by name, with and without dictionary
+    RRLIB_UNIT_TESTS_EQUALITY(2, std::distance(root_node.ChildrenNamed("b").begin(), root_node.ChildrenNamed("b").end()));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("g"), (++root_node.ChildrenNamed("b").begin())->FirstChild().Name());
+    RRLIB_UNIT_TESTS_ASSERT(root_node.ChildrenNamed("x").begin() == root_node.ChildrenNamed("x").end());
+    tDocument created;
+    tNode &created_root = created.AddRootNode("a");
+    created_root.AddChildNode("b");
+    created_root.AddChildNode("c");
+    created_root.AddChildNode("b");
+    size_t count = 0;
+    for (const tNode &node : static_cast<const tNode &>(created_root).ChildrenNamed("b"))
+    {
+      RRLIB_UNIT_TESTS_EQUALITY(std::string("b"), node.Name());
+      ++count;
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(2), count);
+    tNode::named_child_iterator kept = created_root.ChildrenNamed("c").begin();
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("c"), kept->Name());
+  }
+
+  void MemoryFootprint()
+  {
+    const char xml[] = "<a xmlns:x=\"urn:x\"><b id=\"1\">some text</b><b id=\"2\">more text</b><!-- comment --></a>";
+    tDocument document(xml, sizeof(xml) - 1, false);
+    const tDocument::tMemoryFootprint footprint = document.MemoryFootprint();
+    RRLIB_UNIT_TESTS_ASSERT(footprint.nodes >= 5 * sizeof(xmlNode));
+    RRLIB_UNIT_TESTS_ASSERT(footprint.attributes >= 2 * sizeof(xmlAttr));
+    RRLIB_UNIT_TESTS_ASSERT(footprint.text > 0);
+    RRLIB_UNIT_TESTS_ASSERT(footprint.names > 0);
+    RRLIB_UNIT_TESTS_ASSERT(footprint.dictionary > 0);
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(0), footprint.arena);
+    RRLIB_UNIT_TESTS_EQUALITY(footprint.nodes + footprint.attributes + footprint.text + footprint.names + footprint.dictionary + footprint.caches, footprint.Total());
+
+    // Content and caches add to the footprint
+    for (int i = 0; i < 100; ++i)
+    {
+      document.RootNode().AddChildNode("c", "longer text content of the new child");
+    }
+    const tDocument::tMemoryFootprint grown = document.MemoryFootprint();
+    RRLIB_UNIT_TESTS_ASSERT(grown.nodes >= footprint.nodes + 200 * sizeof(xmlNode));
+    RRLIB_UNIT_TESTS_ASSERT(grown.text > footprint.text);
+    document.RootNode().ChildCount();
+    RRLIB_UNIT_TESTS_ASSERT(document.MemoryFootprint().caches > grown.caches);
+
+    // Documents are registered while they exist
+    const size_t live_documents = tDocument::LiveDocumentFootprints().size();
+    char filename[] = "/tmp/tmp.XXXXXX";
+    close(mkstemp(filename));
+    document.WriteToFile(filename);
+    {
+      tDocument loaded(std::string(filename), false);
+      std::unique_ptr<tDocument> arena_document(new tDocument(tDocument::cARENA_ALLOCATION, std::string(filename), false));
+      RRLIB_UNIT_TESTS_ASSERT(arena_document->MemoryFootprint().arena > 0);
+      RRLIB_UNIT_TESTS_ASSERT(arena_document->MemoryFootprint().Total() >= arena_document->MemoryFootprint().arena);
+
+      const std::vector<std::pair<std::string, tDocument::tMemoryFootprint>> footprints = tDocument::LiveDocumentFootprints();
+      RRLIB_UNIT_TESTS_EQUALITY(live_documents + 2, footprints.size());
+      RRLIB_UNIT_TESTS_EQUALITY(2, std::count_if(footprints.begin(), footprints.end(), [&filename](const std::pair<std::string, tDocument::tMemoryFootprint> &entry)
+      {
+        return entry.first == filename;
+      }));
+      RRLIB_UNIT_TESTS_ASSERT(tDocument::TotalMemoryFootprint().Total() >= loaded.MemoryFootprint().Total() + document.MemoryFootprint().Total());
+    }
+    unlink(filename);
+    RRLIB_UNIT_TESTS_EQUALITY(live_documents, tDocument::LiveDocumentFootprints().size());
+  }
+
+  void FrozenDocument()
+  {
+    const char xml[] = "<!DOCTYPE a [<!ENTITY e \"entity\">]><a version=\"3\" rate=\"0.5\" enabled=\"true\" list=\"1, 2, 3\">"
+                       "head<b name=\"first\">one<![CDATA[<two>]]></b><!-- comment --><c/>mid&e;<b name=\"&e;\"><d x=\"1\"/>three</b>tail</a>";
+    tDocument document(xml, sizeof(xml) - 1, false);
+    tFrozenDocument frozen = document.Freeze();
+    const tFrozenNode &root_node = frozen.RootNode();
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(5), frozen.NumberOfNodes());
+
+    // Structure and content match the DOM tree
+    std::function<void(const tNode &, const tFrozenNode &)> compare = [&](const tNode & node, const tFrozenNode & frozen_node)
+    {
+      RRLIB_UNIT_TESTS_EQUALITY(node.Name(), frozen_node.Name());
+      RRLIB_UNIT_TESTS_EQUALITY(node.GetTextContent(), frozen_node.GetTextContent());
+      RRLIB_UNIT_TESTS_EQUALITY(node.GetNumberOfChildren(), frozen_node.GetNumberOfChildren());
+      RRLIB_UNIT_TESTS_EQUALITY(node.HasNextSibling(), frozen_node.HasNextSibling());
+      for (xmlAttrPtr attribute = node.GetAttributeList(); attribute; attribute = attribute->next)
+      {
+        const std::string name = reinterpret_cast<const char *>(attribute->name);
+        RRLIB_UNIT_TESTS_EQUALITY(node.GetStringAttribute(name), frozen_node.GetStringAttribute(name));
+      }
+      size_t index = 0;
+      auto frozen_child = frozen_node.ChildrenBegin();
+      for (auto it = node.ChildrenBegin(); it != node.ChildrenEnd(); ++it, ++frozen_child, ++index)
+      {
+        RRLIB_UNIT_TESTS_ASSERT(frozen_child != frozen_node.ChildrenEnd());
+        RRLIB_UNIT_TESTS_ASSERT(&frozen_node.ChildAt(index) == &*frozen_child);
+        RRLIB_UNIT_TESTS_ASSERT(frozen_child->Parent() == frozen_node);
+        compare(*it, *frozen_child);
+      }
+      RRLIB_UNIT_TESTS_ASSERT(frozen_child == frozen_node.ChildrenEnd());
+    };
+    compare(document.RootNode(), root_node);
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("headone<two>midentitythreetail"), root_node.GetTextContent());
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("entity"), root_node.ChildAt(2).GetStringAttribute("name"));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("d"), root_node.FirstChild().NextSibling().NextSibling().FirstChild().Name());
+
+    // Depth-first order of descendants
+    std::string names;
+    for (auto &node : root_node.Descendants())
+    {
+      names += node.Name();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("bcbd"), names);
+    RRLIB_UNIT_TESTS_EQUALITY(0, std::distance(root_node.ChildAt(1).Descendants().begin(), root_node.ChildAt(1).Descendants().end()));
+
+    // Typed attributes
+    RRLIB_UNIT_TESTS_EQUALITY(3, root_node.GetIntAttribute("version"));
+    RRLIB_UNIT_TESTS_EQUALITY(0.5, root_node.GetDoubleAttribute("rate"));
+    RRLIB_UNIT_TESTS_ASSERT(root_node.GetBoolAttribute("enabled"));
+    std::vector<int> list;
+    root_node.GetNumericArrayAttribute("list", list);
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(3), list.size());
+    RRLIB_UNIT_TESTS_EQUALITY(3, list[2]);
+    RRLIB_UNIT_TESTS_ASSERT(!root_node.HasAttribute("missing"));
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetStringAttribute("missing"), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetIntAttribute("rate"), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.GetBoolAttribute("version"), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.Parent(), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.ChildAt(3), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.ChildAt(1).FirstChild(), tException);
+    RRLIB_UNIT_TESTS_EXCEPTION(root_node.ChildAt(2).NextSibling(), tException);
+
+    // The frozen copy is independent of the document and can be moved
+    document.RootNode().FirstChild().SetAttribute("name", "changed");
+    document.RootNode().RemoveAllChildren();
+    tFrozenDocument moved(std::move(frozen));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("first"), moved.RootNode().FirstChild().GetStringAttribute("name"));
+    RRLIB_UNIT_TESTS_ASSERT(moved.MemoryUsage() > 0);
+
+    tDocument single;
+    single.AddRootNode("root");
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(1), single.Freeze().NumberOfNodes());
+    RRLIB_UNIT_TESTS_EQUALITY(std::string(), single.Freeze().RootNode().GetTextContent());
+    RRLIB_UNIT_TESTS_EXCEPTION(tDocument().Freeze(), tException);
+  }
+
+  void Compact()
+  {
+    // Build the tree breadth-first, so depth-first order differs from allocation order
+    tDocument document;
+    tNode &root_node = document.AddRootNode("root");
+    std::vector<tNode *> level(1, &root_node);
+    for (int depth = 0; depth < 3; ++depth)
+    {
+      std::vector<tNode *> next_level;
+      for (int i = 0; i < 5; ++i)
+      {
+        for (auto it = level.begin(); it != level.end(); ++it)
+        {
+          next_level.push_back(&(*it)->AddChildNode("node", "text"));
+          next_level.back()->SetAttribute("value", i);
+        }
+      }
+      level.swap(next_level);
+    }
+    root_node.FirstChild().FirstChild().RemoveAllChildren();
+    root_node.FirstChild().GetIntAttribute("value");
+    root_node.ChildCount();
+    const std::string dump = root_node.GetXMLDump();
+    const uint64_t generation = document.Generation();
+
+    document.Compact();
+    RRLIB_UNIT_TESTS_ASSERT(document.UsesArena());
+    RRLIB_UNIT_TESTS_EQUALITY(dump, document.RootNode().GetXMLDump());
+    RRLIB_UNIT_TESTS_EQUALITY(generation, document.Generation());
+    const tNode *previous = &document.RootNode();
+    for (auto &node : document.RootNode().Descendants())
+    {
+      RRLIB_UNIT_TESTS_ASSERT(&node > previous);
+      previous = &node;
+    }
+
+    // The compacted document is fully usable
+    tNode &compacted_root = document.RootNode();
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(5), compacted_root.ChildCount());
+    RRLIB_UNIT_TESTS_EQUALITY(1, compacted_root.ChildAt(1).GetIntAttribute("value"));
+    compacted_root.ChildAt(1).SetAttribute("value", 7);
+    RRLIB_UNIT_TESTS_EQUALITY(7, compacted_root.ChildAt(1).GetIntAttribute("value"));
+    compacted_root.AddChildNode("added");
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(6), compacted_root.ChildCount());
+    tDocument other;
+    other.AddRootNode("other").AddChildNode(compacted_root.FirstChild(), true);
+    RRLIB_UNIT_TESTS_EQUALITY(compacted_root.FirstChild().GetXMLDump(), other.RootNode().FirstChild().GetXMLDump());
+
+    // Documents with arena allocation are compacted into a new arena
+    const std::string compacted_dump = compacted_root.GetXMLDump();
+    document.Compact();
+    RRLIB_UNIT_TESTS_EQUALITY(compacted_dump, document.RootNode().GetXMLDump());
+    tDocument empty;
+    empty.Compact();
+    RRLIB_UNIT_TESTS_EXCEPTION(empty.RootNode(), tException);
+  }
+
+  void Reparse()
+  {
+    const std::string message = "<state xmlns:p=\"urn:p\"><pose x=\"1\" p:y=\"2\" label=\"\"/>\n  <speed>short</speed></state>";
+    tDocument document(message.data(), message.size(), false);
+    tNode &pose = document.RootNode().FirstChild();
+    tNode &speed = document.RootNode().ChildAt(1);
+    pose.EnableAttributeCache();
+    RRLIB_UNIT_TESTS_EQUALITY(1, pose.GetIntAttribute("x"));
+    uint64_t generation = document.Generation();
+
+    // Unchanged messages do not modify the document
+    RRLIB_UNIT_TESTS_ASSERT(document.Reparse(message.data(), message.size(), false));
+    RRLIB_UNIT_TESTS_EQUALITY(generation, document.Generation());
+
+    // Values are written into the existing nodes, also if they grow or contain references
+    const std::string update = "<?xml version=\"1.0\"?>\n<state xmlns:p=\"urn:p\"><pose x=\"42\" p:y=\"2\" label=\"a&amp;b\"/>\n  <speed>a much longer text &#x41;&lt;</speed></state>";
+    RRLIB_UNIT_TESTS_ASSERT(document.Reparse(update.data(), update.size(), false));
+    RRLIB_UNIT_TESTS_ASSERT(&pose == &document.RootNode().FirstChild());
+    RRLIB_UNIT_TESTS_EQUALITY(42, pose.GetIntAttribute("x"));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("a&b"), pose.GetStringAttribute("label"));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("a much longer text A<"), speed.GetTextContent());
+    RRLIB_UNIT_TESTS_ASSERT(document.Generation() > generation);
+    RRLIB_UNIT_TESTS_EQUALITY(tDocument(update.data(), update.size(), false).RootNode().GetXMLDump(), document.RootNode().GetXMLDump());
+    RRLIB_UNIT_TESTS_ASSERT(document.Reparse(message.data(), message.size(), false));
+    RRLIB_UNIT_TESTS_EQUALITY(1, pose.GetIntAttribute("x"));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("short"), speed.GetTextContent());
+    RRLIB_UNIT_TESTS_EQUALITY(std::string(), pose.GetStringAttribute("label"));
+
+    // Messages of different shape replace the tree
+    const std::vector<std::string> different =
+    {
+      "<state xmlns:p=\"urn:p\"><pose x=\"1\" p:y=\"2\" label=\"\"/><speed>short</speed></state>",
+      "<state xmlns:p=\"urn:p\"><pose x=\"1\" y=\"2\" label=\"\"/>\n  <speed>short</speed></state>",
+      "<state xmlns:p=\"urn:p\"><pose p:y=\"2\" x=\"1\" label=\"\"/>\n  <speed>short</speed></state>",
+      "<state xmlns:p=\"urn:p\"><pose x=\"1\" p:y=\"2\" label=\"\"/>\n  <speed>short</speed><extra/></state>",
+      "<state xmlns:p=\"urn:p\"><pose x=\"1\" p:y=\"2\" label=\"\"/>\n  <speed><![CDATA[short]]></speed></state>",
+      "<state xmlns:p=\"urn:p\"><pose x=\"1\" p:y=\"2\" label=\"\"/>\n  <speed>short<!-- comment --></speed></state>"
+    };
+    for (auto it = different.begin(); it != different.end(); ++it)
+    {
+      tDocument reparsed(message.data(), message.size(), false);
+      generation = reparsed.Generation();
+      RRLIB_UNIT_TESTS_ASSERT(!reparsed.Reparse(it->data(), it->size(), false));
+      RRLIB_UNIT_TESTS_ASSERT(reparsed.Generation() > generation);
+      RRLIB_UNIT_TESTS_EQUALITY(tDocument(it->data(), it->size(), false).RootNode().GetXMLDump(), reparsed.RootNode().GetXMLDump());
+      // The tree parsed from CDATA sections and comments cannot be updated in place
+      RRLIB_UNIT_TESTS_EQUALITY(it - different.begin() < 4, reparsed.Reparse(it->data(), it->size(), false));
+    }
+
+    // Malformed messages leave the document unchanged
+    const std::string dump = document.RootNode().GetXMLDump();
+    const std::string malformed = "<state xmlns:p=\"urn:p\"><pose x=\"7\" p:y=\"2\" label=\"\"/>\n  <speed>short</speed>";
+    RRLIB_UNIT_TESTS_EXCEPTION(document.Reparse(malformed.data(), malformed.size(), false), tException);
+    RRLIB_UNIT_TESTS_EQUALITY(dump, document.RootNode().GetXMLDump());
+    RRLIB_UNIT_TESTS_EQUALITY(1, pose.GetIntAttribute("x"));
+
+    // Arena documents stay arena documents
+    tDocument arena_document(tDocument::cARENA_ALLOCATION, message.data(), message.size(), false);
+    RRLIB_UNIT_TESTS_ASSERT(arena_document.Reparse(update.data(), update.size(), false));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("a much longer text A<"), arena_document.RootNode().ChildAt(1).GetTextContent());
+    RRLIB_UNIT_TESTS_ASSERT(!arena_document.Reparse(different[3].data(), different[3].size(), false));
+    RRLIB_UNIT_TESTS_ASSERT(arena_document.UsesArena());
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(3), arena_document.RootNode().ChildCount());
+
+    // Empty documents are filled by a complete parse
+    tDocument empty;
+    RRLIB_UNIT_TESTS_ASSERT(!empty.Reparse(message.data(), message.size(), false));
+    RRLIB_UNIT_TESTS_EQUALITY(std::string("state"), empty.RootNode().Name());
+  }
 };
 
 RRLIB_UNIT_TESTS_REGISTER_SUITE(Test);